@@ -62,6 +62,9 @@ MANGLE_END */
             name: "CNIOBoringSSLShims",
             dependencies: [
                 "CNIOBoringSSL"
+            ],
+            linkerSettings: [
+                .linkedLibrary("dl", .when(platforms: [.linux]))
             ]),
         .target(
             name: "NIOSSL",
@@ -71,6 +74,7 @@ MANGLE_END */
                 .product(name: "NIO", package: "swift-nio"),
                 .product(name: "NIOCore", package: "swift-nio"),
                 .product(name: "NIOConcurrencyHelpers", package: "swift-nio"),
+                .product(name: "NIOPosix", package: "swift-nio"),
                 .product(name: "NIOTLS", package: "swift-nio"),
             ]),
         .target(
@@ -195,6 +195,75 @@ static int aead_chacha20_poly1305_seal_scatter(
       nonce_len, in, in_len, extra_in, extra_in_len, ad, ad_len, ctx->tag_len);
 }
 
+static int aead_chacha20_poly1305_seal_gather(
+    const EVP_AEAD_CTX *ctx, uint8_t *out, uint8_t *out_tag,
+    size_t *out_tag_len, size_t max_out_tag_len, const uint8_t *nonce,
+    size_t nonce_len, const uint8_t *const *in, const size_t *in_len,
+    size_t num_in, const uint8_t *ad, size_t ad_len) {
+  const struct aead_chacha20_poly1305_ctx *c20_ctx =
+      (struct aead_chacha20_poly1305_ctx *)&ctx->state;
+  const uint8_t *key = c20_ctx->key;
+
+  if (max_out_tag_len < ctx->tag_len) {
+    OPENSSL_PUT_ERROR(CIPHER, CIPHER_R_BUFFER_TOO_SMALL);
+    return 0;
+  }
+  if (nonce_len != 12) {
+    OPENSSL_PUT_ERROR(CIPHER, CIPHER_R_UNSUPPORTED_NONCE_SIZE);
+    return 0;
+  }
+
+  // See |chacha20_poly1305_seal_scatter| for the limit on the total length.
+  uint64_t total_len_64 = 0;
+  for (size_t i = 0; i < num_in; i++) {
+    total_len_64 += in_len[i];
+  }
+  if (total_len_64 >= (UINT64_C(1) << 32) * 64 - 64) {
+    OPENSSL_PUT_ERROR(CIPHER, CIPHER_R_TOO_LARGE);
+    return 0;
+  }
+
+  // Encrypt each buffer directly into its place in |out|. A buffer that starts
+  // part way through a ChaCha block first uses up the rest of that block's
+  // keystream, after which |CRYPTO_chacha_20| can continue at a block
+  // boundary. The assembly seal routine only takes contiguous input, so the
+  // tag is always computed with |calc_tag| over the finished ciphertext.
+  static const size_t kChaChaBlockSize = 64;
+  size_t done = 0;
+  for (size_t i = 0; i < num_in; i++) {
+    const uint8_t *p = in[i];
+    size_t len = in_len[i];
+    size_t offset = done % kChaChaBlockSize;
+    if (offset != 0 && len != 0) {
+      uint8_t block[64 /* kChaChaBlockSize */];
+      OPENSSL_memset(block, 0, sizeof(block));
+      CRYPTO_chacha_20(block, block, sizeof(block), key, nonce,
+                       1 + (uint32_t)(done / kChaChaBlockSize));
+      size_t todo = kChaChaBlockSize - offset;
+      if (todo > len) {
+        todo = len;
+      }
+      for (size_t j = 0; j < todo; j++) {
+        out[done + j] = p[j] ^ block[offset + j];
+      }
+      done += todo;
+      p += todo;
+      len -= todo;
+    }
+    if (len != 0) {
+      CRYPTO_chacha_20(out + done, p, len, key, nonce,
+                       1 + (uint32_t)(done / kChaChaBlockSize));
+      done += len;
+    }
+  }
+
+  uint8_t tag[POLY1305_TAG_LEN];
+  calc_tag(tag, key, nonce, ad, ad_len, out, done, NULL, 0);
+  OPENSSL_memcpy(out_tag, tag, ctx->tag_len);
+  *out_tag_len = ctx->tag_len;
+  return 1;
+}
+
 static int aead_xchacha20_poly1305_seal_scatter(
     const EVP_AEAD_CTX *ctx, uint8_t *out, uint8_t *out_tag,
     size_t *out_tag_len, size_t max_out_tag_len, const uint8_t *nonce,
@@ -315,6 +384,7 @@ static const EVP_AEAD aead_chacha20_poly1305 = {
     aead_chacha20_poly1305_open_gather,
     NULL,  // get_iv
     NULL,  // tag_len
+    aead_chacha20_poly1305_seal_gather,
 };
 
 static const EVP_AEAD aead_xchacha20_poly1305 = {
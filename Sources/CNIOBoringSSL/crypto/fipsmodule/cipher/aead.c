@@ -180,6 +180,63 @@ error:
   return 0;
 }
 
+int EVP_AEAD_CTX_seal_gather(
+    const EVP_AEAD_CTX *ctx, uint8_t *out, uint8_t *out_tag,
+    size_t *out_tag_len, size_t max_out_tag_len, const uint8_t *nonce,
+    size_t nonce_len, const uint8_t *const *in, const size_t *in_len,
+    size_t num_in, const uint8_t *ad, size_t ad_len) {
+  size_t total_len = 0;
+  for (size_t i = 0; i < num_in; i++) {
+    if (total_len + in_len[i] < total_len) {
+      OPENSSL_PUT_ERROR(CIPHER, CIPHER_R_TOO_LARGE);
+      goto error;
+    }
+    total_len += in_len[i];
+  }
+
+  // No input may alias the output, and |out_tag| may not alias |out|.
+  if (buffers_alias(out, total_len, out_tag, max_out_tag_len)) {
+    OPENSSL_PUT_ERROR(CIPHER, CIPHER_R_OUTPUT_ALIASES_INPUT);
+    goto error;
+  }
+  for (size_t i = 0; i < num_in; i++) {
+    if (buffers_alias(in[i], in_len[i], out, total_len) ||
+        buffers_alias(in[i], in_len[i], out_tag, max_out_tag_len)) {
+      OPENSSL_PUT_ERROR(CIPHER, CIPHER_R_OUTPUT_ALIASES_INPUT);
+      goto error;
+    }
+  }
+
+  if (ctx->aead->seal_gather) {
+    if (ctx->aead->seal_gather(ctx, out, out_tag, out_tag_len,
+                               max_out_tag_len, nonce, nonce_len, in, in_len,
+                               num_in, ad, ad_len)) {
+      return 1;
+    }
+    goto error;
+  }
+
+  // Gather the plaintext into |out| and seal it in place.
+  size_t done = 0;
+  for (size_t i = 0; i < num_in; i++) {
+    OPENSSL_memcpy(out + done, in[i], in_len[i]);
+    done += in_len[i];
+  }
+  if (ctx->aead->seal_scatter(ctx, out, out_tag, out_tag_len, max_out_tag_len,
+                              nonce, nonce_len, out, total_len, NULL, 0, ad,
+                              ad_len)) {
+    return 1;
+  }
+
+error:
+  // In the event of an error, clear the output buffer so that a caller
+  // that doesn't check the return value doesn't send raw data.
+  OPENSSL_memset(out, 0, total_len);
+  OPENSSL_memset(out_tag, 0, max_out_tag_len);
+  *out_tag_len = 0;
+  return 0;
+}
+
 int EVP_AEAD_CTX_open(const EVP_AEAD_CTX *ctx, uint8_t *out, size_t *out_len,
                       size_t max_out_len, const uint8_t *nonce,
                       size_t nonce_len, const uint8_t *in, size_t in_len,
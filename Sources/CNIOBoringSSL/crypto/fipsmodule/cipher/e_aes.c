@@ -1043,6 +1043,69 @@ static int aead_aes_gcm_seal_scatter(const EVP_AEAD_CTX *ctx, uint8_t *out,
       in_len, extra_in, extra_in_len, ad, ad_len, ctx->tag_len);
 }
 
+static int aead_aes_gcm_seal_gather_impl(
+    const struct aead_aes_gcm_ctx *gcm_ctx,
+    uint8_t *out, uint8_t *out_tag, size_t *out_tag_len, size_t max_out_tag_len,
+    const uint8_t *nonce, size_t nonce_len,
+    const uint8_t *const *in, const size_t *in_len, size_t num_in,
+    const uint8_t *ad, size_t ad_len,
+    size_t tag_len) {
+  if (max_out_tag_len < tag_len) {
+    OPENSSL_PUT_ERROR(CIPHER, CIPHER_R_BUFFER_TOO_SMALL);
+    return 0;
+  }
+  if (nonce_len == 0) {
+    OPENSSL_PUT_ERROR(CIPHER, CIPHER_R_INVALID_NONCE_SIZE);
+    return 0;
+  }
+
+  const AES_KEY *key = &gcm_ctx->ks.ks;
+
+  GCM128_CONTEXT gcm;
+  OPENSSL_memset(&gcm, 0, sizeof(gcm));
+  OPENSSL_memcpy(&gcm.gcm_key, &gcm_ctx->gcm_key, sizeof(gcm.gcm_key));
+  CRYPTO_gcm128_setiv(&gcm, key, nonce, nonce_len);
+
+  if (ad_len > 0 && !CRYPTO_gcm128_aad(&gcm, ad, ad_len)) {
+    return 0;
+  }
+
+  // |GCM128_CONTEXT| carries partial blocks between calls, so each buffer can
+  // be encrypted directly into its place in |out|.
+  for (size_t i = 0; i < num_in; i++) {
+    if (gcm_ctx->ctr) {
+      if (!CRYPTO_gcm128_encrypt_ctr32(&gcm, key, in[i], out, in_len[i],
+                                       gcm_ctx->ctr)) {
+        return 0;
+      }
+    } else {
+      if (!CRYPTO_gcm128_encrypt(&gcm, key, in[i], out, in_len[i])) {
+        return 0;
+      }
+    }
+    out += in_len[i];
+  }
+
+  CRYPTO_gcm128_tag(&gcm, out_tag, tag_len);
+  *out_tag_len = tag_len;
+
+  return 1;
+}
+
+static int aead_aes_gcm_seal_gather(const EVP_AEAD_CTX *ctx, uint8_t *out,
+                                    uint8_t *out_tag, size_t *out_tag_len,
+                                    size_t max_out_tag_len,
+                                    const uint8_t *nonce, size_t nonce_len,
+                                    const uint8_t *const *in,
+                                    const size_t *in_len, size_t num_in,
+                                    const uint8_t *ad, size_t ad_len) {
+  const struct aead_aes_gcm_ctx *gcm_ctx =
+      (const struct aead_aes_gcm_ctx *)&ctx->state;
+  return aead_aes_gcm_seal_gather_impl(
+      gcm_ctx, out, out_tag, out_tag_len, max_out_tag_len, nonce, nonce_len, in,
+      in_len, num_in, ad, ad_len, ctx->tag_len);
+}
+
 static int aead_aes_gcm_open_gather_impl(const struct aead_aes_gcm_ctx *gcm_ctx,
                                          uint8_t *out,
                                          const uint8_t *nonce, size_t nonce_len,
@@ -1118,6 +1181,7 @@ DEFINE_METHOD_FUNCTION(EVP_AEAD, EVP_aead_aes_128_gcm) {
   out->cleanup = aead_aes_gcm_cleanup;
   out->seal_scatter = aead_aes_gcm_seal_scatter;
   out->open_gather = aead_aes_gcm_open_gather;
+  out->seal_gather = aead_aes_gcm_seal_gather;
 }
 
 DEFINE_METHOD_FUNCTION(EVP_AEAD, EVP_aead_aes_192_gcm) {
@@ -1133,6 +1197,7 @@ DEFINE_METHOD_FUNCTION(EVP_AEAD, EVP_aead_aes_192_gcm) {
   out->cleanup = aead_aes_gcm_cleanup;
   out->seal_scatter = aead_aes_gcm_seal_scatter;
   out->open_gather = aead_aes_gcm_open_gather;
+  out->seal_gather = aead_aes_gcm_seal_gather;
 }
 
 DEFINE_METHOD_FUNCTION(EVP_AEAD, EVP_aead_aes_256_gcm) {
@@ -1148,6 +1213,7 @@ DEFINE_METHOD_FUNCTION(EVP_AEAD, EVP_aead_aes_256_gcm) {
   out->cleanup = aead_aes_gcm_cleanup;
   out->seal_scatter = aead_aes_gcm_seal_scatter;
   out->open_gather = aead_aes_gcm_open_gather;
+  out->seal_gather = aead_aes_gcm_seal_gather;
 }
 
 static int aead_aes_gcm_init_randnonce(EVP_AEAD_CTX *ctx, const uint8_t *key,
@@ -1291,11 +1357,11 @@ static int aead_aes_gcm_tls12_init(EVP_AEAD_CTX *ctx, const uint8_t *key,
   return 1;
 }
 
-static int aead_aes_gcm_tls12_seal_scatter(
-    const EVP_AEAD_CTX *ctx, uint8_t *out, uint8_t *out_tag,
-    size_t *out_tag_len, size_t max_out_tag_len, const uint8_t *nonce,
-    size_t nonce_len, const uint8_t *in, size_t in_len, const uint8_t *extra_in,
-    size_t extra_in_len, const uint8_t *ad, size_t ad_len) {
+// aead_aes_gcm_tls12_check_nonce returns one if |nonce| may be used for the
+// next TLS 1.2 record and records it as used, or zero otherwise.
+static int aead_aes_gcm_tls12_check_nonce(const EVP_AEAD_CTX *ctx,
+                                          const uint8_t *nonce,
+                                          size_t nonce_len) {
   struct aead_aes_gcm_tls12_ctx *gcm_ctx =
       (struct aead_aes_gcm_tls12_ctx *) &ctx->state;
 
@@ -1316,12 +1382,37 @@ static int aead_aes_gcm_tls12_seal_scatter(
   }
 
   gcm_ctx->min_next_nonce = given_counter + 1;
+  return 1;
+}
+
+static int aead_aes_gcm_tls12_seal_scatter(
+    const EVP_AEAD_CTX *ctx, uint8_t *out, uint8_t *out_tag,
+    size_t *out_tag_len, size_t max_out_tag_len, const uint8_t *nonce,
+    size_t nonce_len, const uint8_t *in, size_t in_len, const uint8_t *extra_in,
+    size_t extra_in_len, const uint8_t *ad, size_t ad_len) {
+  if (!aead_aes_gcm_tls12_check_nonce(ctx, nonce, nonce_len)) {
+    return 0;
+  }
 
   return aead_aes_gcm_seal_scatter(ctx, out, out_tag, out_tag_len,
                                    max_out_tag_len, nonce, nonce_len, in,
                                    in_len, extra_in, extra_in_len, ad, ad_len);
 }
 
+static int aead_aes_gcm_tls12_seal_gather(
+    const EVP_AEAD_CTX *ctx, uint8_t *out, uint8_t *out_tag,
+    size_t *out_tag_len, size_t max_out_tag_len, const uint8_t *nonce,
+    size_t nonce_len, const uint8_t *const *in, const size_t *in_len,
+    size_t num_in, const uint8_t *ad, size_t ad_len) {
+  if (!aead_aes_gcm_tls12_check_nonce(ctx, nonce, nonce_len)) {
+    return 0;
+  }
+
+  return aead_aes_gcm_seal_gather(ctx, out, out_tag, out_tag_len,
+                                  max_out_tag_len, nonce, nonce_len, in,
+                                  in_len, num_in, ad, ad_len);
+}
+
 DEFINE_METHOD_FUNCTION(EVP_AEAD, EVP_aead_aes_128_gcm_tls12) {
   memset(out, 0, sizeof(EVP_AEAD));
 
@@ -1335,6 +1426,7 @@ DEFINE_METHOD_FUNCTION(EVP_AEAD, EVP_aead_aes_128_gcm_tls12) {
   out->cleanup = aead_aes_gcm_cleanup;
   out->seal_scatter = aead_aes_gcm_tls12_seal_scatter;
   out->open_gather = aead_aes_gcm_open_gather;
+  out->seal_gather = aead_aes_gcm_tls12_seal_gather;
 }
 
 DEFINE_METHOD_FUNCTION(EVP_AEAD, EVP_aead_aes_256_gcm_tls12) {
@@ -1350,6 +1442,7 @@ DEFINE_METHOD_FUNCTION(EVP_AEAD, EVP_aead_aes_256_gcm_tls12) {
   out->cleanup = aead_aes_gcm_cleanup;
   out->seal_scatter = aead_aes_gcm_tls12_seal_scatter;
   out->open_gather = aead_aes_gcm_open_gather;
+  out->seal_gather = aead_aes_gcm_tls12_seal_gather;
 }
 
 struct aead_aes_gcm_tls13_ctx {
@@ -110,6 +110,16 @@ struct evp_aead_st {
 
   size_t (*tag_len)(const EVP_AEAD_CTX *ctx, size_t in_Len,
                     size_t extra_in_len);
+
+  // seal_gather, if set, behaves like |seal_scatter| without |extra_in| but
+  // reads the plaintext from |num_in| separate buffers. If NULL,
+  // |EVP_AEAD_CTX_seal_gather| copies the buffers into |out| and calls
+  // |seal_scatter| in place.
+  int (*seal_gather)(const EVP_AEAD_CTX *ctx, uint8_t *out, uint8_t *out_tag,
+                     size_t *out_tag_len, size_t max_out_tag_len,
+                     const uint8_t *nonce, size_t nonce_len,
+                     const uint8_t *const *in, const size_t *in_len,
+                     size_t num_in, const uint8_t *ad, size_t ad_len);
 };
 
 // aes_ctr_set_key initialises |*aes_key| using |key_bytes| bytes from |key|,
@@ -18,8 +18,13 @@
 #include <CNIOBoringSSL_lhash.h>
 #include <CNIOBoringSSL_thread.h>
 
+#include "../internal.h"
 #include "../lhash/internal.h"
 
+#if defined(OPENSSL_C11_ATOMIC)
+#include <stdatomic.h>
+#endif
+
 
 #if defined(__cplusplus)
 extern "C" {
@@ -39,6 +44,17 @@ struct crypto_buffer_st {
 struct crypto_buffer_pool_st {
   LHASH_OF(CRYPTO_BUFFER) *bufs;
   CRYPTO_MUTEX lock;
+  // num_bytes is the total length of the buffers in |bufs|. It and |misses|
+  // are protected by |lock|.
+  size_t num_bytes;
+  uint64_t misses;
+  // hits is also incremented while only holding |lock| for reading, so it is
+  // updated atomically instead.
+#if defined(OPENSSL_C11_ATOMIC)
+  _Atomic uint64_t hits;
+#else
+  uint64_t hits;
+#endif
 };
 
 
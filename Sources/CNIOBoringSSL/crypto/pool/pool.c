@@ -70,6 +70,40 @@ void CRYPTO_BUFFER_POOL_free(CRYPTO_BUFFER_POOL *pool) {
   OPENSSL_free(pool);
 }
 
+#if !defined(OPENSSL_C11_ATOMIC)
+static struct CRYPTO_STATIC_MUTEX g_pool_hits_lock = CRYPTO_STATIC_MUTEX_INIT;
+#endif
+
+// crypto_buffer_pool_record_hit counts a request for a buffer that |pool|
+// already held. The caller must hold |pool->lock|, for reading or writing.
+static void crypto_buffer_pool_record_hit(CRYPTO_BUFFER_POOL *pool) {
+#if defined(OPENSSL_C11_ATOMIC)
+  atomic_fetch_add_explicit(&pool->hits, 1, memory_order_relaxed);
+#else
+  CRYPTO_STATIC_MUTEX_lock_write(&g_pool_hits_lock);
+  pool->hits++;
+  CRYPTO_STATIC_MUTEX_unlock_write(&g_pool_hits_lock);
+#endif
+}
+
+void CRYPTO_BUFFER_POOL_get_stats(CRYPTO_BUFFER_POOL *pool,
+                                  size_t *out_num_buffers,
+                                  size_t *out_num_bytes, uint64_t *out_hits,
+                                  uint64_t *out_misses) {
+  CRYPTO_MUTEX_lock_read(&pool->lock);
+  *out_num_buffers = lh_CRYPTO_BUFFER_num_items(pool->bufs);
+  *out_num_bytes = pool->num_bytes;
+  *out_misses = pool->misses;
+#if defined(OPENSSL_C11_ATOMIC)
+  *out_hits = atomic_load_explicit(&pool->hits, memory_order_relaxed);
+#else
+  CRYPTO_STATIC_MUTEX_lock_read(&g_pool_hits_lock);
+  *out_hits = pool->hits;
+  CRYPTO_STATIC_MUTEX_unlock_read(&g_pool_hits_lock);
+#endif
+  CRYPTO_MUTEX_unlock_read(&pool->lock);
+}
+
 static void crypto_buffer_free_object(CRYPTO_BUFFER *buf) {
   if (!buf->data_is_static) {
     OPENSSL_free(buf->data);
@@ -94,6 +128,7 @@ static CRYPTO_BUFFER *crypto_buffer_new(const uint8_t *data, size_t len,
     }
     if (duplicate != NULL) {
       CRYPTO_refcount_inc(&duplicate->references);
+      crypto_buffer_pool_record_hit(pool);
     }
     CRYPTO_MUTEX_unlock_read(&pool->lock);
 
@@ -142,8 +177,15 @@ static CRYPTO_BUFFER *crypto_buffer_new(const uint8_t *data, size_t len,
     // |old| may be non-NULL if a match was found but ignored. |pool->bufs| does
     // not increment refcounts, so there is no need to clean up after the
     // replacement.
+    if (inserted) {
+      pool->misses++;
+      if (old == NULL) {
+        pool->num_bytes += len;
+      }
+    }
   } else {
     CRYPTO_refcount_inc(&duplicate->references);
+    crypto_buffer_pool_record_hit(pool);
   }
   CRYPTO_MUTEX_unlock_write(&pool->lock);
 
@@ -227,6 +269,7 @@ void CRYPTO_BUFFER_free(CRYPTO_BUFFER *buf) {
     found = lh_CRYPTO_BUFFER_delete(pool->bufs, buf);
     assert(found == buf);
     (void)found;
+    pool->num_bytes -= buf->len;
   }
 
   CRYPTO_MUTEX_unlock_write(&buf->pool->lock);
@@ -361,6 +361,22 @@ OPENSSL_EXPORT int EVP_AEAD_CTX_seal_scatter(
     const uint8_t *extra_in, size_t extra_in_len,
     const uint8_t *ad, size_t ad_len);
 
+// EVP_AEAD_CTX_seal_gather behaves like |EVP_AEAD_CTX_seal_scatter| with no
+// |extra_in|, except that the plaintext is the concatenation of the |num_in|
+// buffers |in[i]|, each |in_len[i]| bytes long. The concatenated ciphertext is
+// written to |out|, whose length is the sum of |in_len|.
+//
+// AEADs that can encrypt incrementally read each buffer directly. Other AEADs
+// copy the buffers into |out| and encrypt in place.
+//
+// None of the |in| buffers may alias |out| or |out_tag|.
+OPENSSL_EXPORT int EVP_AEAD_CTX_seal_gather(
+    const EVP_AEAD_CTX *ctx, uint8_t *out,
+    uint8_t *out_tag, size_t *out_tag_len, size_t max_out_tag_len,
+    const uint8_t *nonce, size_t nonce_len,
+    const uint8_t *const *in, const size_t *in_len, size_t num_in,
+    const uint8_t *ad, size_t ad_len);
+
 // EVP_AEAD_CTX_open_gather decrypts and authenticates |in_len| bytes from |in|
 // and authenticates |ad_len| bytes from |ad| using |in_tag_len| bytes of
 // authentication tag from |in_tag|. If successful, it writes |in_len| bytes of
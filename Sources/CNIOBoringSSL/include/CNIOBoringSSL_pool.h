@@ -40,6 +40,17 @@ OPENSSL_EXPORT CRYPTO_BUFFER_POOL* CRYPTO_BUFFER_POOL_new(void);
 // CRYPTO_BUFFER_POOL_free frees |pool|, which must be empty.
 OPENSSL_EXPORT void CRYPTO_BUFFER_POOL_free(CRYPTO_BUFFER_POOL *pool);
 
+// CRYPTO_BUFFER_POOL_get_stats sets |*out_num_buffers| and |*out_num_bytes| to
+// the number of |CRYPTO_BUFFER|s currently in |pool| and their total length.
+// It sets |*out_hits| to the number of times a |CRYPTO_BUFFER| was requested
+// from |pool| and an existing one was returned, and |*out_misses| to the number
+// of times a new one was added instead.
+OPENSSL_EXPORT void CRYPTO_BUFFER_POOL_get_stats(CRYPTO_BUFFER_POOL *pool,
+                                                 size_t *out_num_buffers,
+                                                 size_t *out_num_bytes,
+                                                 uint64_t *out_hits,
+                                                 uint64_t *out_misses);
+
 // CRYPTO_BUFFER_new returns a |CRYPTO_BUFFER| containing a copy of |data|, or
 // else NULL on error. If |pool| is not NULL then the returned value may be a
 // reference to a previously existing |CRYPTO_BUFFER| that contained the same
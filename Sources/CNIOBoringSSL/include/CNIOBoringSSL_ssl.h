@@ -2341,6 +2341,22 @@ OPENSSL_EXPORT uint16_t SSL_get_curve_id(const SSL *ssl);
 // the given TLS curve id, or NULL if the curve is unknown.
 OPENSSL_EXPORT const char *SSL_get_curve_name(uint16_t curve_id);
 
+// SSL_CTX_set_key_share_pool_cb configures |ctx| to call |cb| for a
+// precomputed ephemeral key pair whenever a connection needs one for a key
+// exchange with group |group_id|. If one is available, |cb| should write the
+// private key to |out_private_key| and the public key, as it is sent on the
+// wire, to |out_public_key|, set the lengths, and return one. Each key pair must
+// be used only once. Otherwise it should return zero, and the key pair is
+// generated as usual. X25519 and the NIST curves may be precomputed. For the
+// NIST curves, the private key is the big-endian scalar, padded to the length
+// of the group order.
+OPENSSL_EXPORT void SSL_CTX_set_key_share_pool_cb(
+    SSL_CTX *ctx,
+    int (*cb)(SSL *ssl, uint16_t group_id, uint8_t *out_private_key,
+              size_t *out_private_key_len, size_t max_private_key_len,
+              uint8_t *out_public_key, size_t *out_public_key_len,
+              size_t max_public_key_len));
+
 
 // Certificate verification.
 //
@@ -5313,6 +5329,21 @@ OPENSSL_EXPORT bool SealRecord(SSL *ssl, Span<uint8_t> out_prefix,
                                Span<uint8_t> out, Span<uint8_t> out_suffix,
                                Span<const uint8_t> in);
 
+//  *** EXPERIMENTAL -- DO NOT USE ***
+//
+// SealRecordGather behaves like |SealRecord|, except that the plaintext is the
+// concatenation of the |num_in| buffers |in[i]|, each |in_len[i]| bytes long,
+// and the length of |out| must equal their combined length. Where the cipher
+// supports it, each buffer is encrypted directly into |out| without first
+// being copied.
+//
+// None of the |in| buffers may alias any output.
+OPENSSL_EXPORT bool SealRecordGather(SSL *ssl, Span<uint8_t> out_prefix,
+                                     Span<uint8_t> out,
+                                     Span<uint8_t> out_suffix,
+                                     const uint8_t *const *in,
+                                     const size_t *in_len, size_t num_in);
+
 
 // *** EXPERIMENTAL — DO NOT USE WITHOUT CHECKING ***
 //
@@ -864,9 +864,27 @@ class SSLAEADContext {
                    const uint8_t *in, size_t in_len, const uint8_t *extra_in,
                    size_t extra_in_len);
 
+  // SealGather behaves like |SealScatter| with no |extra_in|, except that the
+  // plaintext is the concatenation of the |num_in| buffers |in[i]|, each
+  // |in_len[i]| bytes long, and |out| receives their combined length. None of
+  // the |in| buffers may alias any output.
+  bool SealGather(uint8_t *out_prefix, uint8_t *out, uint8_t *out_suffix,
+                  uint8_t type, uint16_t record_version,
+                  const uint8_t seqnum[8], Span<const uint8_t> header,
+                  const uint8_t *const *in, const size_t *in_len,
+                  size_t num_in);
+
   bool GetIV(const uint8_t **out_iv, size_t *out_iv_len) const;
 
  private:
+  // SealNonce assembles the nonce for sealing the record with sequence number
+  // |seqnum| into |out_nonce| and sets |*out_nonce_len| to its length. If the
+  // record carries an explicit nonce, it is also written to |out_prefix|. It
+  // returns true on success and false on error.
+  bool SealNonce(uint8_t out_nonce[EVP_AEAD_MAX_NONCE_LENGTH],
+                 size_t *out_nonce_len, uint8_t *out_prefix,
+                 const uint8_t seqnum[8]);
+
   // GetAdditionalData returns the additional data, writing into |storage| if
   // necessary.
   Span<const uint8_t> GetAdditionalData(uint8_t storage[13], uint8_t type,
@@ -1078,6 +1096,11 @@ class SSLKeyShare {
   // |Serialize|.
   static UniquePtr<SSLKeyShare> Create(CBS *in);
 
+  // Create returns a SSLKeyShare instance for use with group |group_id| by
+  // |hs|, taking a precomputed key pair from |hs|'s key share pool if one is
+  // available. It returns nullptr on error.
+  static UniquePtr<SSLKeyShare> Create(SSL_HANDSHAKE *hs, uint16_t group_id);
+
   // Serializes writes the group ID and private key, in a format that can be
   // read by |Create|.
   bool Serialize(CBB *out);
@@ -1113,6 +1136,14 @@ class SSLKeyShare {
   // DeserializePrivateKey initializes the state of the key exchange from |in|,
   // returning true if successful and false otherwise.
   virtual bool DeserializePrivateKey(CBS *in) { return false; }
+
+  // SetPrecomputedKeyPair configures |Offer| to use the given key pair instead
+  // of generating one. It returns true if successful and false if the group
+  // does not support precomputed key pairs or the key pair is malformed.
+  virtual bool SetPrecomputedKeyPair(Span<const uint8_t> private_key,
+                                     Span<const uint8_t> public_key) {
+    return false;
+  }
 };
 
 struct NamedGroup {
@@ -3625,6 +3656,15 @@ struct ssl_ctx_st {
   // |SSL_CTX_set_keylog_callback|.
   void (*keylog_callback)(const SSL *ssl, const char *line) = nullptr;
 
+  // key_share_pool_cb, if not NULL, supplies precomputed key pairs. See
+  // |SSL_CTX_set_key_share_pool_cb|.
+  int (*key_share_pool_cb)(SSL *ssl, uint16_t group_id,
+                           uint8_t *out_private_key,
+                           size_t *out_private_key_len,
+                           size_t max_private_key_len, uint8_t *out_public_key,
+                           size_t *out_public_key_len,
+                           size_t max_public_key_len) = nullptr;
+
   // current_time_cb, if not NULL, is the function to use to get the current
   // time. It sets |*out_clock| to the current time. The |ssl| argument is
   // always NULL. See |SSL_CTX_set_current_time_cb|.
@@ -311,6 +311,53 @@ bool SSLAEADContext::Open(Span<uint8_t> *out, uint8_t type,
   return true;
 }
 
+bool SSLAEADContext::SealNonce(uint8_t out_nonce[EVP_AEAD_MAX_NONCE_LENGTH],
+                               size_t *out_nonce_len, uint8_t *out_prefix,
+                               const uint8_t seqnum[8]) {
+  size_t nonce_len = 0;
+
+  // Prepend the fixed nonce, or left-pad with zeros if XORing.
+  if (xor_fixed_nonce_) {
+    nonce_len = fixed_nonce_len_ - variable_nonce_len_;
+    OPENSSL_memset(out_nonce, 0, nonce_len);
+  } else {
+    OPENSSL_memcpy(out_nonce, fixed_nonce_, fixed_nonce_len_);
+    nonce_len += fixed_nonce_len_;
+  }
+
+  // Select the variable nonce.
+  if (random_variable_nonce_) {
+    assert(variable_nonce_included_in_record_);
+    if (!RAND_bytes(out_nonce + nonce_len, variable_nonce_len_)) {
+      return false;
+    }
+  } else {
+    // When sending we use the sequence number as the variable part of the
+    // nonce.
+    assert(variable_nonce_len_ == 8);
+    OPENSSL_memcpy(out_nonce + nonce_len, seqnum, variable_nonce_len_);
+  }
+  nonce_len += variable_nonce_len_;
+
+  // Emit the variable nonce if included in the record.
+  if (variable_nonce_included_in_record_) {
+    assert(!xor_fixed_nonce_);
+    OPENSSL_memcpy(out_prefix, out_nonce + fixed_nonce_len_,
+                   variable_nonce_len_);
+  }
+
+  // XOR the fixed nonce, if necessary.
+  if (xor_fixed_nonce_) {
+    assert(nonce_len == fixed_nonce_len_);
+    for (size_t i = 0; i < fixed_nonce_len_; i++) {
+      out_nonce[i] ^= fixed_nonce_[i];
+    }
+  }
+
+  *out_nonce_len = nonce_len;
+  return true;
+}
+
 bool SSLAEADContext::SealScatter(uint8_t *out_prefix, uint8_t *out,
                                  uint8_t *out_suffix, uint8_t type,
                                  uint16_t record_version,
@@ -342,56 +389,76 @@ bool SSLAEADContext::SealScatter(uint8_t *out_prefix, uint8_t *out,
   Span<const uint8_t> ad = GetAdditionalData(ad_storage, type, record_version,
                                              seqnum, in_len, header);
 
-  // Assemble the nonce.
+  // The explicit nonce, if any, is written to |out_prefix|, which was checked
+  // not to alias |in| above.
   uint8_t nonce[EVP_AEAD_MAX_NONCE_LENGTH];
-  size_t nonce_len = 0;
-
-  // Prepend the fixed nonce, or left-pad with zeros if XORing.
-  if (xor_fixed_nonce_) {
-    nonce_len = fixed_nonce_len_ - variable_nonce_len_;
-    OPENSSL_memset(nonce, 0, nonce_len);
-  } else {
-    OPENSSL_memcpy(nonce, fixed_nonce_, fixed_nonce_len_);
-    nonce_len += fixed_nonce_len_;
+  size_t nonce_len;
+  if (!SealNonce(nonce, &nonce_len, out_prefix, seqnum)) {
+    return false;
   }
 
-  // Select the variable nonce.
-  if (random_variable_nonce_) {
-    assert(variable_nonce_included_in_record_);
-    if (!RAND_bytes(nonce + nonce_len, variable_nonce_len_)) {
+  size_t written_suffix_len;
+  bool result = !!EVP_AEAD_CTX_seal_scatter(
+      ctx_.get(), out, out_suffix, &written_suffix_len, suffix_len, nonce,
+      nonce_len, in, in_len, extra_in, extra_in_len, ad.data(), ad.size());
+  assert(!result || written_suffix_len == suffix_len);
+  return result;
+}
+
+bool SSLAEADContext::SealGather(uint8_t *out_prefix, uint8_t *out,
+                                uint8_t *out_suffix, uint8_t type,
+                                uint16_t record_version,
+                                const uint8_t seqnum[8],
+                                Span<const uint8_t> header,
+                                const uint8_t *const *in,
+                                const size_t *in_len, size_t num_in) {
+  const size_t prefix_len = ExplicitNonceLen();
+  size_t total_len = 0;
+  for (size_t i = 0; i < num_in; i++) {
+    if (total_len + in_len[i] < total_len) {
+      OPENSSL_PUT_ERROR(SSL, SSL_R_RECORD_TOO_LARGE);
       return false;
     }
-  } else {
-    // When sending we use the sequence number as the variable part of the
-    // nonce.
-    assert(variable_nonce_len_ == 8);
-    OPENSSL_memcpy(nonce + nonce_len, seqnum, variable_nonce_len_);
+    total_len += in_len[i];
   }
-  nonce_len += variable_nonce_len_;
-
-  // Emit the variable nonce if included in the record.
-  if (variable_nonce_included_in_record_) {
-    assert(!xor_fixed_nonce_);
-    if (buffers_alias(in, in_len, out_prefix, variable_nonce_len_)) {
+  size_t suffix_len;
+  if (!SuffixLen(&suffix_len, total_len, 0)) {
+    OPENSSL_PUT_ERROR(SSL, SSL_R_RECORD_TOO_LARGE);
+    return false;
+  }
+  for (size_t i = 0; i < num_in; i++) {
+    if (buffers_alias(in[i], in_len[i], out, total_len) ||
+        buffers_alias(in[i], in_len[i], out_prefix, prefix_len) ||
+        buffers_alias(in[i], in_len[i], out_suffix, suffix_len)) {
       OPENSSL_PUT_ERROR(SSL, SSL_R_OUTPUT_ALIASES_INPUT);
       return false;
     }
-    OPENSSL_memcpy(out_prefix, nonce + fixed_nonce_len_,
-                   variable_nonce_len_);
   }
 
-  // XOR the fixed nonce, if necessary.
-  if (xor_fixed_nonce_) {
-    assert(nonce_len == fixed_nonce_len_);
-    for (size_t i = 0; i < fixed_nonce_len_; i++) {
-      nonce[i] ^= fixed_nonce_[i];
+  if (is_null_cipher() || FUZZER_MODE) {
+    // Handle the initial NULL cipher.
+    size_t done = 0;
+    for (size_t i = 0; i < num_in; i++) {
+      OPENSSL_memcpy(out + done, in[i], in_len[i]);
+      done += in_len[i];
     }
+    return true;
+  }
+
+  uint8_t ad_storage[13];
+  Span<const uint8_t> ad = GetAdditionalData(ad_storage, type, record_version,
+                                             seqnum, total_len, header);
+
+  uint8_t nonce[EVP_AEAD_MAX_NONCE_LENGTH];
+  size_t nonce_len;
+  if (!SealNonce(nonce, &nonce_len, out_prefix, seqnum)) {
+    return false;
   }
 
   size_t written_suffix_len;
-  bool result = !!EVP_AEAD_CTX_seal_scatter(
+  bool result = !!EVP_AEAD_CTX_seal_gather(
       ctx_.get(), out, out_suffix, &written_suffix_len, suffix_len, nonce,
-      nonce_len, in, in_len, extra_in, extra_in_len, ad.data(), ad.size());
+      nonce_len, in, in_len, num_in, ad.data(), ad.size());
   assert(!result || written_suffix_len == suffix_len);
   return result;
 }
@@ -43,6 +43,12 @@ class ECKeyShare : public SSLKeyShare {
   uint16_t GroupID() const override { return group_id_; }
 
   bool Offer(CBB *out) override {
+    if (!precomputed_public_key_.empty()) {
+      assert(private_key_);
+      return !!CBB_add_bytes(out, precomputed_public_key_.data(),
+                             precomputed_public_key_.size());
+    }
+
     assert(!private_key_);
     // Set up a shared |BN_CTX| for all operations.
     UniquePtr<BN_CTX> bn_ctx(BN_CTX_new());
@@ -138,8 +144,28 @@ class ECKeyShare : public SSLKeyShare {
     return private_key_ != nullptr;
   }
 
+  bool SetPrecomputedKeyPair(Span<const uint8_t> private_key,
+                             Span<const uint8_t> public_key) override {
+    assert(!private_key_);
+    UniquePtr<EC_GROUP> group(EC_GROUP_new_by_curve_name(nid_));
+    if (!group ||
+        private_key.size() != BN_num_bytes(EC_GROUP_get0_order(group.get())) ||
+        public_key.size() != 1 + 2 * ((EC_GROUP_get_degree(group.get()) + 7) / 8) ||
+        public_key[0] != POINT_CONVERSION_UNCOMPRESSED) {
+      return false;
+    }
+    private_key_.reset(
+        BN_bin2bn(private_key.data(), private_key.size(), nullptr));
+    if (!private_key_ || !precomputed_public_key_.CopyFrom(public_key)) {
+      private_key_.reset();
+      return false;
+    }
+    return true;
+  }
+
  private:
   UniquePtr<BIGNUM> private_key_;
+  Array<uint8_t> precomputed_public_key_;
   int nid_;
   uint16_t group_id_;
 };
@@ -151,6 +177,11 @@ class X25519KeyShare : public SSLKeyShare {
   uint16_t GroupID() const override { return SSL_CURVE_X25519; }
 
   bool Offer(CBB *out) override {
+    if (has_precomputed_public_key_) {
+      return !!CBB_add_bytes(out, precomputed_public_key_,
+                             sizeof(precomputed_public_key_));
+    }
+
     uint8_t public_key[32];
     X25519_keypair(public_key, private_key_);
     return !!CBB_add_bytes(out, public_key, sizeof(public_key));
@@ -189,8 +220,23 @@ class X25519KeyShare : public SSLKeyShare {
     return true;
   }
 
+  bool SetPrecomputedKeyPair(Span<const uint8_t> private_key,
+                             Span<const uint8_t> public_key) override {
+    if (private_key.size() != sizeof(private_key_) ||
+        public_key.size() != sizeof(precomputed_public_key_)) {
+      return false;
+    }
+    OPENSSL_memcpy(private_key_, private_key.data(), sizeof(private_key_));
+    OPENSSL_memcpy(precomputed_public_key_, public_key.data(),
+                   sizeof(precomputed_public_key_));
+    has_precomputed_public_key_ = true;
+    return true;
+  }
+
  private:
   uint8_t private_key_[32];
+  uint8_t precomputed_public_key_[32];
+  bool has_precomputed_public_key_ = false;
 };
 
 class CECPQ2KeyShare : public SSLKeyShare {
@@ -328,6 +374,32 @@ UniquePtr<SSLKeyShare> SSLKeyShare::Create(uint16_t group_id) {
   }
 }
 
+UniquePtr<SSLKeyShare> SSLKeyShare::Create(SSL_HANDSHAKE *hs,
+                                           uint16_t group_id) {
+  UniquePtr<SSLKeyShare> key_share = Create(group_id);
+  SSL *const ssl = hs->ssl;
+  if (!key_share || ssl->ctx->key_share_pool_cb == nullptr) {
+    return key_share;
+  }
+
+  // Large enough for P-521.
+  uint8_t private_key[66], public_key[133];
+  size_t private_key_len, public_key_len;
+  if (ssl->ctx->key_share_pool_cb(ssl, group_id, private_key, &private_key_len,
+                                  sizeof(private_key), public_key,
+                                  &public_key_len, sizeof(public_key)) &&
+      (private_key_len > sizeof(private_key) ||
+       public_key_len > sizeof(public_key) ||
+       !key_share->SetPrecomputedKeyPair(
+           MakeConstSpan(private_key, private_key_len),
+           MakeConstSpan(public_key, public_key_len)))) {
+    // Discard a malformed key pair rather than use part of it.
+    key_share = Create(group_id);
+  }
+  OPENSSL_cleanse(private_key, sizeof(private_key));
+  return key_share;
+}
+
 UniquePtr<SSLKeyShare> SSLKeyShare::Create(CBS *in) {
   uint64_t group;
   CBS private_key;
@@ -2694,6 +2694,15 @@ void SSL_CTX_set_keylog_callback(SSL_CTX *ctx,
   ctx->keylog_callback = cb;
 }
 
+void SSL_CTX_set_key_share_pool_cb(
+    SSL_CTX *ctx,
+    int (*cb)(SSL *ssl, uint16_t group_id, uint8_t *out_private_key,
+              size_t *out_private_key_len, size_t max_private_key_len,
+              uint8_t *out_public_key, size_t *out_public_key_len,
+              size_t max_public_key_len)) {
+  ctx->key_share_pool_cb = cb;
+}
+
 void (*SSL_CTX_get_keylog_callback(const SSL_CTX *ctx))(const SSL *ssl,
                                                         const char *line) {
   return ctx->keylog_callback;
@@ -74,7 +74,7 @@ static bool resolve_ecdhe_secret(SSL_HANDSHAKE *hs,
     }
   } else {
     ScopedCBB public_key;
-    UniquePtr<SSLKeyShare> key_share = SSLKeyShare::Create(group_id);
+    UniquePtr<SSLKeyShare> key_share = SSLKeyShare::Create(hs, group_id);
     if (!key_share ||  //
         !CBB_init(public_key.get(), 32) ||
         !key_share->Accept(public_key.get(), &secret, &alert, peer_key) ||
@@ -422,6 +422,42 @@ static bool do_seal_record(SSL *ssl, uint8_t *out_prefix, uint8_t *out,
   return true;
 }
 
+// do_seal_record_gather behaves like |do_seal_record| for a TLS 1.2 or earlier
+// record, except that the plaintext is read from the |num_in| buffers |in|.
+static bool do_seal_record_gather(SSL *ssl, uint8_t *out_prefix, uint8_t *out,
+                                  uint8_t *out_suffix, uint8_t type,
+                                  const uint8_t *const *in,
+                                  const size_t *in_len, size_t num_in,
+                                  size_t total_len) {
+  SSLAEADContext *aead = ssl->s3->aead_write_ctx.get();
+  assert(aead->is_null_cipher() || aead->ProtocolVersion() < TLS1_3_VERSION);
+
+  size_t ciphertext_len;
+  if (!aead->CiphertextLen(&ciphertext_len, total_len, 0)) {
+    OPENSSL_PUT_ERROR(SSL, SSL_R_RECORD_TOO_LARGE);
+    return false;
+  }
+
+  uint16_t record_version = aead->RecordVersion();
+
+  out_prefix[0] = type;
+  out_prefix[1] = record_version >> 8;
+  out_prefix[2] = record_version & 0xff;
+  out_prefix[3] = ciphertext_len >> 8;
+  out_prefix[4] = ciphertext_len & 0xff;
+  Span<const uint8_t> header = MakeSpan(out_prefix, SSL3_RT_HEADER_LENGTH);
+
+  if (!aead->SealGather(out_prefix + SSL3_RT_HEADER_LENGTH, out, out_suffix,
+                        type, record_version, ssl->s3->write_sequence, header,
+                        in, in_len, num_in) ||
+      !ssl_record_sequence_update(ssl->s3->write_sequence, 8)) {
+    return false;
+  }
+
+  ssl_do_msg_callback(ssl, 1 /* write */, SSL3_RT_HEADER, header);
+  return true;
+}
+
 static size_t tls_seal_scatter_prefix_len(const SSL *ssl, uint8_t type,
                                           size_t in_len) {
   size_t ret = SSL3_RT_HEADER_LENGTH;
@@ -682,6 +718,58 @@ bool SealRecord(SSL *ssl, const Span<uint8_t> out_prefix,
                                  in.data(), in.size());
 }
 
+bool SealRecordGather(SSL *ssl, const Span<uint8_t> out_prefix,
+                      const Span<uint8_t> out, Span<uint8_t> out_suffix,
+                      const uint8_t *const *in, const size_t *in_len,
+                      size_t num_in) {
+  // Like |SealRecord|, this only works for TLS 1.2 and below.
+  if (SSL_in_init(ssl) ||
+      SSL_is_dtls(ssl) ||
+      ssl_protocol_version(ssl) > TLS1_2_VERSION) {
+    assert(false);
+    OPENSSL_PUT_ERROR(SSL, ERR_R_INTERNAL_ERROR);
+    return false;
+  }
+
+  size_t total_len = 0;
+  for (size_t i = 0; i < num_in; i++) {
+    if (total_len + in_len[i] < total_len) {
+      OPENSSL_PUT_ERROR(SSL, SSL_R_RECORD_TOO_LARGE);
+      return false;
+    }
+    total_len += in_len[i];
+  }
+
+  if (total_len > SSL3_RT_MAX_PLAIN_LENGTH ||
+      out_prefix.size() != SealRecordPrefixLen(ssl, total_len) ||
+      out.size() != total_len ||
+      out_suffix.size() != SealRecordSuffixLen(ssl, total_len)) {
+    OPENSSL_PUT_ERROR(SSL, SSL_R_BUFFER_TOO_SMALL);
+    return false;
+  }
+
+  if (total_len > 1 && ssl_needs_record_splitting(ssl)) {
+    // 1/n-1 record splitting seals the first byte separately. Gather the
+    // plaintext into |out| and take the contiguous path.
+    size_t done = 0;
+    for (size_t i = 0; i < num_in; i++) {
+      if (buffers_alias(in[i], in_len[i], out.data(), out.size())) {
+        OPENSSL_PUT_ERROR(SSL, SSL_R_OUTPUT_ALIASES_INPUT);
+        return false;
+      }
+      OPENSSL_memcpy(out.data() + done, in[i], in_len[i]);
+      done += in_len[i];
+    }
+    return tls_seal_scatter_record(ssl, out_prefix.data(), out.data(),
+                                   out_suffix.data(), SSL3_RT_APPLICATION_DATA,
+                                   out.data(), out.size());
+  }
+
+  return do_seal_record_gather(ssl, out_prefix.data(), out.data(),
+                               out_suffix.data(), SSL3_RT_APPLICATION_DATA, in,
+                               in_len, num_in, total_len);
+}
+
 BSSL_NAMESPACE_END
 
 using namespace bssl;
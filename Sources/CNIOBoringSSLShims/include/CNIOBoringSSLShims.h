@@ -22,6 +22,10 @@
 #include "CNIOBoringSSL.h"
 #endif
 
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
 GENERAL_NAME *CNIOBoringSSLShims_sk_GENERAL_NAME_value(const STACK_OF(GENERAL_NAME) *sk, size_t i);
 size_t CNIOBoringSSLShims_sk_GENERAL_NAME_num(const STACK_OF(GENERAL_NAME) *sk);
 
@@ -31,4 +35,89 @@ int CNIOBoringSSLShims_SSL_CTX_set_app_data(SSL_CTX *ctx, void *data);
 int CNIOBoringSSLShims_ERR_GET_LIB(uint32_t err);
 int CNIOBoringSSLShims_ERR_GET_REASON(uint32_t err);
 
+// The C++-only record APIs, exposed to Swift. See shims_records.cc.
+typedef enum {
+  CNIOBoringSSLShims_open_record_ok,
+  CNIOBoringSSLShims_open_record_discard,
+  CNIOBoringSSLShims_open_record_incomplete,
+  CNIOBoringSSLShims_open_record_close_notify,
+  CNIOBoringSSLShims_open_record_error,
+} CNIOBoringSSLShims_open_record_result;
+
+CNIOBoringSSLShims_open_record_result CNIOBoringSSLShims_SSL_open_record(SSL *ssl, uint8_t *in, size_t in_len,
+                                                                         size_t *out_plaintext_offset,
+                                                                         size_t *out_plaintext_len,
+                                                                         size_t *out_record_len,
+                                                                         uint8_t *out_alert);
+
+size_t CNIOBoringSSLShims_SSL_sealed_record_len(const SSL *ssl, size_t plaintext_len);
+int CNIOBoringSSLShims_SSL_seal_record(SSL *ssl, uint8_t *out, size_t out_len, const uint8_t *in, size_t in_len);
+int CNIOBoringSSLShims_SSL_seal_record_gather(SSL *ssl, uint8_t *out, size_t out_len,
+                                              const uint8_t *const *in, const size_t *in_len,
+                                              size_t num_in);
+
+// Mirrors of the crypto_info structures from linux/tls.h, used to configure kernel TLS
+// without depending on the kernel headers. See shims_kernel_tls.cc.
+#define CNIOBoringSSLShims_TLS_CIPHER_AES_GCM_128 51
+#define CNIOBoringSSLShims_TLS_CIPHER_AES_GCM_256 52
+#define CNIOBoringSSLShims_TLS_CIPHER_CHACHA20_POLY1305 54
+
+typedef struct {
+  uint16_t version;
+  uint16_t cipher_type;
+} CNIOBoringSSLShims_tls_crypto_info;
+
+typedef struct {
+  CNIOBoringSSLShims_tls_crypto_info info;
+  uint8_t iv[8];
+  uint8_t key[16];
+  uint8_t salt[4];
+  uint8_t rec_seq[8];
+} CNIOBoringSSLShims_tls12_crypto_info_aes_gcm_128;
+
+typedef struct {
+  CNIOBoringSSLShims_tls_crypto_info info;
+  uint8_t iv[8];
+  uint8_t key[32];
+  uint8_t salt[4];
+  uint8_t rec_seq[8];
+} CNIOBoringSSLShims_tls12_crypto_info_aes_gcm_256;
+
+typedef struct {
+  CNIOBoringSSLShims_tls_crypto_info info;
+  uint8_t iv[12];
+  uint8_t key[32];
+  uint8_t rec_seq[8];
+} CNIOBoringSSLShims_tls12_crypto_info_chacha20_poly1305;
+
+typedef union {
+  CNIOBoringSSLShims_tls_crypto_info info;
+  CNIOBoringSSLShims_tls12_crypto_info_aes_gcm_128 aes_gcm_128;
+  CNIOBoringSSLShims_tls12_crypto_info_aes_gcm_256 aes_gcm_256;
+  CNIOBoringSSLShims_tls12_crypto_info_chacha20_poly1305 chacha20_poly1305;
+} CNIOBoringSSLShims_kernel_tls_crypto_info;
+
+int CNIOBoringSSLShims_SSL_get_kernel_tls_crypto_info(const SSL *ssl, int write,
+                                                      CNIOBoringSSLShims_kernel_tls_crypto_info *out);
+
+// Serialization of established server connections, for moving them to another
+// process. See shims_handback.cc.
+int CNIOBoringSSLShims_SSL_serialize_handback(const SSL *ssl, CBB *out);
+int CNIOBoringSSLShims_SSL_apply_handback(SSL *ssl, const uint8_t *handback, size_t handback_len);
+
+// zlib certificate compression, with zlib loaded at runtime. The decompression
+// function is an ssl_cert_decompression_func_t. See shims_cert_compression.c.
+int CNIOBoringSSLShims_zlib_available(void);
+int CNIOBoringSSLShims_zlib_compress(CBB *out, const uint8_t *in, size_t in_len);
+int CNIOBoringSSLShims_SSL_zlib_decompress_certificate(SSL *ssl, CRYPTO_BUFFER **out, size_t uncompressed_len,
+                                                       const uint8_t *in, size_t in_len);
+
+// Hashes the subject name of a DER certificate, as X509_NAME_hash does, without
+// parsing the rest of it. See shims_trust_store.c.
+int CNIOBoringSSLShims_CRYPTO_BUFFER_subject_name_hash(const CRYPTO_BUFFER *buffer, uint32_t *out_hash);
+
+#if defined(__cplusplus)
+}  // extern "C"
+#endif
+
 #endif  // C_NIO_BORINGSSL_SHIMS_H
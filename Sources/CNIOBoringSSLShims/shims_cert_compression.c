@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+// zlib certificate compression (RFC 8879). BoringSSL leaves the compression
+// itself to the application, and zlib is only reachable from C.
+//
+// zlib is loaded when first needed rather than linked, so that consumers of
+// the package do not need its headers or library to build. The few functions
+// used here have had the same ABI since zlib 1.0.
+#include "CNIOBoringSSLShims.h"
+
+#include <dlfcn.h>
+#include <limits.h>
+#include <pthread.h>
+
+#if defined(__APPLE__)
+#define CNIOBORINGSSLSHIMS_ZLIB_NAME "/usr/lib/libz.1.dylib"
+#else
+#define CNIOBORINGSSLSHIMS_ZLIB_NAME "libz.so.1"
+#endif
+
+// From zlib.h.
+#define CNIOBORINGSSLSHIMS_Z_OK 0
+#define CNIOBORINGSSLSHIMS_Z_BEST_COMPRESSION 9
+
+typedef unsigned long (*compress_bound_func)(unsigned long source_len);
+typedef int (*compress2_func)(uint8_t *dest, unsigned long *dest_len, const uint8_t *source,
+                              unsigned long source_len, int level);
+typedef int (*uncompress_func)(uint8_t *dest, unsigned long *dest_len, const uint8_t *source,
+                               unsigned long source_len);
+
+static pthread_once_t zlib_once = PTHREAD_ONCE_INIT;
+static compress_bound_func zlib_compress_bound;
+static compress2_func zlib_compress2;
+static uncompress_func zlib_uncompress;
+
+static void load_zlib(void) {
+  void *handle = dlopen(CNIOBORINGSSLSHIMS_ZLIB_NAME, RTLD_NOW | RTLD_LOCAL);
+  if (handle == NULL) {
+    return;
+  }
+
+  compress_bound_func compress_bound = (compress_bound_func)dlsym(handle, "compressBound");
+  compress2_func compress2 = (compress2_func)dlsym(handle, "compress2");
+  uncompress_func uncompress = (uncompress_func)dlsym(handle, "uncompress");
+  if (compress_bound == NULL || compress2 == NULL || uncompress == NULL) {
+    dlclose(handle);
+    return;
+  }
+
+  // The handle is deliberately never closed: the functions are used for the
+  // lifetime of the process.
+  zlib_compress_bound = compress_bound;
+  zlib_compress2 = compress2;
+  zlib_uncompress = uncompress;
+}
+
+int CNIOBoringSSLShims_zlib_available(void) {
+  pthread_once(&zlib_once, load_zlib);
+  return zlib_uncompress != NULL;
+}
+
+int CNIOBoringSSLShims_zlib_compress(CBB *out, const uint8_t *in, size_t in_len) {
+  if (!CNIOBoringSSLShims_zlib_available() || in_len > ULONG_MAX) {
+    return 0;
+  }
+
+  unsigned long compressed_len = zlib_compress_bound((unsigned long)in_len);
+  uint8_t *compressed;
+  if (!CBB_reserve(out, &compressed, compressed_len) ||
+      zlib_compress2(compressed, &compressed_len, in, (unsigned long)in_len,
+                     CNIOBORINGSSLSHIMS_Z_BEST_COMPRESSION) != CNIOBORINGSSLSHIMS_Z_OK) {
+    return 0;
+  }
+  return CBB_did_write(out, compressed_len);
+}
+
+int CNIOBoringSSLShims_SSL_zlib_decompress_certificate(SSL *ssl, CRYPTO_BUFFER **out, size_t uncompressed_len,
+                                                       const uint8_t *in, size_t in_len) {
+  (void)ssl;
+  if (!CNIOBoringSSLShims_zlib_available() || uncompressed_len > ULONG_MAX || in_len > ULONG_MAX) {
+    return 0;
+  }
+
+  uint8_t *data;
+  CRYPTO_BUFFER *buffer = CRYPTO_BUFFER_alloc(&data, uncompressed_len);
+  if (buffer == NULL) {
+    return 0;
+  }
+
+  // The peer told us the uncompressed length, and anything else is an error.
+  unsigned long actual_len = (unsigned long)uncompressed_len;
+  if (zlib_uncompress(data, &actual_len, in, (unsigned long)in_len) != CNIOBORINGSSLSHIMS_Z_OK ||
+      actual_len != uncompressed_len) {
+    CRYPTO_BUFFER_free(buffer);
+    return 0;
+  }
+
+  *out = buffer;
+  return 1;
+}
@@ -0,0 +1,118 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+// Moves an established server connection between processes. BoringSSL's handback
+// can only be serialized from inside a split handshake, so this writes the same
+// structure for a connection whose handshake has completed, using only public
+// APIs. |SSL_apply_handback| then restores it, and lives in the bssl C++
+// namespace, so it is wrapped here too.
+#include "CNIOBoringSSLShims.h"
+
+#include <string.h>
+
+namespace {
+
+// These must match |kHandbackVersion| and |handback_after_handshake| in
+// ssl/handoff.cc and ssl/internal.h.
+constexpr uint64_t kHandbackVersion = 0;
+constexpr uint64_t kHandbackAfterHandshake = 2;
+
+bool add_session(CBB *out, const SSL_SESSION *session) {
+  uint8_t *bytes;
+  size_t bytes_len;
+  if (!SSL_SESSION_to_bytes(session, &bytes, &bytes_len)) {
+    return false;
+  }
+  const bool ok = CBB_add_bytes(out, bytes, bytes_len) == 1;
+  OPENSSL_free(bytes);
+  return ok;
+}
+
+void write_sequence(uint8_t out[8], uint64_t sequence) {
+  for (int i = 0; i < 8; i++) {
+    out[i] = static_cast<uint8_t>(sequence >> (56 - 8 * i));
+  }
+}
+
+}  // namespace
+
+// Writes the state of |ssl| to |out| in the form |SSL_apply_handback| reads. Returns
+// one on success, and zero if |ssl| is not an established TLS 1.1 or TLS 1.2 server
+// connection, or if BoringSSL holds data it has read but not yet returned.
+int CNIOBoringSSLShims_SSL_serialize_handback(const SSL *ssl, CBB *out) {
+  const int version = SSL_version(ssl);
+  const SSL_SESSION *session = SSL_get_session(ssl);
+  if (!SSL_is_server(ssl) || SSL_in_init(ssl) || SSL_has_pending(ssl) || session == nullptr ||
+      SSL_get_current_cipher(ssl) == nullptr || (version != TLS1_1_VERSION && version != TLS1_2_VERSION)) {
+    return 0;
+  }
+
+  uint8_t read_sequence[8], write_sequence_bytes[8];
+  write_sequence(read_sequence, SSL_get_read_sequence(ssl));
+  write_sequence(write_sequence_bytes, SSL_get_write_sequence(ssl));
+
+  uint8_t client_random[SSL3_RANDOM_SIZE], server_random[SSL3_RANDOM_SIZE];
+  if (SSL_get_client_random(ssl, client_random, sizeof(client_random)) != sizeof(client_random) ||
+      SSL_get_server_random(ssl, server_random, sizeof(server_random)) != sizeof(server_random)) {
+    return 0;
+  }
+
+  const uint8_t *next_proto, *alpn;
+  unsigned next_proto_len, alpn_len;
+  SSL_get0_next_proto_negotiated(ssl, &next_proto, &next_proto_len);
+  SSL_get0_alpn_selected(ssl, &alpn, &alpn_len);
+
+  const char *hostname = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+  const size_t hostname_len = hostname == nullptr ? 0 : strlen(hostname);
+
+  static const uint8_t kUnusedChannelID[64] = {0};
+  CBB seq, key_share;
+  if (!CBB_add_asn1(out, &seq, CBS_ASN1_SEQUENCE) ||
+      !CBB_add_asn1_uint64(&seq, kHandbackVersion) ||
+      !CBB_add_asn1_uint64(&seq, kHandbackAfterHandshake) ||
+      !CBB_add_asn1_octet_string(&seq, read_sequence, sizeof(read_sequence)) ||
+      !CBB_add_asn1_octet_string(&seq, write_sequence_bytes, sizeof(write_sequence_bytes)) ||
+      !CBB_add_asn1_octet_string(&seq, server_random, sizeof(server_random)) ||
+      !CBB_add_asn1_octet_string(&seq, client_random, sizeof(client_random)) ||
+      // The read and write IVs are only needed for TLS 1.0 block ciphers.
+      !CBB_add_asn1_octet_string(&seq, nullptr, 0) ||
+      !CBB_add_asn1_octet_string(&seq, nullptr, 0) ||
+      !CBB_add_asn1_bool(&seq, SSL_session_reused(ssl)) ||
+      !CBB_add_asn1_bool(&seq, 0) ||
+      !add_session(&seq, session) ||
+      !CBB_add_asn1_octet_string(&seq, next_proto, next_proto_len) ||
+      !CBB_add_asn1_octet_string(&seq, alpn, alpn_len) ||
+      !CBB_add_asn1_octet_string(&seq, reinterpret_cast<const uint8_t *>(hostname), hostname_len) ||
+      !CBB_add_asn1_octet_string(&seq, kUnusedChannelID, sizeof(kUnusedChannelID)) ||
+      !CBB_add_asn1_bool(&seq, 0) ||
+      !CBB_add_asn1_uint64(&seq, 0) ||
+      // The remaining handshake flags only matter to a handshake that is still running.
+      !CBB_add_asn1_bool(&seq, 0) ||
+      !CBB_add_asn1_bool(&seq, 0) ||
+      !CBB_add_asn1_bool(&seq, SSL_get_extms_support(ssl)) ||
+      !CBB_add_asn1_bool(&seq, 0) ||
+      !CBB_add_asn1_uint64(&seq, SSL_CIPHER_get_id(SSL_get_current_cipher(ssl))) ||
+      !CBB_add_asn1_octet_string(&seq, nullptr, 0) ||
+      !CBB_add_asn1(&seq, &key_share, CBS_ASN1_SEQUENCE)) {
+    return 0;
+  }
+  return CBB_flush(out);
+}
+
+// Restores a connection written by |CNIOBoringSSLShims_SSL_serialize_handback| into
+// |ssl|, which must be fresh, with neither the accept nor connect state set. The
+// connection is established once |SSL_do_handshake| next succeeds. Returns one on
+// success and zero on error.
+int CNIOBoringSSLShims_SSL_apply_handback(SSL *ssl, const uint8_t *handback, size_t handback_len) {
+  return bssl::SSL_apply_handback(ssl, bssl::MakeConstSpan(handback, handback_len)) ? 1 : 0;
+}
@@ -0,0 +1,156 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+// Extracts the record protection state of an established connection in the form
+// Linux's kernel TLS expects. The TLS 1.3 traffic secrets are only available
+// through a C++ API, so this lives here rather than in Swift.
+#include "CNIOBoringSSLShims.h"
+
+#include <string.h>
+
+namespace {
+
+// HKDF-Expand-Label from RFC 8446, section 7.1, with an empty context.
+bool hkdf_expand_label(uint8_t *out, size_t out_len, const EVP_MD *digest, bssl::Span<const uint8_t> secret,
+                       const char *label) {
+  static const char kLabelPrefix[] = "tls13 ";
+  const size_t prefix_len = strlen(kLabelPrefix);
+  const size_t label_len = strlen(label);
+
+  uint8_t info[2 + 1 + 255 + 1];
+  size_t info_len = 0;
+  info[info_len++] = static_cast<uint8_t>(out_len >> 8);
+  info[info_len++] = static_cast<uint8_t>(out_len);
+  info[info_len++] = static_cast<uint8_t>(prefix_len + label_len);
+  memcpy(info + info_len, kLabelPrefix, prefix_len);
+  info_len += prefix_len;
+  memcpy(info + info_len, label, label_len);
+  info_len += label_len;
+  info[info_len++] = 0;
+
+  return HKDF_expand(out, out_len, digest, secret.data(), secret.size(), info, info_len) == 1;
+}
+
+void write_sequence(uint8_t out[8], uint64_t sequence) {
+  for (int i = 0; i < 8; i++) {
+    out[i] = static_cast<uint8_t>(sequence >> (56 - 8 * i));
+  }
+}
+
+}  // namespace
+
+// Fills |out| with the key material and sequence number for |ssl|'s read or
+// write direction. Returns one on success, and zero if the connection has not
+// completed the handshake or uses a version or cipher kernel TLS does not
+// support.
+int CNIOBoringSSLShims_SSL_get_kernel_tls_crypto_info(const SSL *ssl, int write,
+                                                      CNIOBoringSSLShims_kernel_tls_crypto_info *out) {
+  const SSL_CIPHER *cipher = SSL_get_current_cipher(ssl);
+  const int version = SSL_version(ssl);
+  if (cipher == nullptr || SSL_in_init(ssl) || (version != TLS1_2_VERSION && version != TLS1_3_VERSION)) {
+    return 0;
+  }
+
+  memset(out, 0, sizeof(*out));
+  uint16_t cipher_type;
+  uint8_t *key, *iv, *salt, *rec_seq;
+  size_t key_len, iv_len, salt_len;
+  switch (SSL_CIPHER_get_cipher_nid(cipher)) {
+    case NID_aes_128_gcm:
+      cipher_type = CNIOBoringSSLShims_TLS_CIPHER_AES_GCM_128;
+      key = out->aes_gcm_128.key;
+      key_len = sizeof(out->aes_gcm_128.key);
+      iv = out->aes_gcm_128.iv;
+      iv_len = sizeof(out->aes_gcm_128.iv);
+      salt = out->aes_gcm_128.salt;
+      salt_len = sizeof(out->aes_gcm_128.salt);
+      rec_seq = out->aes_gcm_128.rec_seq;
+      break;
+    case NID_aes_256_gcm:
+      cipher_type = CNIOBoringSSLShims_TLS_CIPHER_AES_GCM_256;
+      key = out->aes_gcm_256.key;
+      key_len = sizeof(out->aes_gcm_256.key);
+      iv = out->aes_gcm_256.iv;
+      iv_len = sizeof(out->aes_gcm_256.iv);
+      salt = out->aes_gcm_256.salt;
+      salt_len = sizeof(out->aes_gcm_256.salt);
+      rec_seq = out->aes_gcm_256.rec_seq;
+      break;
+    case NID_chacha20_poly1305:
+      cipher_type = CNIOBoringSSLShims_TLS_CIPHER_CHACHA20_POLY1305;
+      key = out->chacha20_poly1305.key;
+      key_len = sizeof(out->chacha20_poly1305.key);
+      iv = out->chacha20_poly1305.iv;
+      iv_len = sizeof(out->chacha20_poly1305.iv);
+      salt = nullptr;
+      salt_len = 0;
+      rec_seq = out->chacha20_poly1305.rec_seq;
+      break;
+    default:
+      return 0;
+  }
+
+  const uint64_t sequence = write ? SSL_get_write_sequence(ssl) : SSL_get_read_sequence(ssl);
+
+  // The fixed part of the nonce. In TLS 1.3, and for ChaCha20-Poly1305, this is the
+  // whole 12 byte nonce. TLS 1.2 AES-GCM only fixes the first 4 bytes, and sends the
+  // rest explicitly in each record.
+  uint8_t fixed_iv[12];
+  size_t fixed_iv_len = salt_len + iv_len;
+  bool ok;
+  if (version == TLS1_3_VERSION) {
+    bssl::Span<const uint8_t> read_secret, write_secret;
+    const EVP_MD *digest = EVP_get_digestbynid(SSL_CIPHER_get_prf_nid(cipher));
+    ok = digest != nullptr && bssl::SSL_get_traffic_secrets(ssl, &read_secret, &write_secret) &&
+         hkdf_expand_label(key, key_len, digest, write ? write_secret : read_secret, "key") &&
+         hkdf_expand_label(fixed_iv, fixed_iv_len, digest, write ? write_secret : read_secret, "iv");
+  } else {
+    if (cipher_type != CNIOBoringSSLShims_TLS_CIPHER_CHACHA20_POLY1305) {
+      fixed_iv_len = salt_len;
+    }
+
+    // The key block is the client and server MAC keys, then the client and server
+    // keys, then the client and server fixed IVs. The AEAD ciphers have no MAC keys.
+    uint8_t key_block[2 * (32 + 12)];
+    const size_t key_block_len = SSL_get_key_block_len(ssl);
+    const bool use_client_keys = (SSL_is_server(ssl) != 0) != (write != 0);
+    ok = key_block_len == 2 * (key_len + fixed_iv_len) &&
+         SSL_generate_key_block(ssl, key_block, key_block_len);
+    if (ok) {
+      memcpy(key, key_block + (use_client_keys ? 0 : key_len), key_len);
+      memcpy(fixed_iv, key_block + 2 * key_len + (use_client_keys ? 0 : fixed_iv_len), fixed_iv_len);
+    }
+    OPENSSL_cleanse(key_block, sizeof(key_block));
+  }
+
+  if (ok) {
+    // The kernel takes the fixed IV as a salt followed by an IV. When the fixed IV
+    // is only the salt, the IV is the explicit nonce, which BoringSSL sets to the
+    // sequence number.
+    if (salt_len > 0) {
+      memcpy(salt, fixed_iv, salt_len);
+    }
+    if (fixed_iv_len > salt_len) {
+      memcpy(iv, fixed_iv + salt_len, iv_len);
+    } else {
+      write_sequence(iv, sequence);
+    }
+    write_sequence(rec_seq, sequence);
+    out->info.version = static_cast<uint16_t>(version);
+    out->info.cipher_type = cipher_type;
+  } else {
+    OPENSSL_cleanse(out, sizeof(*out));
+  }
+  OPENSSL_cleanse(fixed_iv, sizeof(fixed_iv));
+  return ok ? 1 : 0;
+}
@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+// BoringSSL's record-level APIs live in the bssl C++ namespace and take Spans,
+// neither of which the clang importer can handle. This file wraps them in C.
+#include "CNIOBoringSSLShims.h"
+
+CNIOBoringSSLShims_open_record_result CNIOBoringSSLShims_SSL_open_record(SSL *ssl, uint8_t *in, size_t in_len,
+                                                                         size_t *out_plaintext_offset,
+                                                                         size_t *out_plaintext_len,
+                                                                         size_t *out_record_len,
+                                                                         uint8_t *out_alert) {
+  bssl::Span<uint8_t> plaintext;
+  *out_record_len = 0;
+  *out_alert = 0;
+
+  switch (bssl::OpenRecord(ssl, &plaintext, out_record_len, out_alert, bssl::MakeSpan(in, in_len))) {
+    case bssl::OpenRecordResult::kOK:
+      // The record is decrypted in place, so the plaintext lies within |in|.
+      *out_plaintext_offset = plaintext.data() - in;
+      *out_plaintext_len = plaintext.size();
+      return CNIOBoringSSLShims_open_record_ok;
+    case bssl::OpenRecordResult::kDiscard:
+      return CNIOBoringSSLShims_open_record_discard;
+    case bssl::OpenRecordResult::kIncompleteRecord:
+      return CNIOBoringSSLShims_open_record_incomplete;
+    case bssl::OpenRecordResult::kAlertCloseNotify:
+      return CNIOBoringSSLShims_open_record_close_notify;
+    case bssl::OpenRecordResult::kError:
+      break;
+  }
+  return CNIOBoringSSLShims_open_record_error;
+}
+
+size_t CNIOBoringSSLShims_SSL_sealed_record_len(const SSL *ssl, size_t plaintext_len) {
+  return bssl::SealRecordPrefixLen(ssl, plaintext_len) + plaintext_len +
+         bssl::SealRecordSuffixLen(ssl, plaintext_len);
+}
+
+// Seals |in| as a single application data record into |out|, which must be exactly
+// |CNIOBoringSSLShims_SSL_sealed_record_len| bytes long. Returns one on success and
+// zero on error.
+int CNIOBoringSSLShims_SSL_seal_record(SSL *ssl, uint8_t *out, size_t out_len, const uint8_t *in, size_t in_len) {
+  const size_t prefix_len = bssl::SealRecordPrefixLen(ssl, in_len);
+  const size_t suffix_len = bssl::SealRecordSuffixLen(ssl, in_len);
+  if (out_len != prefix_len + in_len + suffix_len) {
+    return 0;
+  }
+
+  bssl::Span<uint8_t> out_span = bssl::MakeSpan(out, out_len);
+  return bssl::SealRecord(ssl, out_span.subspan(0, prefix_len), out_span.subspan(prefix_len, in_len),
+                          out_span.subspan(prefix_len + in_len), bssl::MakeConstSpan(in, in_len));
+}
+
+// Like |CNIOBoringSSLShims_SSL_seal_record|, but the plaintext is the concatenation of
+// the |num_in| buffers |in|, which BoringSSL encrypts straight into the record without
+// first copying them into a contiguous buffer. |out_len| must be the sealed record
+// length for their combined length.
+int CNIOBoringSSLShims_SSL_seal_record_gather(SSL *ssl, uint8_t *out, size_t out_len,
+                                              const uint8_t *const *in, const size_t *in_len,
+                                              size_t num_in) {
+  size_t plaintext_len = 0;
+  for (size_t i = 0; i < num_in; i++) {
+    plaintext_len += in_len[i];
+  }
+  const size_t prefix_len = bssl::SealRecordPrefixLen(ssl, plaintext_len);
+  const size_t suffix_len = bssl::SealRecordSuffixLen(ssl, plaintext_len);
+  if (out_len != prefix_len + plaintext_len + suffix_len) {
+    return 0;
+  }
+
+  bssl::Span<uint8_t> out_span = bssl::MakeSpan(out, out_len);
+  return bssl::SealRecordGather(ssl, out_span.subspan(0, prefix_len), out_span.subspan(prefix_len, plaintext_len),
+                                out_span.subspan(prefix_len + plaintext_len), in, in_len, num_in);
+}
@@ -0,0 +1,44 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+// Indexing of trust roots without parsing them. Only the subject name is
+// decoded, so that the rest of each certificate can be parsed on first use.
+#include "CNIOBoringSSLShims.h"
+
+int CNIOBoringSSLShims_CRYPTO_BUFFER_subject_name_hash(const CRYPTO_BUFFER *buffer, uint32_t *out_hash) {
+  CBS cbs, certificate, tbs_certificate, subject;
+  CRYPTO_BUFFER_init_CBS(buffer, &cbs);
+
+  // Certificate ::= SEQUENCE { tbsCertificate TBSCertificate, ... }
+  // TBSCertificate ::= SEQUENCE { version [0] OPTIONAL, serialNumber, signature, issuer, validity, subject, ... }
+  if (!CBS_get_asn1(&cbs, &certificate, CBS_ASN1_SEQUENCE) ||
+      !CBS_get_asn1(&certificate, &tbs_certificate, CBS_ASN1_SEQUENCE) ||
+      !CBS_get_optional_asn1(&tbs_certificate, NULL, NULL, CBS_ASN1_CONTEXT_SPECIFIC | CBS_ASN1_CONSTRUCTED | 0) ||
+      !CBS_get_asn1(&tbs_certificate, NULL, CBS_ASN1_INTEGER) ||
+      !CBS_get_asn1(&tbs_certificate, NULL, CBS_ASN1_SEQUENCE) ||
+      !CBS_get_asn1(&tbs_certificate, NULL, CBS_ASN1_SEQUENCE) ||
+      !CBS_get_asn1(&tbs_certificate, NULL, CBS_ASN1_SEQUENCE) ||
+      !CBS_get_asn1_element(&tbs_certificate, &subject, CBS_ASN1_SEQUENCE)) {
+    return 0;
+  }
+
+  // X509_NAME_hash hashes the canonical form of the name, so it matches names that X509_NAME_cmp considers equal.
+  const uint8_t *der = CBS_data(&subject);
+  X509_NAME *name = d2i_X509_NAME(NULL, &der, (long)CBS_len(&subject));
+  if (name == NULL) {
+    return 0;
+  }
+  *out_hash = (uint32_t)X509_NAME_hash(name);
+  X509_NAME_free(name);
+  return 1;
+}
@@ -0,0 +1,164 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+import NIOConcurrencyHelpers
+
+/// A single signing operation within a batch submitted to a `NIOSSLBatchSigningKey`.
+public struct NIOSSLSigningRequest {
+    /// The `SignatureAlgorithm` that should be used to generate the signature.
+    public var algorithm: SignatureAlgorithm
+
+    /// The data to be signed. As with `NIOSSLCustomPrivateKey`, this has not been hashed.
+    public var data: ByteBuffer
+
+    public init(algorithm: SignatureAlgorithm, data: ByteBuffer) {
+        self.algorithm = algorithm
+        self.data = data
+    }
+}
+
+/// A private key, usually held in another process or device, that can perform many signing operations
+/// in a single call.
+///
+/// Use this with `NIOSSLBatchingCustomPrivateKey`, which collects the signing operations of many handshakes
+/// and submits them together.
+public protocol NIOSSLBatchSigningKey: AnyObject {
+    /// The signature algorithms supported by this key.
+    var signatureAlgorithms: [SignatureAlgorithm] { get }
+
+    /// Called to perform a batch of signing operations.
+    ///
+    /// This call will always execute on `eventLoop`, and every request in the batch comes from a connection
+    /// on that event loop.
+    ///
+    /// - parameters:
+    ///     - batch: The signing operations to perform.
+    ///     - eventLoop: The `EventLoop` of the connections the requests come from.
+    /// - returns: An `EventLoopFuture` that will be fulfilled with one result per request, in the same order as
+    ///     `batch`, or that will be failed if none of the signatures could be produced.
+    func sign(batch: [NIOSSLSigningRequest], eventLoop: EventLoop) -> EventLoopFuture<[Result<ByteBuffer, Error>]>
+
+    /// Called to perform a decryption operation. See `NIOSSLCustomPrivateKey.decrypt(channel:data:)`.
+    ///
+    /// Decryption is only used by RSA key exchange, which is rare, so it is not batched.
+    func decrypt(channel: Channel, data: ByteBuffer) -> EventLoopFuture<ByteBuffer>
+}
+
+/// A `NIOSSLCustomPrivateKey` that collects the signing operations requested by handshakes on each event loop
+/// and submits them to a `NIOSSLBatchSigningKey` together.
+///
+/// A batch is submitted when it reaches `maximumBatchSize` requests, or `batchingWindow` after its first request
+/// was made, whichever happens first. Each handshake resumes as soon as its own signature is available.
+public final class NIOSSLBatchingCustomPrivateKey: NIOSSLCustomPrivateKey, Hashable {
+    /// The requests waiting to be submitted from one event loop.
+    private struct PendingBatch {
+        var requests: [NIOSSLSigningRequest] = []
+        var promises: [EventLoopPromise<ByteBuffer>] = []
+        var scheduledSubmission: Scheduled<Void>? = nil
+    }
+
+    private let key: NIOSSLBatchSigningKey
+    private let maximumBatchSize: Int
+    private let batchingWindow: TimeAmount
+
+    private let lock = Lock()
+    private var pendingBatches: [ObjectIdentifier: PendingBatch] = [:]
+
+    /// Create a key that batches signing operations.
+    ///
+    /// - parameters:
+    ///     - key: The key that performs the signing operations.
+    ///     - maximumBatchSize: The largest number of requests to submit in one batch. Must be at least 1.
+    ///     - batchingWindow: The longest time to hold a request while waiting for others to join its batch.
+    public init(key: NIOSSLBatchSigningKey, maximumBatchSize: Int = 32, batchingWindow: TimeAmount = .milliseconds(1)) {
+        precondition(maximumBatchSize > 0, "maximumBatchSize must be at least 1")
+        self.key = key
+        self.maximumBatchSize = maximumBatchSize
+        self.batchingWindow = batchingWindow
+    }
+
+    public var signatureAlgorithms: [SignatureAlgorithm] {
+        return self.key.signatureAlgorithms
+    }
+
+    public func sign(channel: Channel, algorithm: SignatureAlgorithm, data: ByteBuffer) -> EventLoopFuture<ByteBuffer> {
+        let eventLoop = channel.eventLoop
+        let promise = eventLoop.makePromise(of: ByteBuffer.self)
+        let loopID = ObjectIdentifier(eventLoop)
+
+        let (fullBatch, isFirstRequest) = self.lock.withLock { () -> (PendingBatch?, Bool) in
+            var batch = self.pendingBatches.removeValue(forKey: loopID) ?? PendingBatch()
+            batch.requests.append(NIOSSLSigningRequest(algorithm: algorithm, data: data))
+            batch.promises.append(promise)
+
+            if batch.requests.count >= self.maximumBatchSize {
+                return (batch, false)
+            }
+            self.pendingBatches[loopID] = batch
+            return (nil, batch.requests.count == 1)
+        }
+
+        if let fullBatch = fullBatch {
+            fullBatch.scheduledSubmission?.cancel()
+            self.submit(fullBatch, eventLoop: eventLoop)
+        } else if isFirstRequest {
+            let scheduled = eventLoop.scheduleTask(in: self.batchingWindow) {
+                self.submitPendingBatch(eventLoop: eventLoop)
+            }
+            self.lock.withLockVoid {
+                self.pendingBatches[loopID]?.scheduledSubmission = scheduled
+            }
+        }
+
+        return promise.futureResult
+    }
+
+    public func decrypt(channel: Channel, data: ByteBuffer) -> EventLoopFuture<ByteBuffer> {
+        return self.key.decrypt(channel: channel, data: data)
+    }
+
+    private func submitPendingBatch(eventLoop: EventLoop) {
+        let batch = self.lock.withLock {
+            self.pendingBatches.removeValue(forKey: ObjectIdentifier(eventLoop))
+        }
+        if let batch = batch {
+            self.submit(batch, eventLoop: eventLoop)
+        }
+    }
+
+    private func submit(_ batch: PendingBatch, eventLoop: EventLoop) {
+        self.key.sign(batch: batch.requests, eventLoop: eventLoop).whenComplete { result in
+            switch result {
+            case .success(let results) where results.count == batch.promises.count:
+                for (promise, result) in zip(batch.promises, results) {
+                    promise.completeWith(result)
+                }
+            case .success(let results):
+                let error = NIOSSLExtraError.invalidBatchSigningResult(expected: batch.promises.count, actual: results.count)
+                batch.promises.forEach { $0.fail(error) }
+            case .failure(let error):
+                batch.promises.forEach { $0.fail(error) }
+            }
+        }
+    }
+
+    public static func ==(lhs: NIOSSLBatchingCustomPrivateKey, rhs: NIOSSLBatchingCustomPrivateKey) -> Bool {
+        return lhs === rhs
+    }
+
+    public func hash(into hasher: inout Hasher) {
+        hasher.combine(ObjectIdentifier(self))
+    }
+}
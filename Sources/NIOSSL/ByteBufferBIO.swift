@@ -288,6 +288,26 @@ final class ByteBufferBIO {
         return self.outboundBuffer
     }
 
+    /// Writes ciphertext produced outside of BoringSSL's BIO calls directly into the outbound buffer.
+    ///
+    /// `body` is given exactly `length` writable bytes, and must fill all of them. If `body` returns
+    /// `false` nothing is written.
+    ///
+    /// - returns: The value returned by `body`.
+    func writeOutboundCiphertext(length: Int, _ body: (UnsafeMutableRawBufferPointer) -> Bool) -> Bool {
+        if self.mustClearOutboundBuffer {
+            // We just flushed, and this is a new write. Let's clear the buffer now.
+            self.outboundBuffer.clear()
+        }
+
+        var succeeded = false
+        self.outboundBuffer.writeWithUnsafeMutableBytes(minimumWritableBytes: length) { pointer in
+            succeeded = body(UnsafeMutableRawBufferPointer(rebasing: pointer.prefix(length)))
+            return succeeded ? length : 0
+        }
+        return succeeded
+    }
+
     /// Stores a buffer received from the network for delivery to BoringSSL.
     ///
     /// Whenever a buffer is received from the network, it is passed to the BIO via this function
@@ -308,6 +328,32 @@ final class ByteBufferBIO {
         }
     }
 
+    /// Whether there is inbound data that BoringSSL has not yet read.
+    var hasInboundData: Bool {
+        return self.inboundBuffer != nil
+    }
+
+    /// Whether the inbound data that BoringSSL has not yet read is made up of whole TLS records.
+    var inboundDataEndsOnRecordBoundary: Bool {
+        guard let inboundBuffer = self.inboundBuffer else {
+            return true
+        }
+
+        var index = inboundBuffer.readerIndex
+        while index < inboundBuffer.writerIndex {
+            guard let recordLength = inboundBuffer.getInteger(at: index + 3, as: UInt16.self) else {
+                return false
+            }
+            index += 5 + Int(recordLength)
+        }
+        return index == inboundBuffer.writerIndex
+    }
+
+    /// Whether there is outbound ciphertext that has not yet been taken by `outboundCiphertext`.
+    var hasOutboundData: Bool {
+        return self.outboundBuffer.readableBytes > 0
+    }
+
     /// Retrieves any inbound data that has not been processed by BoringSSL.
     ///
     /// When unwrapping TLS from a connection, there may be application bytes that follow the terminating
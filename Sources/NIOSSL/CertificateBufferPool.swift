@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+@_implementationOnly import CNIOBoringSSL
+
+/// A pool in which the certificates received by connections are interned, so that each distinct certificate is held
+/// in memory once however many connections and sessions refer to it.
+///
+/// Set a pool as the `TLSConfiguration.certificateBufferPool` of the contexts that should share it. Every certificate
+/// a connection of those contexts receives is looked up in the pool under its lock, so a pool shared by contexts
+/// used on many threads at once can become contended: prefer one pool per group of contexts that see the same peers.
+///
+/// BoringSSL requires a pool to outlive every object that may hold one of its buffers, including certificates handed
+/// out to users, which this object cannot track. The underlying pool is therefore never freed, and pools should be
+/// created once and kept for the life of the process. This object is thread-safe.
+public final class NIOSSLCertificateBufferPool {
+    internal let pool: OpaquePointer
+
+    /// Create a new, empty certificate buffer pool.
+    public init() {
+        self.pool = CNIOBoringSSL_CRYPTO_BUFFER_POOL_new()!
+    }
+
+    /// The current counters of this pool.
+    ///
+    /// These cover the certificates received by connections of every context using this pool, from the time the
+    /// pool was created. Certificates of contexts without a pool, and of other pools, are not counted.
+    public var statistics: NIOSSLCertificateBufferPoolStatistics {
+        var certificates = 0
+        var bytes = 0
+        var hits: UInt64 = 0
+        var misses: UInt64 = 0
+        CNIOBoringSSL_CRYPTO_BUFFER_POOL_get_stats(self.pool, &certificates, &bytes, &hits, &misses)
+        return NIOSSLCertificateBufferPoolStatistics(certificates: certificates,
+                                                     bytes: bytes,
+                                                     hits: Int(truncatingIfNeeded: hits),
+                                                     misses: Int(truncatingIfNeeded: misses))
+    }
+}
+
+/// A snapshot of the counters of a `NIOSSLCertificateBufferPool`.
+public struct NIOSSLCertificateBufferPoolStatistics: Hashable {
+    /// The number of distinct certificates currently held.
+    public var certificates: Int
+
+    /// The total size of the certificates currently held, in bytes.
+    public var bytes: Int
+
+    /// The number of times a certificate was already held, so no new copy was made.
+    public var hits: Int
+
+    /// The number of times a certificate was not already held, and a new copy was made.
+    public var misses: Int
+
+    public init(certificates: Int, bytes: Int, hits: Int, misses: Int) {
+        self.certificates = certificates
+        self.bytes = bytes
+        self.hits = hits
+        self.misses = misses
+    }
+
+    /// The fraction of certificates that were already held, or 0 if no certificates have been pooled.
+    public var hitRate: Double {
+        let total = self.hits + self.misses
+        return total == 0 ? 0 : Double(self.hits) / Double(total)
+    }
+}
+
+extension NIOSSLContext {
+    /// Makes a `SSL_CTX` intern the certificates its connections receive in `pool`.
+    internal static func configureCertificateBufferPool(context: OpaquePointer, pool: NIOSSLCertificateBufferPool) {
+        CNIOBoringSSL_SSL_CTX_set0_buffer_pool(context, pool.pool)
+    }
+}
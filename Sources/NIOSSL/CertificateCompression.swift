@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOConcurrencyHelpers
+@_implementationOnly import CNIOBoringSSL
+@_implementationOnly import CNIOBoringSSLShims
+
+/// An algorithm for compressing certificate chains in TLS 1.3 handshakes, as described in RFC 8879.
+///
+/// A compressed chain makes the server's first flight smaller, which can save a round trip when an uncompressed
+/// chain would not fit in the initial congestion window.
+public struct NIOSSLCertificateCompressionAlgorithm: Hashable {
+    /// The algorithm's IANA-assigned code point.
+    internal var rawValue: UInt16
+
+    private init(rawValue: UInt16) {
+        self.rawValue = rawValue
+    }
+
+    /// zlib compression, as described in RFC 1950.
+    ///
+    /// The system zlib is loaded the first time it is needed, so it is only available where the system provides it.
+    public static let zlib = NIOSSLCertificateCompressionAlgorithm(rawValue: UInt16(TLSEXT_cert_compression_zlib))
+
+    /// Whether this algorithm can be used in this process. Contexts do not offer algorithms that are unavailable.
+    public var isAvailable: Bool {
+        switch self {
+        case .zlib:
+            return CNIOBoringSSLShims_zlib_available() == 1
+        default:
+            return false
+        }
+    }
+}
+
+/// The compressed forms of the Certificate messages a context has sent.
+///
+/// BoringSSL asks for the Certificate message to be compressed on every handshake. The message is the same for every
+/// connection that uses the same certificate chain, so each one is only compressed once.
+internal final class CompressedCertificateCache {
+    private struct Key: Hashable {
+        var algorithm: NIOSSLCertificateCompressionAlgorithm
+        var certificateMessage: [UInt8]
+    }
+
+    /// The most messages to hold. A context that serves more certificate chains than this, from a certificate store
+    /// or a selection callback, empties the cache and starts again.
+    private static let maximumSize = 64
+
+    private let lock = Lock()
+    private var compressedMessages: [Key: [UInt8]] = [:]
+    private var _compressions = 0
+
+    /// Returns the compressed form of `certificateMessage`, calling `compress` to produce it if it is not cached.
+    func compressed(_ certificateMessage: UnsafeBufferPointer<UInt8>,
+                    algorithm: NIOSSLCertificateCompressionAlgorithm,
+                    compress: (UnsafeBufferPointer<UInt8>) -> [UInt8]?) -> [UInt8]? {
+        let key = Key(algorithm: algorithm, certificateMessage: Array(certificateMessage))
+        if let compressedMessage = self.lock.withLock({ self.compressedMessages[key] }) {
+            return compressedMessage
+        }
+
+        // Compress outside the lock. Two connections may race to compress the same message, but both get the
+        // same result.
+        guard let compressedMessage = compress(certificateMessage) else {
+            return nil
+        }
+
+        self.lock.withLockVoid {
+            self._compressions += 1
+            if self.compressedMessages.count >= CompressedCertificateCache.maximumSize {
+                self.compressedMessages.removeAll()
+            }
+            self.compressedMessages[key] = compressedMessage
+        }
+        return compressedMessage
+    }
+
+    /// The number of compressed messages currently cached.
+    var count: Int {
+        return self.lock.withLock { self.compressedMessages.count }
+    }
+
+    /// The number of times a message has been compressed.
+    var compressions: Int {
+        return self.lock.withLock { self._compressions }
+    }
+}
+
+extension NIOSSLContext {
+    /// Registers the certificate compression algorithms on a `SSL_CTX`, in order of preference. An algorithm
+    /// listed more than once is registered at its first position, as BoringSSL rejects repeats.
+    internal static func configureCertificateCompression(_ algorithms: [NIOSSLCertificateCompressionAlgorithm],
+                                                         context: OpaquePointer) {
+        var registered = Set<NIOSSLCertificateCompressionAlgorithm>()
+        for algorithm in algorithms where algorithm.isAvailable && registered.insert(algorithm).inserted {
+            switch algorithm {
+            case .zlib:
+                let rc = CNIOBoringSSL_SSL_CTX_add_cert_compression_alg(context, algorithm.rawValue, { ssl, out, input, inputLength in
+                    guard let ssl = ssl, let out = out else {
+                        return 0
+                    }
+                    let certificateMessage = UnsafeBufferPointer(start: input, count: inputLength)
+                    return NIOSSLContext.compressCertificateMessage(certificateMessage, algorithm: .zlib, ssl: ssl, out: out) { message in
+                        serializeWithCBB { CNIOBoringSSLShims_zlib_compress($0, message.baseAddress, message.count) }
+                    }
+                }, CNIOBoringSSLShims_SSL_zlib_decompress_certificate)
+                precondition(rc == 1, "Failed to register certificate compression algorithm \(algorithm.rawValue)")
+            default:
+                preconditionFailure("Unknown certificate compression algorithm \(algorithm.rawValue)")
+            }
+        }
+    }
+
+    private static func compressCertificateMessage(_ certificateMessage: UnsafeBufferPointer<UInt8>,
+                                                   algorithm: NIOSSLCertificateCompressionAlgorithm,
+                                                   ssl: OpaquePointer,
+                                                   out: UnsafeMutablePointer<CBB>,
+                                                   compress: (UnsafeBufferPointer<UInt8>) -> [UInt8]?) -> CInt {
+        let parentCtx = CNIOBoringSSL_SSL_get_SSL_CTX(ssl)!
+        let parentPtr = CNIOBoringSSLShims_SSL_CTX_get_app_data(parentCtx)!
+        let parentSwiftContext: NIOSSLContext = Unmanaged.fromOpaque(parentPtr).takeUnretainedValue()
+
+        guard let compressedMessage = parentSwiftContext.compressedCertificates.compressed(certificateMessage,
+                                                                                           algorithm: algorithm,
+                                                                                           compress: compress) else {
+            return 0
+        }
+        return compressedMessage.withUnsafeBufferPointer {
+            CNIOBoringSSL_CBB_add_bytes(out, $0.baseAddress, $0.count)
+        }
+    }
+}
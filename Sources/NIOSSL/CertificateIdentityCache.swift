@@ -0,0 +1,70 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+import NIOConcurrencyHelpers
+@_implementationOnly import CNIOBoringSSL
+
+/// The identities of the leaf certificates presented by the peers of a context, keyed by the buffer holding each
+/// certificate.
+///
+/// Only contexts with a `certificateBufferPool` have one: peer certificates are interned in the pool, so a peer
+/// presenting the same certificate again hands over the same buffer. The cache holds a reference to every buffer it
+/// is keyed by, so that no buffer can be freed, and its address reused for a different certificate, while it is a key.
+internal final class CertificateIdentityCache {
+    private let maximumSize: Int
+    private let lock = Lock()
+    private var identities: [OpaquePointer: CertificateIdentity] = [:]
+    private var insertionOrder = CircularBuffer<OpaquePointer>()
+
+    init(maximumSize: Int) {
+        self.maximumSize = maximumSize
+    }
+
+    deinit {
+        for buffer in self.identities.keys {
+            CNIOBoringSSL_CRYPTO_BUFFER_free(buffer)
+        }
+    }
+
+    /// The number of identities currently held.
+    var count: Int {
+        return self.lock.withLock { self.identities.count }
+    }
+
+    /// Returns the identity of the certificate in `buffer`, calling `makeIdentity` to analyse it if it is not cached.
+    func identity(forCertificate buffer: OpaquePointer, orInsert makeIdentity: () -> CertificateIdentity?) -> CertificateIdentity? {
+        if let identity = self.lock.withLock({ self.identities[buffer] }) {
+            return identity
+        }
+
+        guard let identity = makeIdentity() else {
+            return nil
+        }
+        self.lock.withLockVoid {
+            guard self.identities.updateValue(identity, forKey: buffer) == nil else {
+                return
+            }
+            CNIOBoringSSL_CRYPTO_BUFFER_up_ref(buffer)
+            self.insertionOrder.append(buffer)
+
+            while self.identities.count > self.maximumSize {
+                let evicted = self.insertionOrder.removeFirst()
+                self.identities.removeValue(forKey: evicted)
+                CNIOBoringSSL_CRYPTO_BUFFER_free(evicted)
+            }
+        }
+        return identity
+    }
+}
@@ -0,0 +1,207 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+@_implementationOnly import CNIOBoringSSL
+@_implementationOnly import CNIOBoringSSLShims
+
+/// A certificate chain and private key, prepared so that they can be given to a connection without copying.
+///
+/// Creating an identity converts the certificate chain to the form BoringSSL uses on the wire, so identities
+/// should be created once and reused for many connections.
+public final class NIOSSLIdentity {
+    /// The certificate chain, leaf first, as `CRYPTO_BUFFER`s.
+    internal let certificateBuffers: [OpaquePointer?]
+
+    /// The private key for the leaf certificate.
+    public let privateKey: NIOSSLPrivateKey
+
+    /// Create an identity from a certificate chain and the private key for its leaf certificate.
+    ///
+    /// - parameters:
+    ///     - certificateChain: The certificate chain to present, leaf first. Must not be empty.
+    ///     - privateKey: The private key for the leaf certificate.
+    /// - throws: `NIOSSLError.failedToLoadPrivateKey` if `privateKey` does not match the leaf certificate.
+    public init(certificateChain: [NIOSSLCertificate], privateKey: NIOSSLPrivateKey) throws {
+        precondition(!certificateChain.isEmpty, "certificateChain must not be empty")
+
+        // Catch mismatched keys now, rather than failing every handshake that uses them.
+        if case .native = privateKey.representation {
+            let rc = certificateChain[0].withUnsafeMutableX509Pointer { certificate in
+                privateKey.withUnsafeMutableEVPPKEYPointer { key in
+                    CNIOBoringSSL_X509_check_private_key(certificate, key)
+                }
+            }
+            guard rc == 1 else {
+                throw NIOSSLError.failedToLoadPrivateKey
+            }
+        }
+
+        var buffers: [OpaquePointer?] = []
+        buffers.reserveCapacity(certificateChain.count)
+        do {
+            for certificate in certificateChain {
+                let der = try certificate.toDERBytes()
+                guard let buffer = der.withUnsafeBufferPointer({ CNIOBoringSSL_CRYPTO_BUFFER_new($0.baseAddress, $0.count, nil) }) else {
+                    throw NIOSSLError.failedToLoadCertificate
+                }
+                buffers.append(buffer)
+            }
+        } catch {
+            buffers.forEach { CNIOBoringSSL_CRYPTO_BUFFER_free($0) }
+            throw error
+        }
+
+        self.certificateBuffers = buffers
+        self.privateKey = privateKey
+    }
+
+    deinit {
+        self.certificateBuffers.forEach { CNIOBoringSSL_CRYPTO_BUFFER_free($0) }
+    }
+}
+
+/// A callback that server-side contexts call during the handshake to choose the identity for a connection, for
+/// example by fetching it from another process.
+///
+/// The handshake is suspended until the returned future completes. Completing it with `nil` uses the identity the
+/// context would otherwise have used; failing it fails the handshake.
+///
+/// This callback is always invoked on `channel.eventLoop`, and is not invoked for connections whose server name
+/// has an identity in the configuration's `certificateStore`.
+///
+/// - parameters:
+///     - serverName: The server name the client sent using SNI, if any.
+///     - channel: The `Channel` for the connection.
+public typealias NIOSSLCertificateSelectionCallback = (_ serverName: String?, _ channel: Channel) -> EventLoopFuture<NIOSSLIdentity?>
+
+/// The progress of a connection's call to the `NIOSSLCertificateSelectionCallback`.
+internal enum CertificateSelectionState {
+    case notStarted
+    case pending
+    case complete(Result<NIOSSLIdentity?, Error>)
+}
+
+extension NIOSSLContext {
+    /// Installs the callback that picks each connection's certificate, from the certificate store, the certificate
+    /// selection callback, or credentials set with `setCredentials`.
+    internal static func configureCertificateSelection(context: OpaquePointer) {
+        CNIOBoringSSL_SSL_CTX_set_cert_cb(context, { ssl, _ in
+            guard let ssl = ssl else {
+                return 0
+            }
+
+            let parentCtx = CNIOBoringSSL_SSL_get_SSL_CTX(ssl)!
+            let parentPtr = CNIOBoringSSLShims_SSL_CTX_get_app_data(parentCtx)!
+            let parentSwiftContext: NIOSSLContext = Unmanaged.fromOpaque(parentPtr).takeUnretainedValue()
+            let connection = SSLConnection.loadConnectionFromSSL(ssl)
+
+            let identity: NIOSSLIdentity?
+            switch parentSwiftContext.selectIdentity(ssl: ssl, connection: connection) {
+            case .pending:
+                // Suspend the handshake: BoringSSL calls us again when it is resumed.
+                return -1
+            case .failed:
+                return 0
+            case .selected(let selected):
+                identity = selected
+            }
+
+            guard let identity = identity else {
+                // Use the context's own certificate, if it has one.
+                return 1
+            }
+
+            let rc = identity.certificateBuffers.withUnsafeBufferPointer { buffers -> CInt in
+                switch identity.privateKey.representation {
+                case .native:
+                    return identity.privateKey.withUnsafeMutableEVPPKEYPointer { ref in
+                        CNIOBoringSSL_SSL_set_chain_and_key(ssl, buffers.baseAddress, buffers.count, ref, nil)
+                    }
+                case .custom:
+                    return CNIOBoringSSL_SSL_set_chain_and_key(ssl, buffers.baseAddress, buffers.count,
+                                                               nil, customPrivateKeyMethod)
+                }
+            }
+            guard rc == 1 else {
+                return 0
+            }
+
+            // The custom private key callbacks need to find the key this connection ended up with.
+            connection.selectedPrivateKey = identity.privateKey
+            return 1
+        }, nil)
+    }
+
+    private enum IdentitySelection {
+        case selected(NIOSSLIdentity?)
+        case pending
+        case failed
+    }
+
+    /// The identity to use for `ssl` in place of the one the context was created with, if any. A matching
+    /// entry in the certificate store wins over the certificate selection callback, which wins over credentials
+    /// set with `setCredentials`.
+    private func selectIdentity(ssl: OpaquePointer, connection: SSLConnection) -> IdentitySelection {
+        guard CNIOBoringSSL_SSL_is_server(ssl) == 1 else {
+            return .selected(self.replacementCredentials)
+        }
+
+        let serverName = CNIOBoringSSL_SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name).map {
+            NIOSSLCertificateStore.normalize(String(cString: $0))
+        }
+
+        if let store = self.configuration.certificateStore,
+           let serverName = serverName,
+           let identity = store.identity(forServerName: serverName) {
+            return .selected(identity)
+        }
+
+        // Connections without a handler, such as those computing handshake hints, cannot wait for the callback.
+        if let callback = self.configuration.certificateSelectionCallback, connection.parentHandler != nil {
+            switch connection.certificateSelectionState {
+            case .notStarted:
+                connection.selectCertificate(serverName: serverName, callback: callback)
+                return .pending
+            case .pending:
+                return .pending
+            case .complete(.failure):
+                return .failed
+            case .complete(.success(.some(let identity))):
+                return .selected(identity)
+            case .complete(.success(.none)):
+                break
+            }
+        }
+
+        return .selected(self.replacementCredentials)
+    }
+}
+
+extension SSLConnection {
+    fileprivate func selectCertificate(serverName: String?, callback: NIOSSLCertificateSelectionCallback) {
+        // This force-unwrap pair is safe: we can only handshake while we're in a pipeline.
+        let channel = self.parentHandler!.channel!
+        self.certificateSelectionState = .pending
+
+        callback(serverName, channel).whenComplete { result in
+            // Always defer the resumption, as we may still be inside the handshake if the future was already
+            // complete. If we can't respin the handshake because we've dropped the parent handler, that's fine.
+            channel.eventLoop.execute {
+                self.certificateSelectionState = .complete(result)
+                self.parentHandler?.resumeHandshake()
+            }
+        }
+    }
+}
@@ -0,0 +1,36 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+/// The state of an established TLS connection, exported by `NIOSSLHandler.exportConnection()` so that another
+/// process can take the connection over without a new handshake.
+///
+/// To move a connection, pass its socket to the other process, for example over a UNIX domain socket, along with
+/// this state. The other process creates a channel from the socket, and adds a `NIOSSLServerHandler` created with
+/// `init(context:handback:)`, using a context with the same configuration.
+///
+/// The state contains the connection's keys, so it must only be passed to a trusted process, over a trusted
+/// transport.
+public struct NIOSSLConnectionHandback: Hashable {
+    /// The serialized TLS state of the connection.
+    public var state: [UInt8]
+
+    /// Data the peer had sent that the exporting handler had not yet processed. The importing handler processes
+    /// it before anything it reads from the socket.
+    public var unconsumedData: [UInt8]
+
+    public init(state: [UInt8], unconsumedData: [UInt8]) {
+        self.state = state
+        self.unconsumedData = unconsumedData
+    }
+}
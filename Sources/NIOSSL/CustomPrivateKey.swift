@@ -122,6 +122,13 @@ internal struct AnyNIOSSLCustomPrivateKey: NIOSSLCustomPrivateKey, Hashable {
 
 extension SSLConnection {
     fileprivate var customKey: NIOSSLCustomPrivateKey? {
+        if let key = self.selectedPrivateKey {
+            guard case .custom(let customKey) = key.representation else {
+                return nil
+            }
+            return customKey
+        }
+
         guard case .some(.privateKey(let key)) = self.parentContext.configuration.privateKey,
               case .custom(let customKey) = key.representation else {
             return nil
@@ -0,0 +1,79 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+
+/// Configuration for adaptive TLS record sizing.
+///
+/// A TLS record can only be decrypted once all of it has arrived. At the start of a connection, while the
+/// TCP congestion window is small, a 16kB record may take several round trips to deliver, delaying the first
+/// byte the peer can use. With dynamic record sizing, connections start out sending records that fit in a
+/// single TCP segment, and switch to full-size records once enough data has been sent to warm up the
+/// connection. A connection that has been idle for long enough goes back to small records.
+public struct NIOSSLDynamicRecordSizing: Hashable {
+    /// The maximum plaintext size of the records sent at the start of a connection, and after it has been idle.
+    public var initialRecordSize: Int
+
+    /// The number of bytes of application data to send in small records before switching to full-size records.
+    public var boostThreshold: Int
+
+    /// How long a connection must go without writing for it to go back to small records.
+    public var idleTimeout: TimeAmount
+
+    /// Create a new dynamic record sizing configuration.
+    ///
+    /// - parameters:
+    ///     - initialRecordSize: The size of records sent while the connection warms up. Defaults to 1400 bytes,
+    ///         so that a record and its overhead fit in a typical TCP segment. Must be between 512 and 16384.
+    ///     - boostThreshold: How many bytes to send before using full-size records. Defaults to 128kB.
+    ///     - idleTimeout: How long the connection must be idle before going back to small records. Defaults to 1 second.
+    public init(initialRecordSize: Int = 1400, boostThreshold: Int = 128 * 1024, idleTimeout: TimeAmount = .seconds(1)) {
+        precondition((512...SSL_MAX_RECORD_SIZE).contains(initialRecordSize),
+                     "initialRecordSize must be between 512 and \(SSL_MAX_RECORD_SIZE)")
+        precondition(boostThreshold >= 0, "boostThreshold must not be negative")
+        self.initialRecordSize = initialRecordSize
+        self.boostThreshold = boostThreshold
+        self.idleTimeout = idleTimeout
+    }
+}
+
+/// Tracks the state of a single connection's dynamic record sizing.
+internal struct DynamicRecordSizer {
+    private let configuration: NIOSSLDynamicRecordSizing
+    private var bytesSent = 0
+    private var lastFlush: NIODeadline?
+
+    init(configuration: NIOSSLDynamicRecordSizing) {
+        self.configuration = configuration
+    }
+
+    /// The record size to use for the next write.
+    var recordSize: Int {
+        return self.bytesSent >= self.configuration.boostThreshold ? SSL_MAX_RECORD_SIZE : self.configuration.initialRecordSize
+    }
+
+    /// Called when a flush begins writing, to go back to small records if the connection has been idle.
+    mutating func flushStarted(at now: NIODeadline) {
+        if let lastFlush = self.lastFlush, now - lastFlush >= self.configuration.idleTimeout {
+            self.bytesSent = 0
+        }
+        self.lastFlush = now
+    }
+
+    /// Called when application data has been encoded.
+    mutating func sent(bytes: Int) {
+        // We only care about the count until it reaches the threshold.
+        self.bytesSent = min(self.bytesSent + bytes, self.configuration.boostThreshold)
+    }
+}
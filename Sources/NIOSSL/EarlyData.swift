@@ -0,0 +1,43 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+/// User events fired by `NIOSSLHandler` on connections that attempt TLS 1.3 early data ("0-RTT").
+///
+/// Early data is only attempted when `TLSConfiguration.enableEarlyData` is set on both peers, and the client
+/// is resuming a session that the server issued with early data enabled.
+///
+/// - warning: Early data can be replayed by an attacker. Servers must only act on data received before
+///     `.replaySafe` if doing so more than once is harmless.
+public enum NIOSSLEarlyDataEvent: Equatable {
+    /// Early data was accepted.
+    ///
+    /// On clients, this fires once the handshake completes, after `TLSUserEvent.handshakeCompleted`. All writes
+    /// flushed before the handshake completed were sent as early data.
+    ///
+    /// On servers, this fires after `TLSUserEvent.handshakeCompleted`, before any early data is read. All data read
+    /// until `.replaySafe` fires may have been sent as early data.
+    case accepted
+
+    /// Early data offered by the client was rejected.
+    ///
+    /// On clients, this fires once the handshake completes, and the writes that were sent as early data are
+    /// automatically resent. On servers, the rejected early data is discarded.
+    case rejected
+
+    /// Servers only: the client has completed the handshake, and all data read from this point on is replay safe.
+    ///
+    /// Data read between `.accepted` and this event must be treated as replayable, even though some of it may
+    /// have been sent after the handshake.
+    case replaySafe
+}
@@ -0,0 +1,182 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+@_implementationOnly import CNIOBoringSSL
+
+/// The information a server needs to send to another process so that it can compute handshake hints for
+/// a connection.
+///
+/// Handshake hints let a server split the expensive parts of the TLS 1.3 handshake, the key share and the
+/// signature, out to a separate worker that holds the private key. The front end keeps the connection, sends
+/// this request to the worker, and applies the hints it returns. The worker computes the hints with
+/// `NIOSSLContext.makeHandshakeHints(for:)`. See `TLSConfiguration.handshakeHintsCallback`.
+public struct NIOSSLHandshakeHintsRequest: Hashable {
+    /// The client's ClientHello message, without the handshake message header.
+    public var clientHello: [UInt8]
+
+    /// An opaque description of the front end's capabilities, used to reduce the impact of version skew.
+    public var capabilities: [UInt8]
+
+    public init(clientHello: [UInt8], capabilities: [UInt8]) {
+        self.clientHello = clientHello
+        self.capabilities = capabilities
+    }
+}
+
+/// A callback that server-side contexts call when they receive a ClientHello, to obtain handshake hints from
+/// a worker. The handshake is suspended until the returned future completes.
+///
+/// Complete the future with the bytes returned by the worker's `NIOSSLContext.makeHandshakeHints(for:)`, or with
+/// `nil` to carry on without hints. Failing the future fails the handshake.
+///
+/// Hints contain connection secrets, so they must only be obtained from a trusted worker, over a trusted transport.
+///
+/// This callback is always invoked on `channel.eventLoop`.
+public typealias NIOSSLHandshakeHintsCallback = (_ request: NIOSSLHandshakeHintsRequest, _ channel: Channel) -> EventLoopFuture<[UInt8]?>
+
+/// The progress of a connection's call to the `NIOSSLHandshakeHintsCallback`.
+internal enum HandshakeHintsState {
+    case notStarted
+    case pending
+    case complete(Result<[UInt8]?, Error>)
+}
+
+extension NIOSSLContext {
+    /// Computes handshake hints for the connection described by `request`, which a front-end server sent from its
+    /// `NIOSSLHandshakeHintsCallback`.
+    ///
+    /// This context should be configured like the front end's, with the same certificate and an in-memory private
+    /// key. Configuration mismatches are not fatal, but may prevent the front end from using the hints. This method
+    /// performs the key share and signature for the handshake, and is safe to call from any thread.
+    ///
+    /// Hints are only produced for TLS 1.3 handshakes. For other handshakes the hints are empty, and the front end
+    /// uses its own private key as normal.
+    ///
+    /// - parameters:
+    ///     - request: The request from the front end.
+    /// - returns: The hints, to be passed back to the front end.
+    /// - throws: `NIOSSLExtraError.failedToGenerateHandshakeHints` if the ClientHello could not be processed.
+    public func makeHandshakeHints(for request: NIOSSLHandshakeHintsRequest) throws -> [UInt8] {
+        guard let ssl = CNIOBoringSSL_SSL_new(self.sslContext) else {
+            fatalError("Failed to create new BoringSSL connection")
+        }
+
+        // The connection owns the SSL, and lets our callbacks find this context.
+        let connection = SSLConnection(ownedSSL: ssl, parentContext: self)
+        connection.setAcceptState()
+
+        return try withExtendedLifetime(connection) {
+            CNIOBoringSSL_ERR_clear_error()
+            let rc = request.clientHello.withUnsafeBufferPointer { clientHello in
+                request.capabilities.withUnsafeBufferPointer { capabilities in
+                    CNIOBoringSSL_SSL_request_handshake_hints(ssl, clientHello.baseAddress, clientHello.count,
+                                                              capabilities.baseAddress, capabilities.count)
+                }
+            }
+            guard rc == 1 else {
+                throw NIOSSLExtraError.failedToGenerateHandshakeHints
+            }
+
+            // With hints requested, the handshake performs no I/O and stops once the hints are computed.
+            let handshakeResult = CNIOBoringSSL_SSL_do_handshake(ssl)
+            guard CNIOBoringSSL_SSL_get_error(ssl, handshakeResult) == SSL_ERROR_HANDSHAKE_HINTS_READY else {
+                throw NIOSSLExtraError.failedToGenerateHandshakeHints
+            }
+
+            guard let hints = serializeWithCBB({ CNIOBoringSSL_SSL_serialize_handshake_hints(ssl, $0) }) else {
+                throw NIOSSLExtraError.failedToGenerateHandshakeHints
+            }
+            return hints
+        }
+    }
+
+    /// Installs the callback that asks for handshake hints when a ClientHello arrives.
+    internal static func configureHandshakeHints(context: OpaquePointer) {
+        CNIOBoringSSL_SSL_CTX_set_select_certificate_cb(context) { clientHello in
+            guard let clientHello = clientHello, let ssl = clientHello.pointee.ssl else {
+                return ssl_select_cert_error
+            }
+
+            let connection = SSLConnection.loadConnectionFromSSL(ssl)
+            guard connection.parentHandler != nil else {
+                // This is a worker computing hints of its own, which has nowhere to send the request.
+                return ssl_select_cert_success
+            }
+
+            switch connection.handshakeHintsState {
+            case .notStarted:
+                guard let capabilities = serializeWithCBB({ CNIOBoringSSL_SSL_serialize_capabilities(ssl, $0) }) else {
+                    return ssl_select_cert_error
+                }
+                let request = NIOSSLHandshakeHintsRequest(
+                    clientHello: Array(UnsafeBufferPointer(start: clientHello.pointee.client_hello,
+                                                           count: clientHello.pointee.client_hello_len)),
+                    capabilities: capabilities
+                )
+                connection.requestHandshakeHints(request)
+                return ssl_select_cert_retry
+            case .pending:
+                return ssl_select_cert_retry
+            case .complete(.failure):
+                return ssl_select_cert_error
+            case .complete(.success(.none)):
+                return ssl_select_cert_success
+            case .complete(.success(.some(let hints))) where hints.isEmpty:
+                // Hints are empty for handshakes the worker couldn't predict, such as TLS 1.2.
+                return ssl_select_cert_success
+            case .complete(.success(.some(let hints))):
+                let rc = hints.withUnsafeBufferPointer {
+                    CNIOBoringSSL_SSL_set_handshake_hints(ssl, $0.baseAddress, $0.count)
+                }
+                return rc == 1 ? ssl_select_cert_success : ssl_select_cert_error
+            }
+        }
+    }
+}
+
+extension SSLConnection {
+    fileprivate func requestHandshakeHints(_ request: NIOSSLHandshakeHintsRequest) {
+        // This force-unwrap is safe: the callback is only installed when there is a hints callback.
+        let callback = self.parentContext.configuration.handshakeHintsCallback!
+        // This force-unwrap pair is safe: we can only handshake while we're in a pipeline.
+        let channel = self.parentHandler!.channel!
+        self.handshakeHintsState = .pending
+
+        callback(request, channel).whenComplete { result in
+            // Always defer the resumption, as we may still be inside the handshake if the future was already
+            // complete. If we can't respin the handshake because we've dropped the parent handler, that's fine.
+            channel.eventLoop.execute {
+                self.handshakeHintsState = .complete(result)
+                self.parentHandler?.resumeHandshake()
+            }
+        }
+    }
+}
+
+/// Calls `body` with an empty `CBB`, and returns the bytes it wrote, or `nil` if it failed.
+internal func serializeWithCBB(_ body: (UnsafeMutablePointer<CBB>) -> CInt) -> [UInt8]? {
+    var cbb = CBB()
+    guard CNIOBoringSSL_CBB_init(&cbb, 0) == 1 else {
+        return nil
+    }
+    defer {
+        CNIOBoringSSL_CBB_cleanup(&cbb)
+    }
+
+    guard body(&cbb) == 1, CNIOBoringSSL_CBB_flush(&cbb) == 1 else {
+        return nil
+    }
+    return Array(UnsafeBufferPointer(start: CNIOBoringSSL_CBB_data(&cbb), count: CNIOBoringSSL_CBB_len(&cbb)))
+}
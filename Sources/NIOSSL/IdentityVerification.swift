@@ -13,6 +13,8 @@
 //===----------------------------------------------------------------------===//
 
 import NIOCore
+@_implementationOnly import CNIOBoringSSL
+@_implementationOnly import CNIOBoringSSLShims
 
 #if os(macOS) || os(iOS) || os(watchOS) || os(tvOS)
 import Darwin.C
@@ -23,7 +25,7 @@ import Glibc
 #endif
 
 
-private let asciiIDNAIdentifier: ArraySlice<UInt8> = Array("xn--".utf8)[...]
+private let asciiIDNAIdentifier: [UInt8] = Array("xn--".utf8)
 private let asciiCapitals: ClosedRange<UInt8> = (UInt8(ascii: "A")...UInt8(ascii: "Z"))
 private let asciiLowercase: ClosedRange<UInt8> = (UInt8(ascii: "a")...UInt8(ascii: "z"))
 private let asciiNumbers: ClosedRange<UInt8> = (UInt8(ascii: "0")...UInt8(ascii: "9"))
@@ -32,44 +34,6 @@ private let asciiPeriod: UInt8 = UInt8(ascii: ".")
 private let asciiAsterisk: UInt8 = UInt8(ascii: "*")
 
 
-extension String {
-    /// Calls `fn` with an `Array<UInt8>` pointing to a
-    /// non-NULL-terminated sequence of ASCII bytes. If the string this method
-    /// is called on contains non-ACSII code points, this method throws.
-    ///
-    /// This method exists to avoid doing repeated loops over the string buffer.
-    /// In a naive implementation we'd loop at least three times: once to lowercase
-    /// the string, once to get a buffer pointer to a contiguous buffer, and once
-    /// to confirm the string is ASCII. Here we can do that all in one loop.
-    fileprivate func withLowercaseASCIIBuffer<T>(_ fn: (Array<UInt8>) throws -> T) throws -> T {
-        let buffer: [UInt8] = try self.utf8.map { codeUnit in
-            guard codeUnit.isValidDNSCharacter else {
-                throw NIOSSLExtraError.serverHostnameImpossibleToMatch(hostname: self)
-            }
-
-            // We know we have only ASCII printables, we can safely unconditionally set the 6 bit to 1 to lowercase.
-            return codeUnit | (0x20)
-        }
-
-        return try fn(buffer)
-    }
-}
-
-
-extension Collection {
-    /// Splits a collection in two around a given index. This index may be nil, in which case the split
-    /// will occur around the end.
-    fileprivate func splitAroundIndex(_ index: Index?) -> (SubSequence, SubSequence) {
-        guard let index = index else {
-            return (self[...], self[self.endIndex...])
-        }
-
-        let subsequentIndex = self.index(after: index)
-        return (self[..<index], self[subsequentIndex...])
-    }
-}
-
-
 extension UInt8 {
     /// Whether this character is a valid DNS character, which is the ASCII
     /// letters, digits, the hypen, and the period.
@@ -96,145 +60,114 @@ extension UInt8 {
 internal func validIdentityForService(serverHostname: String?,
                                       socketAddress: SocketAddress,
                                       leafCertificate: NIOSSLCertificate) throws -> Bool {
-    if let serverHostname = serverHostname {
-        return try serverHostname.withLowercaseASCIIBuffer {
-            try validIdentityForService(serverHostname: $0,
-                                        socketAddress: socketAddress,
-                                        leafCertificate: leafCertificate)
-        }
-    } else {
-        return try validIdentityForService(serverHostname: nil as Array<UInt8>?,
-                                           socketAddress: socketAddress,
-                                           leafCertificate: leafCertificate)
-    }
+    return try CertificateIdentity(leafCertificate: leafCertificate).matches(serverHostname: serverHostname,
+                                                                            socketAddress: socketAddress)
 }
 
-private func validIdentityForService(serverHostname: Array<UInt8>?,
-                                     socketAddress: SocketAddress,
-                                     leafCertificate: NIOSSLCertificate) throws -> Bool {
-    // Before we begin, we want to locate the first period in our own domain name. We need to do
-    // this because we may need to match a wildcard label.
-    var serverHostnameSlice: ArraySlice<UInt8>? = nil
-    var firstPeriodIndex: ArraySlice<UInt8>.Index? = nil
-
-    if let serverHostname = serverHostname {
-        var tempServerHostnameSlice = serverHostname[...]
 
+/// The names and addresses a leaf certificate is valid for, analysed once so that they can be matched
+/// against any number of services without allocating.
+///
+/// A certificate name that is valid for matching meets the following criteria:
+///
+/// 1. Contains only valid DNS characters, plus the ASCII asterisk.
+/// 2. Contains zero or one ASCII asterisks.
+/// 3. Any ASCII asterisk present must be in the first DNS label (i.e. before the first period).
+/// 4. If the first label contains an ASCII asterisk, it must not also be an IDN A label.
+///
+/// Names that don't meet these criteria can never match, so they are dropped here. The others are stored
+/// in a single buffer, and indexed by two tables: one of names that must match exactly, and one of wildcard
+/// names, already split into the pieces the wildcard matching algorithm compares.
+internal struct CertificateIdentity {
+    private struct WildcardName {
+        /// The characters of the first label before the asterisk.
+        var labelPrefix: Range<Int>
+
+        /// The characters of the first label after the asterisk.
+        var labelSuffix: Range<Int>
+
+        /// The labels after the first, without the period separating them from it.
+        var remainingComponents: Range<Int>
+    }
 
-        // Strip trailing period
-        if tempServerHostnameSlice.last == .some(asciiPeriod) {
-            tempServerHostnameSlice = tempServerHostnameSlice.dropLast()
+    private var nameBytes: [UInt8] = []
+    private var exactNames: [Range<Int>] = []
+    private var wildcardNames: [WildcardName] = []
+    private var ipv4Addresses: [in_addr] = []
+    private var ipv6Addresses: [in6_addr] = []
+
+    init(leafCertificate: NIOSSLCertificate) {
+        // We want to begin by collecting the subjectAlternativeName fields. If there are any fields
+        // in there that we could validate against (either IP or hostname) we will validate against
+        // them, and then refuse to check the commonName field.
+        var hasAlternativeNames = false
+        let sanExtension = leafCertificate.withUnsafeMutableX509Pointer {
+            CNIOBoringSSL_X509_get_ext_d2i($0, NID_subject_alt_name, nil, nil)
         }
+        if let sanExtension = sanExtension {
+            let nameStack = OpaquePointer(sanExtension)
+            defer {
+                CNIOBoringSSL_GENERAL_NAMES_free(nameStack)
+            }
 
-        firstPeriodIndex = tempServerHostnameSlice.firstIndex(of: asciiPeriod)
-        serverHostnameSlice = tempServerHostnameSlice
-    }
-
-    // We want to begin by checking the subjectAlternativeName fields. If there are any fields
-    // in there that we could validate against (either IP or hostname) we will validate against
-    // them, and then refuse to check the commonName field. If there are no SAN fields to
-    // validate against, we'll check commonName.
-    var checkedMatch = false
-    if let alternativeNames = leafCertificate.subjectAlternativeNames() {
-        for name in alternativeNames {
-            checkedMatch = true
-
-            switch name {
-            case .dnsName(let dnsName):
-                if matchHostname(ourHostname: serverHostnameSlice, firstPeriodIndex: firstPeriodIndex, dnsName: dnsName) {
-                    return true
+            for index in 0..<CNIOBoringSSLShims_sk_GENERAL_NAME_num(nameStack) {
+                guard let name = CNIOBoringSSLShims_sk_GENERAL_NAME_value(nameStack, index) else {
+                    fatalError("Unexpected null pointer when unwrapping SAN value")
                 }
-            case .ipAddress(let ip):
-                if matchIpAddress(socketAddress: socketAddress, certificateIP: ip) {
-                    return true
+                switch name.pointee.type {
+                case GEN_DNS:
+                    hasAlternativeNames = true
+                    self.appendName(UnsafeBufferPointer(start: CNIOBoringSSL_ASN1_STRING_get0_data(name.pointee.d.ia5),
+                                                        count: Int(CNIOBoringSSL_ASN1_STRING_length(name.pointee.d.ia5))))
+                case GEN_IPADD:
+                    let bytes = UnsafeRawBufferPointer(start: CNIOBoringSSL_ASN1_STRING_get0_data(name.pointee.d.iPAddress),
+                                                       count: Int(CNIOBoringSSL_ASN1_STRING_length(name.pointee.d.iPAddress)))
+                    switch bytes.count {
+                    case MemoryLayout<in_addr>.size:
+                        hasAlternativeNames = true
+                        var address = in_addr()
+                        withUnsafeMutableBytes(of: &address) { $0.copyMemory(from: bytes) }
+                        self.ipv4Addresses.append(address)
+                    case MemoryLayout<in6_addr>.size:
+                        hasAlternativeNames = true
+                        var address = in6_addr()
+                        withUnsafeMutableBytes(of: &address) { $0.copyMemory(from: bytes) }
+                        self.ipv6Addresses.append(address)
+                    default:
+                        // The address is malformed. Skip it.
+                        break
+                    }
+                default:
+                    // We don't recognise this name type. Skip it. The union holds something other than a
+                    // string for these, so we mustn't look at it.
+                    break
                 }
             }
         }
-    }
-
-    guard !checkedMatch else {
-        // We had some subject alternative names, but none matched. We failed here.
-        return false
-    }
-
-    // In the absence of any matchable subjectAlternativeNames, we can fall back to checking
-    // the common name. This is a deprecated practice, and in a future release we should
-    // stop doing this.
-    guard let commonName = leafCertificate.commonName() else {
-        // No CN, no match.
-        return false
-    }
-
-    // We have a common name. Let's check it against the provided hostname. We never check
-    // the common name against the IP address.
-    return matchHostname(ourHostname: serverHostnameSlice, firstPeriodIndex: firstPeriodIndex, dnsName: commonName)
-}
-
 
-private func matchHostname(ourHostname: ArraySlice<UInt8>?, firstPeriodIndex: ArraySlice<UInt8>.Index?, dnsName: Array<UInt8>) -> Bool {
-    guard let ourHostname = ourHostname else {
-        // No server hostname was provided, so we cannot match.
-        return false
-    }
-
-    // Now we validate the cert hostname.
-    var dnsName = ArraySlice(dnsName)
-    guard let validatedHostname = AnalysedCertificateHostname(baseName: &dnsName) else {
-        // This is a hostname we can't match, return false.
-        return false
-    }
-    return validatedHostname.validMatchForName(ourHostname, firstPeriodIndexForName: firstPeriodIndex)
-}
-
-
-private func matchIpAddress(socketAddress: SocketAddress, certificateIP: NIOSSLCertificate.IPAddress) -> Bool {
-    // These match if the two underlying IP address structures match.
-    switch (socketAddress, certificateIP) {
-    case (.v4(let address), .ipv4(var addr2)):
-        var addr1 = address.address.sin_addr
-        return memcmp(&addr1, &addr2, MemoryLayout<in_addr>.size) == 0
-    case (.v6(let address), .ipv6(var addr2)):
-        var addr1 = address.address.sin6_addr
-        return memcmp(&addr1, &addr2, MemoryLayout<in6_addr>.size) == 0
-    default:
-        // Different protocol families, no match.
-        return false
+        // In the absence of any matchable subjectAlternativeNames, we can fall back to checking
+        // the common name. This is a deprecated practice, and in a future release we should
+        // stop doing this. We never check the common name against the IP address.
+        if !hasAlternativeNames, let commonName = leafCertificate.commonName() {
+            commonName.withUnsafeBufferPointer { self.appendName($0) }
+        }
     }
-}
 
+    /// Analyses a name from the certificate and, if it could ever match, adds it to the tables.
+    private mutating func appendName(_ name: UnsafeBufferPointer<UInt8>) {
+        var length = name.count
 
-/// This structure contains a certificate hostname that has been analysed and prepared for matching.
-///
-/// A certificate hostname that is valid for matching meets the following criteria:
-///
-/// 1. Contains only valid DNS characters, plus the ASCII asterisk.
-/// 2. Contains zero or one ASCII asterisks.
-/// 3. Any ASCII asterisk present must be in the first DNS label (i.e. before the first period).
-/// 4. If the first label contains an ASCII asterisk, it must not also be an IDN A label.
-///
-/// Answering these questions potentially relies on multiple searches through the hostname. That's not
-/// ideal: it'd be better to do a single search that both validates the domain name meets the criteria
-/// and that also records information needed to validate that the name matches the one we're searching for.
-/// That's what this structure does.
-fileprivate struct AnalysedCertificateHostname {
-    /// The type we use to store the base name. The other types on this object are chosen relative to that.
-    fileprivate typealias BaseNameType = ArraySlice<UInt8>
-
-    private var name: NameType
-
-    fileprivate init?(baseName: inout BaseNameType) {
         // First, strip a trailing period from this name.
-        if baseName.last == .some(asciiPeriod) {
-            baseName = baseName.dropLast()
+        if length > 0 && name[length - 1] == asciiPeriod {
+            length -= 1
         }
 
         // Ok, start looping.
-        var index = baseName.startIndex
-        var firstPeriodIndex: Optional<BaseNameType.Index> = nil
-        var asteriskIndex: Optional<BaseNameType.Index> = nil
+        var firstPeriodIndex: Int? = nil
+        var asteriskIndex: Int? = nil
 
-        while index < baseName.endIndex {
-            switch baseName[index] {
+        for index in 0..<length {
+            switch name[index] {
             case asciiPeriod where firstPeriodIndex == nil:
                 // This is the first period we've seen, great. Future
                 // periods will be ignored.
@@ -250,73 +183,155 @@ fileprivate struct AnalysedCertificateHostname {
 
             case asciiAsterisk:
                 // An extra asterisk, or an asterisk after a period, is unacceptable.
-                return nil
+                return
 
             default:
                 // Unacceptable character in the name.
-                return nil
+                return
             }
-
-            baseName.formIndex(after: &index)
         }
 
-        // Now we can finally initialize ourself.
-        if let asteriskIndex = asteriskIndex {
+        let name = UnsafeBufferPointer(rebasing: name[..<length])
+        if asteriskIndex != nil {
             // One final check: if we found a wildcard, we need to confirm that the first label isn't an IDNA A label.
-            guard baseName.prefix(4) != asciiIDNAIdentifier else {
-                return nil
+            guard !name.starts(with: asciiIDNAIdentifier) else {
+                return
+            }
+        }
+
+        let base = self.nameBytes.count
+        self.nameBytes.append(contentsOf: name)
+
+        guard let asteriskIndex = asteriskIndex else {
+            self.exactNames.append(base..<(base + length))
+            return
+        }
+
+        let firstLabelEnd = firstPeriodIndex ?? length
+        let remainingStart = firstPeriodIndex.map { $0 + 1 } ?? length
+        self.wildcardNames.append(WildcardName(labelPrefix: base..<(base + asteriskIndex),
+                                               labelSuffix: (base + asteriskIndex + 1)..<(base + firstLabelEnd),
+                                               remainingComponents: (base + remainingStart)..<(base + length)))
+    }
+
+    /// Whether the certificate is valid for a service with the given hostname and address.
+    ///
+    /// - throws: If `serverHostname` contains characters that are not valid in a DNS name.
+    func matches(serverHostname: String?, socketAddress: SocketAddress) throws -> Bool {
+        guard let serverHostname = serverHostname else {
+            // No server hostname was provided, so we can only match the address.
+            return self.matchesIPAddress(socketAddress)
+        }
+
+        var hostnameStorage = serverHostname
+        return try hostnameStorage.withUTF8 { hostname in
+            // Before we begin, we want to validate the hostname and locate its first period. We need the
+            // period because we may need to match a wildcard label.
+            var length = hostname.count
+            var firstPeriodIndex: Int? = nil
+            for (index, codeUnit) in hostname.enumerated() {
+                guard codeUnit.isValidDNSCharacter else {
+                    throw NIOSSLExtraError.serverHostnameImpossibleToMatch(hostname: serverHostname)
+                }
+                if codeUnit == asciiPeriod && firstPeriodIndex == nil {
+                    firstPeriodIndex = index
+                }
+            }
+
+            // Strip trailing period
+            if length > 0 && hostname[length - 1] == asciiPeriod {
+                length -= 1
+                if firstPeriodIndex == length {
+                    firstPeriodIndex = nil
+                }
             }
 
-            self.name = .wildcard(baseName, asteriskIndex: asteriskIndex, firstPeriodIndex: firstPeriodIndex)
-        } else {
-            self.name = .singleName(baseName)
+            return self.matchesHostname(UnsafeBufferPointer(rebasing: hostname[..<length]), firstPeriodIndex: firstPeriodIndex) ||
+                self.matchesIPAddress(socketAddress)
         }
     }
 
-    /// Whether this parsed name is a valid match for the one passed in.
-    fileprivate func validMatchForName(_ target: BaseNameType, firstPeriodIndexForName: BaseNameType.Index?) -> Bool {
-        switch self.name {
-        case .singleName(let baseName):
-            // For non-wildcard names, we just do a straightforward string comparison.
-            return baseName == target
-
-        case .wildcard(let baseName, asteriskIndex: let asteriskIndex, firstPeriodIndex: let firstPeriodIndex):
-            // The wildcard can appear more-or-less anywhere in the first label. The wildcard
-            // character itself can match any number of characters, though it must match at least
-            // one.
-            // The algorithm for this is simple: first, we split the two names on their first period to get their
-            // first label and their subsequent components. Second, we check that the subcomponents match a straightforward
-            // bytewise comparison: if that fails, we can avoid the expensive wildcard checking operation.
-            // Third, we split the wildcard label on the wildcard character, and and confirm that
-            // the characters *before* the wildcard are the prefix of the target first label, and that the
-            // characters *after* the wildcard are the suffix of the target first label. This works well because
-            // the empty string is a prefix and suffix of all strings.
-            let (wildcardLabel, remainingComponents) = baseName.splitAroundIndex(firstPeriodIndex)
-            let (targetFirstLabel, targetRemainingComponents) = target.splitAroundIndex(firstPeriodIndexForName)
-
-            guard remainingComponents == targetRemainingComponents else {
+    private func matchesHostname(_ target: UnsafeBufferPointer<UInt8>, firstPeriodIndex: Int?) -> Bool {
+        // For non-wildcard names, we just do a straightforward string comparison.
+        for name in self.exactNames {
+            if self.nameBytes[name].matchesLowercased(target) {
+                return true
+            }
+        }
+
+        guard !self.wildcardNames.isEmpty else {
+            return false
+        }
+
+        // The wildcard can appear more-or-less anywhere in the first label. The wildcard
+        // character itself can match any number of characters, though it must match at least
+        // one.
+        // The algorithm for this is simple: first, we split the target on its first period to get its
+        // first label and its subsequent components. Second, we check that the subcomponents match a straightforward
+        // bytewise comparison: if that fails, we can avoid the expensive wildcard checking operation.
+        // Third, we confirm that the characters *before* the wildcard are the prefix of the target first label,
+        // and that the characters *after* the wildcard are the suffix of the target first label. This works well
+        // because the empty string is a prefix and suffix of all strings.
+        let targetFirstLabel = UnsafeBufferPointer(rebasing: target[..<(firstPeriodIndex ?? target.count)])
+        let targetRemainingComponents = UnsafeBufferPointer(rebasing: target[(firstPeriodIndex.map { $0 + 1 } ?? target.count)...])
+
+        for name in self.wildcardNames {
+            guard self.nameBytes[name.remainingComponents].matchesLowercased(targetRemainingComponents) else {
                 // Wildcard is irrelevant, the remaining components don't match.
-                return false
+                continue
             }
 
-            guard targetFirstLabel.count >= wildcardLabel.count else {
+            guard targetFirstLabel.count > name.labelPrefix.count + name.labelSuffix.count else {
                 // The target label cannot possibly match the wildcard.
-                return false
+                continue
             }
 
-            let (wildcardLabelPrefix, wildcardLabelSuffix) = wildcardLabel.splitAroundIndex(asteriskIndex)
+            let targetPrefix = UnsafeBufferPointer(rebasing: targetFirstLabel.prefix(name.labelPrefix.count))
+            let targetSuffix = UnsafeBufferPointer(rebasing: targetFirstLabel.suffix(name.labelSuffix.count))
+            if self.nameBytes[name.labelPrefix].matchesLowercased(targetPrefix) &&
+                self.nameBytes[name.labelSuffix].matchesLowercased(targetSuffix) {
+                return true
+            }
+        }
+
+        return false
+    }
 
-            return (targetFirstLabel.prefix(wildcardLabelPrefix.count) == wildcardLabelPrefix &&
-                    targetFirstLabel.suffix(wildcardLabelSuffix.count) == wildcardLabelSuffix)
+    private func matchesIPAddress(_ socketAddress: SocketAddress) -> Bool {
+        // These match if the two underlying IP address structures match.
+        switch socketAddress {
+        case .v4(let address):
+            var addr1 = address.address.sin_addr
+            for var addr2 in self.ipv4Addresses {
+                if memcmp(&addr1, &addr2, MemoryLayout<in_addr>.size) == 0 {
+                    return true
+                }
+            }
+            return false
+        case .v6(let address):
+            var addr1 = address.address.sin6_addr
+            for var addr2 in self.ipv6Addresses {
+                if memcmp(&addr1, &addr2, MemoryLayout<in6_addr>.size) == 0 {
+                    return true
+                }
+            }
+            return false
+        default:
+            // Different protocol families, no match.
+            return false
         }
     }
 }
 
 
-extension AnalysedCertificateHostname {
-    private enum NameType {
-        case wildcard(BaseNameType, asteriskIndex: BaseNameType.Index, firstPeriodIndex: Optional<BaseNameType.Index>)
-        case singleName(BaseNameType)
+extension ArraySlice where Element == UInt8 {
+    /// Whether these certificate name bytes equal `target`, a validated hostname, once it is lowercased.
+    fileprivate func matchesLowercased(_ target: UnsafeBufferPointer<UInt8>) -> Bool {
+        guard self.count == target.count else {
+            return false
+        }
+
+        // We know the target has only ASCII printables, we can safely unconditionally set the 6 bit to 1 to lowercase.
+        return zip(self, target).allSatisfy { $0 == $1 | 0x20 }
     }
 }
-
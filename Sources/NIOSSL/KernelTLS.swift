@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+@_implementationOnly import CNIOBoringSSLShims
+
+/// The socket options used to configure Linux kernel TLS. These are spelled out here, rather than
+/// taken from the system headers, as not every C library exposes them.
+private enum KernelTLSSocketOption {
+    /// `IPPROTO_TCP`
+    static let tcpLevel = NIOBSDSocket.OptionLevel(rawValue: 6)
+    /// `TCP_ULP`
+    static let upperLayerProtocol = NIOBSDSocket.Option(rawValue: 31)
+    /// `SOL_TLS`
+    static let tlsLevel = NIOBSDSocket.OptionLevel(rawValue: 282)
+    /// `TLS_TX`
+    static let transmit = NIOBSDSocket.Option(rawValue: 1)
+    /// `TLS_RX`
+    static let receive = NIOBSDSocket.Option(rawValue: 2)
+}
+
+/// The direction of a connection that kernel TLS protects.
+internal enum KernelTLSDirection {
+    case transmit
+    case receive
+}
+
+extension SocketOptionProvider {
+    /// Attaches the kernel TLS upper layer protocol to this socket. Until keys are installed
+    /// with `setKernelTLSCryptoInfo`, the socket behaves as before.
+    internal func attachKernelTLS() -> EventLoopFuture<Void> {
+        // The protocol name, "tls", as a NUL-terminated C string.
+        let name: (UInt8, UInt8, UInt8, UInt8) = (UInt8(ascii: "t"), UInt8(ascii: "l"), UInt8(ascii: "s"), 0)
+        return self.unsafeSetSocketOption(level: KernelTLSSocketOption.tcpLevel,
+                                          name: KernelTLSSocketOption.upperLayerProtocol,
+                                          value: name)
+    }
+
+    /// Installs the key material and sequence number for one direction of the connection, after which the
+    /// kernel encrypts or decrypts all data in that direction.
+    internal func setKernelTLSCryptoInfo(_ info: CNIOBoringSSLShims_kernel_tls_crypto_info,
+                                         direction: KernelTLSDirection) -> EventLoopFuture<Void> {
+        let name: NIOBSDSocket.Option
+        switch direction {
+        case .transmit:
+            name = KernelTLSSocketOption.transmit
+        case .receive:
+            name = KernelTLSSocketOption.receive
+        }
+
+        // The kernel requires the option to be exactly the size of the structure for the cipher.
+        switch Int32(info.info.cipher_type) {
+        case CNIOBoringSSLShims_TLS_CIPHER_AES_GCM_128:
+            return self.unsafeSetSocketOption(level: KernelTLSSocketOption.tlsLevel, name: name, value: info.aes_gcm_128)
+        case CNIOBoringSSLShims_TLS_CIPHER_AES_GCM_256:
+            return self.unsafeSetSocketOption(level: KernelTLSSocketOption.tlsLevel, name: name, value: info.aes_gcm_256)
+        case CNIOBoringSSLShims_TLS_CIPHER_CHACHA20_POLY1305:
+            return self.unsafeSetSocketOption(level: KernelTLSSocketOption.tlsLevel, name: name, value: info.chacha20_poly1305)
+        default:
+            return self.eventLoop.makeFailedFuture(ChannelError.operationUnsupported)
+        }
+    }
+}
@@ -0,0 +1,102 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+@_implementationOnly import CNIOBoringSSL
+
+/// A group that may be used for the (EC)DHE key exchange.
+///
+/// TLS 1.2 calls these curves.
+public struct NIOSSLKeyExchangeGroup: Hashable {
+    /// The BoringSSL NID of the group.
+    internal var nid: CInt
+
+    /// The group's IANA-assigned code point.
+    internal var groupID: UInt16
+
+    private init(nid: CInt, groupID: CInt) {
+        self.nid = nid
+        self.groupID = UInt16(groupID)
+    }
+
+    /// X25519, as described in RFC 7748.
+    public static let x25519 = NIOSSLKeyExchangeGroup(nid: NID_X25519, groupID: SSL_CURVE_X25519)
+
+    /// The NIST P-256 curve.
+    public static let secp256r1 = NIOSSLKeyExchangeGroup(nid: NID_X9_62_prime256v1, groupID: SSL_CURVE_SECP256R1)
+
+    /// The NIST P-384 curve.
+    public static let secp384r1 = NIOSSLKeyExchangeGroup(nid: NID_secp384r1, groupID: SSL_CURVE_SECP384R1)
+
+    /// The NIST P-521 curve.
+    public static let secp521r1 = NIOSSLKeyExchangeGroup(nid: NID_secp521r1, groupID: SSL_CURVE_SECP521R1)
+}
+
+/// A snapshot of the key exchange counters of a `NIOSSLContext`.
+public struct NIOSSLKeyExchangeStatistics: Hashable {
+    /// The number of completed handshakes.
+    public var handshakes: Int
+
+    /// The number of completed handshakes in which the server sent a HelloRetryRequest, because the client's
+    /// predicted key share was not for a group the server would use.
+    public var helloRetryRequests: Int
+
+    public init(handshakes: Int, helloRetryRequests: Int) {
+        self.handshakes = handshakes
+        self.helloRetryRequests = helloRetryRequests
+    }
+}
+
+extension NIOSSLContext {
+    /// Sets the key exchange groups of a `SSL_CTX`.
+    ///
+    /// BoringSSL clients send a key share for the first group in their list, so the predicted key share is moved
+    /// to the front. BoringSSL servers follow the client's order, which then also favours the predicted group.
+    internal static func configureKeyExchangeGroups(_ groups: [NIOSSLKeyExchangeGroup]?,
+                                                    predictedKeyShare: NIOSSLKeyExchangeGroup?,
+                                                    context: OpaquePointer) throws {
+        // These are BoringSSL's defaults.
+        var groups = groups ?? [.x25519, .secp256r1, .secp384r1]
+        if let predictedKeyShare = predictedKeyShare {
+            guard let index = groups.firstIndex(of: predictedKeyShare) else {
+                throw NIOSSLExtraError.invalidPredictedKeyShare(groupID: predictedKeyShare.groupID)
+            }
+            groups.remove(at: index)
+            groups.insert(predictedKeyShare, at: 0)
+        }
+
+        let returnCode = groups.map { $0.nid }.withUnsafeBufferPointer { nids in
+            CNIOBoringSSL_SSL_CTX_set1_curves(context, nids.baseAddress, nids.count)
+        }
+        if returnCode != 1 {
+            let errorStack = BoringSSLError.buildErrorStack()
+            throw BoringSSLError.unknownError(errorStack)
+        }
+    }
+
+    /// The current key exchange counters for this context.
+    ///
+    /// These are counted for every connection created from this context that completes a handshake.
+    public var keyExchangeStatistics: NIOSSLKeyExchangeStatistics {
+        return NIOSSLKeyExchangeStatistics(handshakes: self.keyExchangeHandshakes.load(),
+                                           helloRetryRequests: self.keyExchangeHelloRetryRequests.load())
+    }
+
+    /// Records the outcome of a completed handshake in the key exchange counters.
+    internal func recordKeyExchange(usedHelloRetryRequest: Bool) {
+        self.keyExchangeHandshakes.add(1)
+        if usedHelloRetryRequest {
+            self.keyExchangeHelloRetryRequests.add(1)
+        }
+    }
+}
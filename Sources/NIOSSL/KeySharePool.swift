@@ -0,0 +1,241 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+import NIOConcurrencyHelpers
+import NIOPosix
+@_implementationOnly import CNIOBoringSSL
+
+/// A pool of ephemeral key pairs for key exchange, generated ahead of time on a `NIOThreadPool`.
+///
+/// Every handshake generates a fresh key pair, which for the NIST curves costs a scalar multiplication on the event
+/// loop. When many connections arrive at once, such as after a failover, that work delays every other handshake on
+/// the loop. A pool keeps a stock of key pairs for each event loop, hands each one out to exactly one handshake, and
+/// refills the stock on the thread pool once it runs low. Handshakes that find the stock empty generate their key
+/// pair as usual.
+///
+/// Private keys are cleansed from memory when they are handed to a handshake, and when the pool or the event loop
+/// they were held for goes away unused.
+///
+/// Set a pool as the `TLSConfiguration.keySharePool` of any number of contexts.
+public final class NIOSSLKeySharePool {
+    /// A precomputed key pair, in the form BoringSSL expects.
+    internal struct KeyPair {
+        var privateKey: [UInt8]
+        var publicKey: [UInt8]
+
+        /// Overwrites the private key, once it is no longer needed.
+        mutating func cleanse() {
+            self.privateKey.withUnsafeMutableBytes {
+                CNIOBoringSSL_OPENSSL_cleanse($0.baseAddress, $0.count)
+            }
+        }
+    }
+
+    /// The key pairs held for one event loop.
+    private final class Stock {
+        let lock = Lock()
+        var keyPairs: [NIOSSLKeyExchangeGroup: [KeyPair]] = [:]
+        var refillScheduled = false
+
+        deinit {
+            for group in self.keyPairs.keys {
+                for index in self.keyPairs[group]!.indices {
+                    self.keyPairs[group]![index].cleanse()
+                }
+            }
+        }
+    }
+
+    /// A stock, and the event loop it is held for. The event loop is held weakly, so that the stocks of event loops
+    /// that have gone away can be dropped.
+    private struct StockEntry {
+        weak var eventLoop: EventLoop?
+        var stock: Stock
+    }
+
+    private let groups: [NIOSSLKeyExchangeGroup]
+    private let keyPairsPerGroup: Int
+    private let threadPool: NIOThreadPool
+    private let lock = Lock()
+    private var stocks: [ObjectIdentifier: StockEntry] = [:]
+
+    /// Create a key share pool.
+    ///
+    /// - parameters:
+    ///     - groups: The groups to hold key pairs for. Handshakes using any other group generate their key pair as usual.
+    ///     - keyPairsPerGroup: The number of key pairs to hold for each group on each event loop. Refills start once
+    ///         fewer than half remain.
+    ///     - threadPool: The thread pool to generate key pairs on. It must be started, and kept running for as long as
+    ///         the pool is in use.
+    public init(groups: [NIOSSLKeyExchangeGroup] = [.x25519, .secp256r1],
+                keyPairsPerGroup: Int = 64,
+                threadPool: NIOThreadPool) {
+        precondition(keyPairsPerGroup > 0, "keyPairsPerGroup must be positive")
+        self.groups = groups
+        self.keyPairsPerGroup = keyPairsPerGroup
+        self.threadPool = threadPool
+    }
+
+    /// Fills the stock of key pairs for `eventLoop`, for example ahead of an expected rush of connections.
+    ///
+    /// - parameters:
+    ///     - eventLoop: The event loop whose connections will use the key pairs.
+    /// - returns: A future that succeeds once the stock is full.
+    public func prefill(eventLoop: EventLoop) -> EventLoopFuture<Void> {
+        let stock = self.stock(for: eventLoop)
+        return self.threadPool.runIfActive(eventLoop: eventLoop) {
+            self.fill(stock)
+        }
+    }
+
+    /// The number of key pairs currently held for `group` on `eventLoop`.
+    internal func availableKeyPairs(for group: NIOSSLKeyExchangeGroup, eventLoop: EventLoop) -> Int {
+        let stock = self.stock(for: eventLoop)
+        return stock.lock.withLock { stock.keyPairs[group]?.count ?? 0 }
+    }
+
+    /// The number of event loops the pool currently holds a stock for.
+    internal var stockCount: Int {
+        return self.lock.withLock { self.stocks.count }
+    }
+
+    /// Takes a key pair for `groupID` for a connection on `eventLoop`, scheduling a refill if the stock runs low.
+    internal func take(groupID: UInt16, eventLoop: EventLoop) -> KeyPair? {
+        guard let group = self.groups.first(where: { $0.groupID == groupID }) else {
+            return nil
+        }
+
+        let stock = self.stock(for: eventLoop)
+        let (keyPair, needsRefill): (KeyPair?, Bool) = stock.lock.withLock {
+            let keyPair = stock.keyPairs[group]?.popLast()
+            let remaining = stock.keyPairs[group]?.count ?? 0
+            guard remaining * 2 < self.keyPairsPerGroup, !stock.refillScheduled else {
+                return (keyPair, false)
+            }
+            stock.refillScheduled = true
+            return (keyPair, true)
+        }
+
+        if needsRefill {
+            self.threadPool.submit { state in
+                if case .active = state {
+                    self.fill(stock)
+                }
+                stock.lock.withLockVoid {
+                    stock.refillScheduled = false
+                }
+            }
+        }
+        return keyPair
+    }
+
+    private func stock(for eventLoop: EventLoop) -> Stock {
+        return self.lock.withLock {
+            // An entry whose event loop has gone away may share its identifier with a new event loop, so the event
+            // loop itself must match.
+            if let entry = self.stocks[ObjectIdentifier(eventLoop)], entry.eventLoop === eventLoop {
+                return entry.stock
+            }
+
+            // New event loops are rare, so this is a good time to drop the stocks of those that have gone away.
+            self.stocks = self.stocks.filter { $0.value.eventLoop != nil }
+            let stock = Stock()
+            self.stocks[ObjectIdentifier(eventLoop)] = StockEntry(eventLoop: eventLoop, stock: stock)
+            return stock
+        }
+    }
+
+    /// Tops up `stock`. Must be called on the thread pool, as generating key pairs is the slow part.
+    private func fill(_ stock: Stock) {
+        for group in self.groups {
+            let missing = stock.lock.withLock { self.keyPairsPerGroup - (stock.keyPairs[group]?.count ?? 0) }
+            guard missing > 0 else {
+                continue
+            }
+
+            let keyPairs = (0..<missing).compactMap { _ in NIOSSLKeySharePool.generateKeyPair(for: group) }
+            stock.lock.withLockVoid {
+                stock.keyPairs[group, default: []].append(contentsOf: keyPairs)
+            }
+        }
+    }
+
+    private static func generateKeyPair(for group: NIOSSLKeyExchangeGroup) -> KeyPair? {
+        if group == .x25519 {
+            var keyPair = KeyPair(privateKey: Array(repeating: 0, count: 32), publicKey: Array(repeating: 0, count: 32))
+            CNIOBoringSSL_X25519_keypair(&keyPair.publicKey, &keyPair.privateKey)
+            return keyPair
+        }
+
+        guard let key = CNIOBoringSSL_EC_KEY_new_by_curve_name(group.nid) else {
+            return nil
+        }
+        defer {
+            CNIOBoringSSL_EC_KEY_free(key)
+        }
+        guard CNIOBoringSSL_EC_KEY_generate_key(key) == 1 else {
+            return nil
+        }
+
+        // BoringSSL expects the scalar padded to the length of the group order, and an uncompressed point.
+        let ecGroup = CNIOBoringSSL_EC_KEY_get0_group(key)
+        let privateKeyLength = Int(CNIOBoringSSL_BN_num_bytes(CNIOBoringSSL_EC_GROUP_get0_order(ecGroup)))
+        var privateKey = Array(repeating: UInt8(0), count: privateKeyLength)
+        guard CNIOBoringSSL_BN_bn2bin_padded(&privateKey, privateKeyLength, CNIOBoringSSL_EC_KEY_get0_private_key(key)) == 1 else {
+            return nil
+        }
+
+        let publicPoint = CNIOBoringSSL_EC_KEY_get0_public_key(key)
+        let publicKeyLength = CNIOBoringSSL_EC_POINT_point2oct(ecGroup, publicPoint, POINT_CONVERSION_UNCOMPRESSED, nil, 0, nil)
+        var publicKey = Array(repeating: UInt8(0), count: publicKeyLength)
+        guard CNIOBoringSSL_EC_POINT_point2oct(ecGroup, publicPoint, POINT_CONVERSION_UNCOMPRESSED,
+                                               &publicKey, publicKeyLength, nil) == publicKeyLength else {
+            return nil
+        }
+
+        return KeyPair(privateKey: privateKey, publicKey: publicKey)
+    }
+}
+
+extension NIOSSLContext {
+    /// Makes a `SSL_CTX` take its ephemeral key pairs from the `keySharePool` of its configuration.
+    internal static func configureKeySharePool(context: OpaquePointer) {
+        CNIOBoringSSL_SSL_CTX_set_key_share_pool_cb(context) { ssl, groupID, outPrivateKey, outPrivateKeyLength, maxPrivateKeyLength,
+                                                               outPublicKey, outPublicKeyLength, maxPublicKeyLength in
+            guard let ssl = ssl else {
+                return 0
+            }
+
+            let connection = SSLConnection.loadConnectionFromSSL(ssl)
+            guard let eventLoop = connection.parentHandler?.channel?.eventLoop,
+                  var keyPair = connection.parentContext.configuration.keySharePool?.take(groupID: groupID, eventLoop: eventLoop) else {
+                return 0
+            }
+            defer {
+                keyPair.cleanse()
+            }
+            guard keyPair.privateKey.count <= maxPrivateKeyLength,
+                  keyPair.publicKey.count <= maxPublicKeyLength else {
+                return 0
+            }
+
+            keyPair.privateKey.withUnsafeBufferPointer { outPrivateKey!.assign(from: $0.baseAddress!, count: $0.count) }
+            keyPair.publicKey.withUnsafeBufferPointer { outPublicKey!.assign(from: $0.baseAddress!, count: $0.count) }
+            outPrivateKeyLength!.pointee = keyPair.privateKey.count
+            outPublicKeyLength!.pointee = keyPair.publicKey.count
+            return 1
+        }
+    }
+}
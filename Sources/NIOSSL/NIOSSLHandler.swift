@@ -14,6 +14,7 @@
 
 import NIOCore
 @_implementationOnly import CNIOBoringSSL
+@_implementationOnly import CNIOBoringSSLShims
 import NIOTLS
 
 /// The base class for all NIOSSL handlers. This class cannot actually be instantiated by
@@ -38,11 +39,36 @@ public class NIOSSLHandler : ChannelInboundHandler, ChannelOutboundHandler, Remo
         case closing(Scheduled<Void>)
         case unwrapped
         case closed
+        case offloaded
+        case exported
+    }
+
+    /// Tracks the progress of TLS 1.3 early data on this connection.
+    private enum EarlyDataState {
+        /// Early data is not in use, or has been resolved.
+        case none
+        /// Client: these flushed writes were sent as early data, and must be resent if the server rejects them.
+        case sent(CircularBuffer<BufferedWrite>)
+        /// Server: early data was accepted, but the client has not yet completed the handshake.
+        case receiving
+        /// Server: the client has completed the handshake. `.replaySafe` fires once the reads decoded so far are delivered.
+        case confirmed
     }
 
     private var state: ConnectionState = .idle
-    private var connection: SSLConnection
+    private var earlyDataState: EarlyDataState = .none
+
+    /// Whether plaintext decrypted in place has been delivered since the last `channelReadComplete`.
+    private var deliveredPlaintextInPlace = false
+
+    /// Whether we are waiting for the handshake to be written to the socket before offloading to kernel TLS.
+    /// Until then, reads and writes are held so that the sequence numbers don't move.
+    private var awaitingKernelTLSOffload = false
+
+    internal private(set) var connection: SSLConnection
     private var plaintextReadBuffer: ByteBuffer?
+    private var coalescedRecordBuffer: ByteBuffer?
+    private var recordSizer: DynamicRecordSizer?
     private var bufferedWrites: MarkedCircularBuffer<BufferedWrite>
     private var closePromise: EventLoopPromise<Void>?
     private var shutdownPromise: EventLoopPromise<Void>?
@@ -50,14 +76,20 @@ public class NIOSSLHandler : ChannelInboundHandler, ChannelOutboundHandler, Remo
     private var storedContext: ChannelHandlerContext? = nil
     private var shutdownTimeout: TimeAmount
 
+    /// Ciphertext from a connection exported by another handler, which the peer has sent but that connection
+    /// had not yet processed. It is passed to BoringSSL once we have a `ByteBufferBIO`.
+    private var importedUnconsumedData: [UInt8]
+
     internal var channel: Channel? {
         return self.storedContext?.channel
     }
     
-    internal init(connection: SSLConnection, shutdownTimeout: TimeAmount) {
+    internal init(connection: SSLConnection, shutdownTimeout: TimeAmount, importedUnconsumedData: [UInt8] = []) {
         self.connection = connection
+        self.importedUnconsumedData = importedUnconsumedData
         self.bufferedWrites = MarkedCircularBuffer(initialCapacity: 96)  // 96 brings the total size of the buffer to just shy of one page
         self.shutdownTimeout = shutdownTimeout
+        self.recordSizer = connection.parentContext.configuration.dynamicRecordSizing.map(DynamicRecordSizer.init)
     }
 
     public func handlerAdded(context: ChannelHandlerContext) {
@@ -65,7 +97,12 @@ public class NIOSSLHandler : ChannelInboundHandler, ChannelOutboundHandler, Remo
         self.connection.setAllocator(context.channel.allocator)
         self.connection.parentHandler = self
         self.connection.eventLoop = context.eventLoop
-        
+
+        if !self.importedUnconsumedData.isEmpty {
+            self.connection.consumeDataFromNetwork(context.channel.allocator.buffer(bytes: self.importedUnconsumedData))
+            self.importedUnconsumedData = []
+        }
+
         self.plaintextReadBuffer = context.channel.allocator.buffer(capacity: SSL_MAX_RECORD_SIZE)
         // If this channel is already active, immediately begin handshaking.
         if context.channel.isActive {
@@ -101,8 +138,10 @@ public class NIOSSLHandler : ChannelInboundHandler, ChannelOutboundHandler, Remo
         let channelError: NIOSSLError
 
         switch oldState {
-        case .closed, .idle:
-            // Nothing to do, but discard any buffered writes we still have.
+        case .closed, .idle, .offloaded, .exported:
+            // Nothing to do, but discard any buffered writes we still have. Offloaded connections can't see
+            // CLOSE_NOTIFY, so we can't tell whether their EOF was ragged, and exported ones belong to
+            // another process.
             discardBufferedWrites(reason: ChannelError.ioOnClosedChannel)
             // Return early
             context.fireChannelInactive()
@@ -134,7 +173,25 @@ public class NIOSSLHandler : ChannelInboundHandler, ChannelOutboundHandler, Remo
     }
     
     public func channelRead(context: ChannelHandlerContext, data: NIOAny) {
-        let binaryData = unwrapInboundIn(data)
+        if case .offloaded = self.state {
+            // The kernel has already decrypted this.
+            context.fireChannelRead(data)
+            return
+        }
+
+        var binaryData = unwrapInboundIn(data)
+
+        if case .active = self.state, self.awaitingKernelTLSOffload {
+            // These records are decrypted once we know whether the kernel is taking over.
+            self.connection.consumeDataFromNetwork(binaryData)
+            return
+        }
+
+        if case .active = self.state, self.connection.canReadDataInPlace {
+            self.doDecodeDataInPlace(context: context, ciphertext: &binaryData)
+            self.doUnbufferWrites(context: context)
+            return
+        }
         
         // The logic: feed the buffers, then take an action based on state.
         connection.consumeDataFromNetwork(binaryData)
@@ -158,19 +215,52 @@ public class NIOSSLHandler : ChannelInboundHandler, ChannelOutboundHandler, Remo
     }
     
     public func channelReadComplete(context: ChannelHandlerContext) {
+        if case .offloaded = self.state {
+            context.fireChannelReadComplete()
+            return
+        }
+
         guard let receiveBuffer = self.plaintextReadBuffer else {
             preconditionFailure("channelReadComplete called before handlerAdded")
         }
 
-        self.doFlushReadData(context: context, receiveBuffer: receiveBuffer, readOnEmptyBuffer: true)
+        if self.deliveredPlaintextInPlace {
+            // The plaintext has already been delivered, so we owe the pipeline a channelReadComplete.
+            self.deliveredPlaintextInPlace = false
+            self.doFlushReadData(context: context, receiveBuffer: receiveBuffer, readOnEmptyBuffer: false)
+            context.fireChannelReadComplete()
+        } else {
+            self.doFlushReadData(context: context, receiveBuffer: receiveBuffer, readOnEmptyBuffer: true)
+        }
         self.writeDataToNetwork(context: context, promise: nil)
+
+        if case .confirmed = self.earlyDataState {
+            self.earlyDataState = .none
+            context.fireUserInboundEventTriggered(NIOSSLEarlyDataEvent.replaySafe)
+        }
     }
     
     public func write(context: ChannelHandlerContext, data: NIOAny, promise: EventLoopPromise<Void>?) {
+        switch self.state {
+        case .offloaded:
+            // The kernel encrypts this. We pass the data on as-is, so that file regions can be sent too.
+            context.write(data, promise: promise)
+            return
+        case .exported:
+            // Another process is writing to this connection now.
+            promise?.fail(ChannelError.ioOnClosedChannel)
+            return
+        default:
+            break
+        }
         bufferWrite(data: unwrapOutboundIn(data), promise: promise)
     }
 
     public func flush(context: ChannelHandlerContext) {
+        if case .offloaded = self.state {
+            context.flush()
+            return
+        }
         bufferFlush()
         doUnbufferWrites(context: context)
     }
@@ -204,9 +294,10 @@ public class NIOSSLHandler : ChannelInboundHandler, ChannelOutboundHandler, Remo
         case .idle:
             state = .closed
             fallthrough
-        case .closed, .unwrapped:
+        case .closed, .unwrapped, .offloaded, .exported:
             // For idle, closed, and unwrapped connections we immediately pass this on to the next
-            // channel handler.
+            // channel handler. Offloaded and exported connections can no longer send CLOSE_NOTIFY, so they
+            // do the same.
             context.close(promise: promise)
         case .active, .handshaking:
             // We need to begin processing shutdown now. We can't fire the promise for a
@@ -226,6 +317,11 @@ public class NIOSSLHandler : ChannelInboundHandler, ChannelOutboundHandler, Remo
     ///
     /// This method must not be called once the connection is established.
     private func doHandshakeStep(context: ChannelHandlerContext) {
+        if case .idle = self.state {
+            // This is the first handshake step, so the peer address is now known.
+            self.connection.offerStoredSession(remoteAddress: context.channel.remoteAddress)
+        }
+
         let result = connection.doHandshake()
         
         switch result {
@@ -233,6 +329,19 @@ public class NIOSSLHandler : ChannelInboundHandler, ChannelOutboundHandler, Remo
             state = .handshaking
             writeDataToNetwork(context: context, promise: nil)
         case .complete:
+            if self.connection.role == .client && self.connection.isInEarlyData {
+                // BoringSSL has returned early so that we can send early data. The handshake is still
+                // in progress, and we'll be called again when the server's flight arrives.
+                self.state = .handshaking
+                if case .none = self.earlyDataState {
+                    self.earlyDataState = .sent(CircularBuffer())
+                }
+                self.doWriteEarlyData(context: context)
+                // The ClientHello is still waiting in the BIO, whether or not any early data was written.
+                writeDataToNetwork(context: context, promise: nil)
+                return
+            }
+
             do {
                 try validateHostname(context: context)
             } catch {
@@ -243,11 +352,22 @@ public class NIOSSLHandler : ChannelInboundHandler, ChannelOutboundHandler, Remo
             }
 
             state = .active
+            connection.parentContext.recordHandshakeCompletion(sessionReused: connection.sessionReused)
+            connection.parentContext.recordKeyExchange(usedHelloRetryRequest: connection.usedHelloRetryRequest)
+            // Session tickets may be held back until the next write, so we flush them before offloading.
+            let offloadToKernel = self.connection.mayOffloadToKernel && self.connection.flushPendingHandshakeData()
             writeDataToNetwork(context: context, promise: nil)
 
             // TODO(cory): This event should probably fire out of the BoringSSL info callback.
             let negotiatedProtocol = connection.getAlpnProtocol()
             context.fireUserInboundEventTriggered(TLSUserEvent.handshakeCompleted(negotiatedProtocol: negotiatedProtocol))
+            self.resolveEarlyData(context: context)
+
+            if offloadToKernel {
+                // Pending reads and writes are dealt with once we know whether the kernel has taken over.
+                self.beginKernelTLSOffload(context: context)
+                return
+            }
             
             // We need to unbuffer any pending writes and reads. We will have pending writes if the user attempted to
             // write before we completed the handshake. We may also have pending reads if the user sent data immediately
@@ -330,7 +450,7 @@ public class NIOSSLHandler : ChannelInboundHandler, ChannelOutboundHandler, Remo
     private func scheduleTimedOutShutdown(context: ChannelHandlerContext) -> Scheduled<Void> {
         return context.eventLoop.scheduleTask(in: self.shutdownTimeout) {
             switch self.state {
-            case .idle, .handshaking, .active:
+            case .idle, .handshaking, .active, .offloaded, .exported:
                 preconditionFailure("Cannot schedule timed out shutdown on non-shutting down handler")
 
             case .closed, .unwrapped:
@@ -369,6 +489,11 @@ public class NIOSSLHandler : ChannelInboundHandler, ChannelOutboundHandler, Remo
 
         readLoop: while true {
             let result = connection.readDataFromNetwork(outputBuffer: &receiveBuffer)
+
+            if case .receiving = self.earlyDataState, !self.connection.isInEarlyData {
+                // The client's Finished has been processed: everything from here on is replay safe.
+                self.earlyDataState = .confirmed
+            }
             
             switch result {
             case .complete:
@@ -381,7 +506,7 @@ public class NIOSSLHandler : ChannelInboundHandler, ChannelOutboundHandler, Remo
 
             case .failed(BoringSSLError.zeroReturn):
                 switch self.state {
-                case .idle, .handshaking:
+                case .idle, .handshaking, .offloaded, .exported:
                     preconditionFailure("Should not get zeroReturn in \(self.state)")
                 case .closed, .unwrapped:
                     // This is an unexpected place to be, but it's not totally impossible. Assume this
@@ -410,6 +535,58 @@ public class NIOSSLHandler : ChannelInboundHandler, ChannelOutboundHandler, Remo
         }
     }
 
+    /// Decrypts application data without passing it through BoringSSL's buffers. The channel still holds
+    /// the buffer it read, so decrypting copies `ciphertext` into storage of our own once; the plaintext of
+    /// each record is delivered as a slice of that copy.
+    private func doDecodeDataInPlace(context: ChannelHandlerContext, ciphertext: inout ByteBuffer) {
+        guard let receiveBuffer = self.plaintextReadBuffer else {
+            preconditionFailure("doDecodeDataInPlace called without handlerAdded firing.")
+        }
+
+        // Anything SSL_read decrypted earlier must be delivered first.
+        self.doFlushReadData(context: context, receiveBuffer: receiveBuffer, readOnEmptyBuffer: false)
+
+        var plaintext: [ByteBuffer] = []
+        let result = self.connection.readDataInPlace(&ciphertext, plaintext: &plaintext)
+
+        if !plaintext.isEmpty {
+            self.deliveredPlaintextInPlace = true
+        }
+        for buffer in plaintext {
+            context.fireChannelRead(self.wrapInboundOut(buffer))
+        }
+
+        switch result {
+        case .complete, .incomplete:
+            break
+
+        case .failed(BoringSSLError.zeroReturn):
+            switch self.state {
+            case .idle, .handshaking, .offloaded, .exported:
+                preconditionFailure("Should not get zeroReturn in \(self.state)")
+            case .closed, .unwrapped:
+                return
+            case .active:
+                self.state = .closing(self.scheduleTimedOutShutdown(context: context))
+            case .unwrapping, .closing:
+                break
+            }
+
+            // This is a clean EOF: we can just start doing our own clean shutdown.
+            if self.deliveredPlaintextInPlace {
+                self.deliveredPlaintextInPlace = false
+                context.fireChannelReadComplete()
+            }
+            doShutdownStep(context: context)
+            writeDataToNetwork(context: context, promise: nil)
+
+        case .failed(let err):
+            self.state = .closed
+            context.fireErrorCaught(err)
+            channelClose(context: context, reason: err)
+        }
+    }
+
     /// Flushes any pending read plaintext. This is called whenever we hit a flush
     /// point for reads: either channelReadComplete, or we receive a CLOSE_NOTIFY.
     ///
@@ -624,10 +801,50 @@ extension NIOSSLHandler {
             // We are already unwrapped. Succeed the promise, do nothing.
             promise?.succeed(())
 
-        case .closed:
+        case .closed, .exported:
             promise?.fail(NIOTLSUnwrappingError.alreadyClosed)
+
+        case .offloaded:
+            // The kernel is protecting the connection, and we can't take the protection back.
+            promise?.fail(NIOSSLExtraError.cannotUnwrapOffloadedConnection)
         }
     }
+
+    /// Exports the TLS state of this connection, so that it can be resumed in another process by a
+    /// `NIOSSLServerHandler` created with `init(context:handback:)`.
+    ///
+    /// Only established TLS 1.2 server connections can be exported. The connection must be idle: every flushed
+    /// write must have been written, and no write may be waiting for a flush. The connection should stop reading
+    /// before it is exported, for example by turning off `autoRead`, as anything it reads afterwards is lost.
+    /// If a record has only partly arrived, the export fails, and can be retried once the rest has been read.
+    ///
+    /// Once exported, this handler fails any further writes, and closing the channel sends nothing to the peer.
+    /// The socket should be passed to the other process, and then closed here.
+    ///
+    /// This function **is not thread-safe**: you **must** call it from the correct event
+    /// loop thread.
+    ///
+    /// - returns: The state of the connection. It contains the connection's keys, so it must only be passed to a
+    ///     trusted process, over a trusted transport.
+    /// - throws: `NIOSSLExtraError.cannotExportConnection` if the connection cannot be exported in its current state.
+    public func exportConnection() throws -> NIOSSLConnectionHandback {
+        guard case .active = self.state, !self.awaitingKernelTLSOffload else {
+            throw NIOSSLExtraError.cannotExportConnection(reason: "the connection is not established in user space")
+        }
+        guard self.bufferedWrites.isEmpty, !self.connection.hasOutboundData else {
+            throw NIOSSLExtraError.cannotExportConnection(reason: "the connection has writes pending")
+        }
+        guard self.plaintextReadBuffer.map({ $0.readableBytes == 0 }) ?? false else {
+            throw NIOSSLExtraError.cannotExportConnection(reason: "the connection has reads pending")
+        }
+        guard let state = self.connection.serializeHandback() else {
+            throw NIOSSLExtraError.cannotExportConnection(reason: "BoringSSL cannot serialize the connection")
+        }
+
+        self.state = .exported
+        let unconsumedData = self.connection.extractUnconsumedData()
+        return NIOSSLConnectionHandback(state: state, unconsumedData: unconsumedData.map { Array($0.readableBytesView) } ?? [])
+    }
 }
 
 
@@ -644,6 +861,11 @@ extension NIOSSLHandler {
     }
 
     private func discardBufferedWrites(reason: Error) {
+        if case .sent(let sentWrites) = self.earlyDataState {
+            self.earlyDataState = .none
+            sentWrites.forEach { $0.promise?.fail(reason) }
+        }
+
         while self.bufferedWrites.count > 0 {
             let bufferedWrite = self.bufferedWrites.removeFirst()
             bufferedWrite.promise?.fail(reason)
@@ -656,20 +878,62 @@ extension NIOSSLHandler {
             return
         }
 
-        // These are some annoying variables we use to persist state across invocations of
-        // our closures. A better version of this code might be able to simplify this somewhat.
+        // Writing would start the handshake before we've had a chance to offer a stored
+        // session, so hold on to the writes until the handshake begins.
+        if case .idle = self.state {
+            return
+        }
+
+        // Encrypting now would move the write sequence number past what the kernel is about to be given.
+        if self.awaitingKernelTLSOffload {
+            return
+        }
+
+        // Until the handshake completes, flushed writes go out as early data.
+        if case .sent = self.earlyDataState {
+            self.doWriteEarlyData(context: context)
+            return
+        }
+
+        // The promises of the writes we've encoded so far, which complete once the ciphertext is written.
         var promises: [EventLoopPromise<Void>] = []
         var didWrite = false
 
+        self.recordSizer?.flushStarted(at: .now())
+
         do {
-            try bufferedWrites.forEachElementUntilMark { element in
-                var data = element.data
-                let writeSuccessful = try self._encodeSingleWrite(buf: &data)
-                if writeSuccessful {
-                    didWrite = true
-                    if let promise = element.promise { promises.append(promise) }
+            while self.bufferedWrites.hasMark {
+                if let recordSizer = self.recordSizer {
+                    self.connection.maxSendFragment = recordSizer.recordSize
+                }
+
+                // Small writes are packed together into records of up to maxSendFragment, to save on
+                // record overhead. A write that gets a record to itself is encoded without a copy.
+                let (writeCount, byteCount) = self.coalescableWrites()
+                let writeSuccessful: Bool
+                if writeCount == 1 {
+                    writeSuccessful = try self._encodeFirstWrite()
+                } else if self.connection.canSealRecordsDirectly {
+                    // BoringSSL can read the writes directly, skipping the coalescing buffer.
+                    writeSuccessful = try self._encodeGatheredWrites(count: writeCount)
+                } else {
+                    var record = self.coalesceWrites(count: writeCount, allocator: context.channel.allocator)
+                    defer {
+                        self.coalescedRecordBuffer = record
+                    }
+                    writeSuccessful = try self._encodeSingleWrite(buf: &record)
+                }
+
+                guard writeSuccessful else {
+                    break
+                }
+                didWrite = true
+                if writeCount > 1 {
+                    self.recordSizer?.sent(bytes: byteCount)
+                }
+                for _ in 0..<writeCount {
+                    if let promise = self.bufferedWrites.removeFirst().promise { promises.append(promise) }
                 }
-                return writeSuccessful
             }
 
             // If we got this far and did a write, we should shove the data out to the
@@ -688,10 +952,170 @@ extension NIOSSLHandler {
         }
     }
 
+    /// The number of flushed writes, from the front of `bufferedWrites`, that fit in a single record, and
+    /// their total size. This is always at least one write, as a write that is larger than a record is
+    /// encoded alone.
+    private func coalescableWrites() -> (count: Int, byteCount: Int) {
+        guard let markIndex = self.bufferedWrites.markedElementIndex else {
+            return (0, 0)
+        }
+
+        var index = self.bufferedWrites.startIndex
+        var count = 0
+        var byteCount = 0
+        while true {
+            let writeSize = self.bufferedWrites[index].data.readableBytes
+            if count > 0 && byteCount + writeSize > self.connection.maxSendFragment {
+                break
+            }
+            count += 1
+            byteCount += writeSize
+            if index == markIndex {
+                break
+            }
+            index = self.bufferedWrites.index(after: index)
+        }
+        return (count, byteCount)
+    }
+
+    /// Copies the first `count` buffered writes into a single buffer. The returned buffer should be stored
+    /// back in `coalescedRecordBuffer` once it has been encoded, so that it can be re-used.
+    private func coalesceWrites(count: Int, allocator: ByteBufferAllocator) -> ByteBuffer {
+        // We nil the stored buffer so that clearing it doesn't trigger a CoW.
+        var record = self.coalescedRecordBuffer ?? allocator.buffer(capacity: SSL_MAX_RECORD_SIZE)
+        self.coalescedRecordBuffer = nil
+        record.clear()
+
+        var index = self.bufferedWrites.startIndex
+        for _ in 0..<count {
+            record.writeImmutableBuffer(self.bufferedWrites[index].data)
+            index = self.bufferedWrites.index(after: index)
+        }
+        return record
+    }
+
+    /// Sends flushed writes as early data. The writes are retained until the server accepts or
+    /// rejects them, so that they can be resent if necessary.
+    private func doWriteEarlyData(context: ChannelHandlerContext) {
+        guard case .sent(var sentWrites) = self.earlyDataState, self.bufferedWrites.hasMark else {
+            return
+        }
+
+        // Drop our reference to avoid a CoW on append.
+        self.earlyDataState = .none
+        var didWrite = false
+
+        do {
+            try bufferedWrites.forEachElementUntilMark { element in
+                var data = element.data
+                let writeSuccessful = try self._encodeSingleWrite(buf: &data)
+                if writeSuccessful {
+                    didWrite = true
+                    sentWrites.append(element)
+                }
+                return writeSuccessful
+            }
+
+            self.earlyDataState = .sent(sentWrites)
+            if didWrite {
+                self.writeDataToNetwork(context: context, promise: nil)
+            }
+        } catch {
+            self.earlyDataState = .sent(sentWrites)
+            channelClose(context: context, reason: error)
+            self.discardBufferedWrites(reason: error)
+        }
+    }
+
+    /// Once the handshake has completed, reports the outcome of any early data and resends early
+    /// writes the server rejected.
+    private func resolveEarlyData(context: ChannelHandlerContext) {
+        switch self.earlyDataState {
+        case .sent(let sentWrites):
+            self.earlyDataState = .none
+
+            if self.connection.earlyDataAccepted {
+                sentWrites.forEach { $0.promise?.succeed(()) }
+                context.fireUserInboundEventTriggered(NIOSSLEarlyDataEvent.accepted)
+                return
+            }
+
+            var promises: [EventLoopPromise<Void>] = []
+            do {
+                for write in sentWrites {
+                    var data = write.data
+                    let writeSuccessful = try self._encodeSingleWrite(buf: &data)
+                    assert(writeSuccessful, "Writes cannot be deferred once the handshake has completed")
+                    if let promise = write.promise { promises.append(promise) }
+                }
+                self.writeDataToNetwork(context: context, promise: promises.flattenPromises(on: context.eventLoop))
+                context.fireUserInboundEventTriggered(NIOSSLEarlyDataEvent.rejected)
+            } catch {
+                channelClose(context: context, reason: error)
+                sentWrites.forEach { $0.promise?.fail(error) }
+                self.discardBufferedWrites(reason: error)
+            }
+
+        case .none where self.connection.role == .server:
+            if self.connection.isInEarlyData {
+                self.earlyDataState = .receiving
+                context.fireUserInboundEventTriggered(NIOSSLEarlyDataEvent.accepted)
+            } else if self.connection.rejectedOfferedEarlyData {
+                context.fireUserInboundEventTriggered(NIOSSLEarlyDataEvent.rejected)
+            }
+
+        case .none, .receiving, .confirmed:
+            break
+        }
+    }
+
     /// Given a ByteBuffer to encode, passes it to BoringSSL and handles the result.
     private func _encodeSingleWrite(buf: inout ByteBuffer) throws -> Bool {
-        let result = self.connection.writeDataToNetwork(&buf)
+        return try self._processWriteResult(self.connection.writeDataToNetwork(&buf))
+    }
 
+    /// Encodes the first buffered write.
+    ///
+    /// With dynamic record sizing, the write is encoded one record at a time for as long as records are small,
+    /// so that a single large write switches to full-size records once the connection has warmed up.
+    private func _encodeFirstWrite() throws -> Bool {
+        var data = self.bufferedWrites.first!.data
+        guard self.recordSizer != nil else {
+            return try self._encodeSingleWrite(buf: &data)
+        }
+
+        repeat {
+            let recordSize = self.recordSizer!.recordSize
+            self.connection.maxSendFragment = recordSize
+
+            // Once records are full-size, the rest of the write can be encoded in one go.
+            var chunk = data
+            if recordSize < data.readableBytes && recordSize < SSL_MAX_RECORD_SIZE {
+                chunk = data.getSlice(at: data.readerIndex, length: recordSize)!
+            }
+            let chunkLength = chunk.readableBytes
+
+            guard try self._encodeSingleWrite(buf: &chunk) else {
+                // Don't encode the records we've already sent a second time.
+                self.bufferedWrites[self.bufferedWrites.startIndex].data = data
+                return false
+            }
+            data.moveReaderIndex(forwardBy: chunkLength)
+            self.recordSizer!.sent(bytes: chunkLength)
+        } while data.readableBytes > 0
+
+        return true
+    }
+
+    /// Encodes the first `count` buffered writes as a single record, which BoringSSL encrypts straight
+    /// from the writes' own buffers into the outbound buffer.
+    private func _encodeGatheredWrites(count: Int) throws -> Bool {
+        let writes = self.bufferedWrites.prefix(count).lazy.map { $0.data }
+        return try self._processWriteResult(self.connection.sealRecordDirectly(gathering: writes))
+    }
+
+    /// Returns whether a write made it through BoringSSL, throwing if it failed.
+    private func _processWriteResult(_ result: AsyncOperationResult<CInt>) throws -> Bool {
         switch result {
         case .complete:
             return true
@@ -757,3 +1181,110 @@ extension NIOSSLHandler {
         self.doHandshakeStep(context: storedContext)
     }
 }
+
+
+// MARK:- Code for offloading record protection to kernel TLS.
+extension NIOSSLHandler {
+    /// Arranges to hand the connection over to the kernel once the end of the handshake has reached the
+    /// socket. Ciphertext we have already written must not be encrypted again by the kernel.
+    private func beginKernelTLSOffload(context: ChannelHandlerContext) {
+        guard case .active = self.state else {
+            return
+        }
+
+        self.awaitingKernelTLSOffload = true
+        let promise = context.eventLoop.makePromise(of: Void.self)
+        promise.futureResult.whenComplete { result in
+            guard case .success = result, case .active = self.state else {
+                self.awaitingKernelTLSOffload = false
+                return
+            }
+            self.completeKernelTLSOffload(context: context)
+        }
+        // Nothing is left to write, so this issues an empty write that completes once everything before it has.
+        self.writeDataToNetwork(context: context, promise: promise)
+    }
+
+    /// Installs the connection's keys on the socket, if the connection is still at a point where the kernel
+    /// can take over. If it isn't, or the kernel can't, the connection carries on in user space.
+    private func completeKernelTLSOffload(context: ChannelHandlerContext) {
+        // Records that arrived while we were waiting are decrypted here. If the last of them is incomplete,
+        // the kernel can't start from the right place in the stream.
+        let receivedWholeRecords = self.connection.inboundDataEndsOnRecordBoundary
+        self.doDecodeData(context: context)
+
+        guard receivedWholeRecords,
+              case .active = self.state,
+              self.connection.isIdleAtRecordBoundary,
+              let socket = context.channel as? SocketOptionProvider,
+              var transmitInfo = self.connection.kernelTLSCryptoInfo(forWriting: true),
+              var receiveInfo = self.connection.kernelTLSCryptoInfo(forWriting: false) else {
+            self.finishKernelTLSOffload(context: context)
+            return
+        }
+
+        let clearKeys = {
+            CNIOBoringSSL_OPENSSL_cleanse(&transmitInfo, MemoryLayout<CNIOBoringSSLShims_kernel_tls_crypto_info>.size)
+            CNIOBoringSSL_OPENSSL_cleanse(&receiveInfo, MemoryLayout<CNIOBoringSSLShims_kernel_tls_crypto_info>.size)
+        }
+
+        socket.attachKernelTLS().flatMap {
+            socket.setKernelTLSCryptoInfo(transmitInfo, direction: .transmit)
+        }.whenComplete { transmitResult in
+            guard case .success = transmitResult else {
+                // The kernel doesn't support this connection. Nothing has changed yet, so we carry on as we were.
+                clearKeys()
+                self.finishKernelTLSOffload(context: context)
+                return
+            }
+
+            socket.setKernelTLSCryptoInfo(receiveInfo, direction: .receive).whenComplete { receiveResult in
+                clearKeys()
+                switch receiveResult {
+                case .success:
+                    self.state = .offloaded
+                case .failure(let error):
+                    // The kernel is now encrypting our writes, but can't decrypt our reads. We can't recover from that.
+                    context.fireErrorCaught(error)
+                    self.channelClose(context: context, reason: error)
+                }
+                self.finishKernelTLSOffload(context: context)
+            }
+        }
+    }
+
+    /// Delivers the reads and writes that were held while we offloaded.
+    private func finishKernelTLSOffload(context: ChannelHandlerContext) {
+        self.awaitingKernelTLSOffload = false
+
+        // We're not in a read, so the plaintext decrypted while waiting won't be delivered by channelReadComplete.
+        if let receiveBuffer = self.plaintextReadBuffer {
+            self.doFlushReadData(context: context, receiveBuffer: receiveBuffer, readOnEmptyBuffer: false)
+        }
+
+        switch self.state {
+        case .active:
+            self.doUnbufferWrites(context: context)
+        case .offloaded:
+            self.passBufferedWritesThrough(context: context)
+        default:
+            break
+        }
+    }
+
+    /// Passes the writes buffered before the connection was offloaded on to the channel, for the kernel to encrypt.
+    private func passBufferedWritesThrough(context: ChannelHandlerContext) {
+        var flushedWrites = self.bufferedWrites.markedElementIndex.map {
+            self.bufferedWrites.distance(from: self.bufferedWrites.startIndex, to: $0) + 1
+        } ?? 0
+
+        while self.bufferedWrites.count > 0 {
+            let bufferedWrite = self.bufferedWrites.removeFirst()
+            context.write(self.wrapOutboundOut(bufferedWrite.data), promise: bufferedWrite.promise)
+            flushedWrites -= 1
+            if flushedWrites == 0 {
+                context.flush()
+            }
+        }
+    }
+}
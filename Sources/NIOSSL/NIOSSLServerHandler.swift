@@ -41,6 +41,28 @@ public final class NIOSSLServerHandler: NIOSSLHandler {
         self.init(context: context, optionalCustomVerificationCallback: customVerificationCallback)
     }
 
+    /// Creates a handler that resumes a connection exported from another process by
+    /// `NIOSSLHandler.exportConnection()`. The handler should be added to a channel created from the connection's
+    /// socket, and fires `TLSUserEvent.handshakeCompleted` once the channel is active, without a new handshake.
+    ///
+    /// - parameters:
+    ///     - context: The context to use. It should have the same configuration as the exporting handler's context.
+    ///     - handback: The exported state of the connection.
+    /// - throws: `NIOSSLExtraError.invalidConnectionHandback` if the state could not be restored.
+    public init(context: NIOSSLContext, handback: NIOSSLConnectionHandback) throws {
+        guard let connection = context.createConnection() else {
+            fatalError("Failed to create new connection in NIOSSLContext")
+        }
+
+        guard connection.applyHandback(handback.state) else {
+            throw NIOSSLExtraError.invalidConnectionHandback
+        }
+
+        super.init(connection: connection,
+                   shutdownTimeout: context.configuration.shutdownTimeout,
+                   importedUnconsumedData: handback.unconsumedData)
+    }
+
     /// This exists to handle the explosion of initializers I got when I deprecated the first one.
     private init(context: NIOSSLContext, optionalCustomVerificationCallback: NIOSSLCustomVerificationCallback?) {
         guard let connection = context.createConnection() else {
@@ -0,0 +1,162 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOConcurrencyHelpers
+
+/// A set of certificate chains and private keys, from which a server picks one for each connection based on
+/// the server name the client asked for using SNI.
+///
+/// Identities are registered under exact server names, such as `example.com`, or under wildcard names, such as
+/// `*.example.com`, which match any single label in place of the `*`. Exact names take precedence over wildcards.
+/// Lookups cost a fixed number of hash table lookups, however many names the store holds.
+///
+/// Identities may be added and removed at any time, and changes apply to all subsequent handshakes on all
+/// contexts using the store. This object is thread-safe.
+///
+/// Connections that don't send SNI, or whose server name has no identity in the store, use the context's own
+/// certificate chain and private key. If it has none, their handshake fails.
+public final class NIOSSLCertificateStore {
+    private let lock = Lock()
+
+    /// Identities registered under exact server names.
+    private var exactNames: [String: NIOSSLIdentity] = [:]
+
+    /// Identities registered under wildcard names, keyed by the name with the leading `*.` removed.
+    private var wildcardNames: [String: NIOSSLIdentity] = [:]
+
+    /// Create an empty certificate store.
+    public init() { }
+
+    /// The number of server names, exact and wildcard, that have an identity in the store.
+    public var count: Int {
+        return self.lock.withLock { self.exactNames.count + self.wildcardNames.count }
+    }
+
+    /// Use the given certificate chain and private key for connections to any of `serverNames`, replacing any
+    /// identity previously registered for those names.
+    ///
+    /// - parameters:
+    ///     - certificateChain: The certificate chain to present, leaf first. Must not be empty.
+    ///     - privateKey: The private key for the leaf certificate.
+    ///     - serverNames: The server names to use this identity for. Each is either a DNS name, or a DNS name whose
+    ///         first label is `*`.
+    /// - throws: `NIOSSLExtraError.invalidCertificateStoreName` if a server name is not valid.
+    /// - throws: `NIOSSLError.failedToLoadPrivateKey` if `privateKey` does not match the leaf certificate.
+    public func setIdentity(certificateChain: [NIOSSLCertificate],
+                            privateKey: NIOSSLPrivateKey,
+                            forServerNames serverNames: [String]) throws {
+        let identity = try NIOSSLIdentity(certificateChain: certificateChain, privateKey: privateKey)
+        try self.setIdentity(identity, forServerNames: serverNames)
+    }
+
+    /// Use `identity` for connections to any of `serverNames`, replacing any identity previously registered for
+    /// those names.
+    ///
+    /// - parameters:
+    ///     - identity: The certificate chain and private key to present.
+    ///     - serverNames: The server names to use this identity for. Each is either a DNS name, or a DNS name whose
+    ///         first label is `*`.
+    /// - throws: `NIOSSLExtraError.invalidCertificateStoreName` if a server name is not valid.
+    public func setIdentity(_ identity: NIOSSLIdentity, forServerNames serverNames: [String]) throws {
+        let keys = try serverNames.map(NIOSSLCertificateStore.parseServerName)
+
+        self.lock.withLockVoid {
+            for key in keys {
+                switch key {
+                case .exact(let name):
+                    self.exactNames[name] = identity
+                case .wildcard(let parent):
+                    self.wildcardNames[parent] = identity
+                }
+            }
+        }
+    }
+
+    /// Stop using the identity registered for `serverName`. Other names the identity was registered for
+    /// are unaffected.
+    ///
+    /// - throws: `NIOSSLExtraError.invalidCertificateStoreName` if `serverName` is not valid.
+    public func removeIdentity(forServerName serverName: String) throws {
+        let key = try NIOSSLCertificateStore.parseServerName(serverName)
+        self.lock.withLockVoid {
+            switch key {
+            case .exact(let name):
+                self.exactNames.removeValue(forKey: name)
+            case .wildcard(let parent):
+                self.wildcardNames.removeValue(forKey: parent)
+            }
+        }
+    }
+
+    /// Remove every identity from the store.
+    public func removeAll() {
+        self.lock.withLockVoid {
+            self.exactNames.removeAll()
+            self.wildcardNames.removeAll()
+        }
+    }
+
+    /// Find the identity to use for a connection to `serverName`, which must already be normalized.
+    internal func identity(forServerName serverName: String) -> NIOSSLIdentity? {
+        let parent = serverName.firstIndex(of: ".").map { serverName[serverName.index(after: $0)...] }
+
+        return self.lock.withLock {
+            if let identity = self.exactNames[serverName] {
+                return identity
+            }
+            if let parent = parent, !parent.isEmpty {
+                return self.wildcardNames[String(parent)]
+            }
+            return nil
+        }
+    }
+
+    private enum Key {
+        case exact(String)
+        case wildcard(String)
+    }
+
+    private static func parseServerName(_ serverName: String) throws -> Key {
+        let name = NIOSSLCertificateStore.normalize(serverName)
+        let labels = name.split(separator: ".", omittingEmptySubsequences: false)
+        guard !name.isEmpty,
+              name.utf8.count <= 255,
+              labels.allSatisfy({ !$0.isEmpty }),
+              labels.dropFirst().allSatisfy({ !$0.contains("*") }) else {
+            throw NIOSSLExtraError.invalidCertificateStoreName(serverName: serverName)
+        }
+
+        switch labels.first! {
+        case "*":
+            guard labels.count > 1 else {
+                throw NIOSSLExtraError.invalidCertificateStoreName(serverName: serverName)
+            }
+            return .wildcard(labels.dropFirst().joined(separator: "."))
+        case let first where first.contains("*"):
+            // Partial-label wildcards are not supported.
+            throw NIOSSLExtraError.invalidCertificateStoreName(serverName: serverName)
+        default:
+            return .exact(name)
+        }
+    }
+
+    /// Server names are case-insensitive, and may be written with a trailing dot.
+    internal static func normalize(_ serverName: String) -> String {
+        var name = serverName.lowercased()
+        if name.hasSuffix(".") {
+            name.removeLast()
+        }
+        return name
+    }
+}
@@ -0,0 +1,164 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+import NIOConcurrencyHelpers
+@_implementationOnly import CNIOBoringSSL
+
+/// A resumable TLS session, as issued by a server.
+///
+/// `NIOSSLSession` objects are immutable and may be freely shared between threads.
+public final class NIOSSLSession {
+    internal let ref: OpaquePointer
+
+    internal init(takingOwnershipOf ref: OpaquePointer) {
+        self.ref = ref
+    }
+
+    /// Deserializes a session previously produced by `serializedBytes`.
+    ///
+    /// - parameters:
+    ///     - serializedBytes: The serialized session.
+    ///     - context: The `NIOSSLContext` that the session will be used with.
+    /// - throws: `NIOSSLExtraError.invalidSessionData` if the bytes do not contain a valid session.
+    public convenience init<Bytes: Collection>(serializedBytes: Bytes, context: NIOSSLContext) throws where Bytes.Element == UInt8 {
+        let ref = Array(serializedBytes).withUnsafeBufferPointer { bytes in
+            CNIOBoringSSL_SSL_SESSION_from_bytes(bytes.baseAddress, bytes.count, context.sslContext)
+        }
+        guard let session = ref else {
+            throw NIOSSLExtraError.invalidSessionData
+        }
+        self.init(takingOwnershipOf: session)
+    }
+
+    deinit {
+        CNIOBoringSSL_SSL_SESSION_free(self.ref)
+    }
+
+    /// The serialized form of this session, suitable for persisting or sharing with other processes.
+    ///
+    /// - warning: The serialized session contains secret key material and must be protected accordingly.
+    public var serializedBytes: [UInt8] {
+        var bytes: UnsafeMutablePointer<UInt8>? = nil
+        var length = 0
+        guard CNIOBoringSSL_SSL_SESSION_to_bytes(self.ref, &bytes, &length) == 1, let serialized = bytes else {
+            fatalError("Failed to serialize SSL_SESSION")
+        }
+        defer {
+            CNIOBoringSSL_OPENSSL_free(serialized)
+        }
+        return Array(UnsafeBufferPointer(start: serialized, count: length))
+    }
+}
+
+/// The key under which a client-side `NIOSSLClientSessionStore` files sessions.
+///
+/// Sessions are only offered to a server matching all of the fields of the key.
+public struct NIOSSLClientSessionKey: Hashable {
+    /// The hostname of the server. This is the SNI name if one was set, or the textual IP address of the peer otherwise.
+    public var hostname: String
+
+    /// The port of the server, if known.
+    public var port: Int?
+
+    /// The application protocols offered on the connection.
+    public var applicationProtocols: [String]
+
+    public init(hostname: String, port: Int?, applicationProtocols: [String]) {
+        self.hostname = hostname
+        self.port = port
+        self.applicationProtocols = applicationProtocols
+    }
+}
+
+/// A store of TLS sessions used by client-side `NIOSSLContext`s to resume sessions with servers they
+/// have previously connected to.
+///
+/// Stores are called from the `EventLoop`s of the connections using them, and so must be thread-safe.
+///
+/// - warning: Resumed sessions are not re-validated. A store must therefore only be shared between contexts
+///     that apply the same certificate verification settings.
+public protocol NIOSSLClientSessionStore: AnyObject {
+    /// Called when the server issues a new session for the peer identified by `key`.
+    func storeSession(_ session: NIOSSLSession, forKey key: NIOSSLClientSessionKey)
+
+    /// Called before a new connection handshakes to retrieve a session to offer to the peer identified by `key`.
+    func session(forKey key: NIOSSLClientSessionKey) -> NIOSSLSession?
+}
+
+/// A bounded, thread-safe, in-memory `NIOSSLClientSessionStore`.
+///
+/// The store keeps the most recently issued session for each key. Once `maximumSize` keys are stored, the
+/// oldest key is evicted.
+public final class NIOSSLInMemoryClientSessionStore: NIOSSLClientSessionStore {
+    private let lock = Lock()
+    private var sessions: [NIOSSLClientSessionKey: NIOSSLSession] = [:]
+    private var insertionOrder = CircularBuffer<NIOSSLClientSessionKey>()
+
+    /// The maximum number of keys for which sessions are held.
+    public let maximumSize: Int
+
+    /// Create a new, empty, in-memory session store.
+    ///
+    /// - parameters:
+    ///     - maximumSize: The maximum number of peers to store sessions for. Defaults to 1024.
+    public init(maximumSize: Int = 1024) {
+        precondition(maximumSize > 0, "maximumSize must be positive")
+        self.maximumSize = maximumSize
+    }
+
+    /// The number of peers sessions are currently held for.
+    public var count: Int {
+        return self.lock.withLock { self.sessions.count }
+    }
+
+    public func storeSession(_ session: NIOSSLSession, forKey key: NIOSSLClientSessionKey) {
+        self.lock.withLockVoid {
+            if self.sessions.updateValue(session, forKey: key) == nil {
+                self.insertionOrder.append(key)
+                if self.insertionOrder.count > self.maximumSize {
+                    self.sessions.removeValue(forKey: self.insertionOrder.removeFirst())
+                }
+            }
+        }
+    }
+
+    public func session(forKey key: NIOSSLClientSessionKey) -> NIOSSLSession? {
+        return self.lock.withLock { self.sessions[key] }
+    }
+}
+
+extension NIOSSLContext {
+    /// Installs the callback that captures sessions issued to clients of this context.
+    internal static func configureClientSessionStore(context: OpaquePointer) {
+        // Clients never use BoringSSL's internal cache, so this only enables the new session callback.
+        let mode = CNIOBoringSSL_SSL_CTX_get_session_cache_mode(context)
+        CNIOBoringSSL_SSL_CTX_set_session_cache_mode(context, mode | SSL_SESS_CACHE_CLIENT)
+        CNIOBoringSSL_SSL_CTX_sess_set_new_cb(context) { ssl, session in
+            guard let ssl = ssl, let session = session else {
+                return 0
+            }
+
+            let connection = SSLConnection.loadConnectionFromSSL(ssl)
+            guard let key = connection.clientSessionKey,
+                  let store = connection.parentContext.configuration.clientSessionStore else {
+                return 0
+            }
+
+            // Returning 1 tells BoringSSL we've taken ownership of the reference.
+            store.storeSession(NIOSSLSession(takingOwnershipOf: session), forKey: key)
+            return 1
+        }
+    }
+}
@@ -14,6 +14,7 @@
 
 import NIOCore
 @_implementationOnly import CNIOBoringSSL
+@_implementationOnly import CNIOBoringSSLShims
 
 internal let SSL_MAX_RECORD_SIZE = 16 * 1024
 
@@ -53,6 +54,28 @@ internal final class SSLConnection {
     private var verificationCallback: NIOSSLVerificationCallback?
     internal var customVerificationManager: CustomVerifyManager?
     internal var customPrivateKeyResult: Result<ByteBuffer, Error>?
+    internal var clientSessionKey: NIOSSLClientSessionKey?
+    /// The private key chosen for this connection from the configuration's certificate store, if any.
+    internal var selectedPrivateKey: NIOSSLPrivateKey?
+    internal var certificateSelectionState: CertificateSelectionState = .notStarted
+    internal var handshakeHintsState: HandshakeHintsState = .notStarted
+
+    /// The ciphertext of an incomplete record left over from `readDataInPlace`.
+    private var partialInPlaceRecord: ByteBuffer?
+
+    /// The buffers being sealed by `sealRecordDirectly(gathering:)`, kept between calls to save reallocating them.
+    private var gatherStorage: [Unmanaged<AnyObject>] = []
+    private var gatherPointers: [UnsafePointer<UInt8>?] = []
+    private var gatherLengths: [Int] = []
+
+    /// The largest amount of plaintext sent in a single record.
+    var maxSendFragment: Int = SSL_MAX_RECORD_SIZE {
+        didSet {
+            if self.maxSendFragment != oldValue {
+                CNIOBoringSSL_SSL_set_max_send_fragment(self.ssl, self.maxSendFragment)
+            }
+        }
+    }
 
     /// Whether certificate hostnames should be validated.
     var validateHostnames: Bool {
@@ -151,6 +174,11 @@ internal final class SSLConnection {
         }
     }
 
+    /// Whether an old-style verification callback is set.
+    var hasVerificationCallback: Bool {
+        return self.verificationCallback != nil
+    }
+
     func setCustomVerificationCallback(_ callbackManager: CustomVerifyManager) {
         // Store the verification callback. We need to do this to keep it alive throughout the connection.
         // We'll drop this when we're told that it's no longer needed to ensure we break the reference cycles
@@ -193,13 +221,11 @@ internal final class SSLConnection {
     /// Performs hostname validation against the peer certificate using the configured server name.
     func validateHostname(address: SocketAddress) throws {
         // We want the leaf certificate.
-        guard let peerCert = self.getPeerCertificate() else {
+        guard let identity = self.peerCertificateIdentity() else {
             throw NIOSSLError.noCertificateToValidate
         }
 
-        guard try validIdentityForService(serverHostname: self.expectedHostname,
-                                          socketAddress: address,
-                                          leafCertificate: peerCert) else {
+        guard try identity.matches(serverHostname: self.expectedHostname, socketAddress: address) else {
             throw NIOSSLExtraError.failedToValidateHostname(expectedName: self.expectedHostname ?? "<none>")
         }
     }
@@ -218,12 +244,23 @@ internal final class SSLConnection {
         if (rc == 1) { return .complete(rc) }
         
         let result = CNIOBoringSSL_SSL_get_error(ssl, rc)
+        if result == SSL_ERROR_EARLY_DATA_REJECTED {
+            // The server rejected our early data. We carry on with a regular handshake: the
+            // handler resends the rejected writes once it completes.
+            CNIOBoringSSL_SSL_reset_early_data_reject(ssl)
+            return self.doHandshake()
+        }
+        if result == SSL_ERROR_PENDING_CERTIFICATE {
+            // We're waiting for handshake hints: the handler resumes the handshake once they arrive.
+            return .incomplete
+        }
         let error = BoringSSLError.fromSSLGetErrorResult(result)!
         
         switch error {
         case .wantRead,
              .wantWrite,
-             .wantCertificateVerify:
+             .wantCertificateVerify,
+             .wantX509Lookup:
             return .incomplete
         default:
             return .failed(error)
@@ -238,6 +275,7 @@ internal final class SSLConnection {
     /// data from internal buffers: call `consumeDataFromNetwork` before calling this
     /// method.
     func doShutdown() -> AsyncOperationResult<CInt> {
+        self.flushPartialInPlaceRecord()
         CNIOBoringSSL_ERR_clear_error()
         let rc = CNIOBoringSSL_SSL_shutdown(ssl)
         
@@ -267,9 +305,107 @@ internal final class SSLConnection {
     /// peer. It must be immediately followed by an I/O operation, e.g. `readDataFromNetwork`
     /// or `doHandshake` or `doShutdown`.
     func consumeDataFromNetwork(_ data: ByteBuffer) {
+        self.flushPartialInPlaceRecord()
         self.bio!.receiveFromNetwork(buffer: data)
     }
 
+    /// Whether inbound records can currently be decrypted with `readDataInPlace`.
+    ///
+    /// BoringSSL can only decrypt records outside of `SSL_read` once the handshake has completed on a
+    /// TLS 1.2 or earlier connection, and only if it isn't holding any data of its own.
+    var canReadDataInPlace: Bool {
+        guard self.parentContext.configuration.enableInPlaceDecryption,
+              self.parentContext.configuration.renegotiationSupport == .none else {
+            return false
+        }
+        return CNIOBoringSSL_SSL_in_init(self.ssl) == 0 &&
+            CNIOBoringSSL_SSL_version(self.ssl) <= TLS1_2_VERSION &&
+            CNIOBoringSSL_SSL_has_pending(self.ssl) == 0 &&
+            !self.bio!.hasInboundData
+    }
+
+    /// Decrypts the application data records in `ciphertext` in place, without copying them into BoringSSL.
+    ///
+    /// The plaintext of each record is appended to `plaintext` as a slice of `ciphertext`. A trailing incomplete
+    /// record is held until the next call, or passed to BoringSSL if the connection stops reading in place.
+    ///
+    /// `ciphertext` is taken inout so that, when the caller holds the only reference to its storage, the records
+    /// are decrypted in that storage. Otherwise, as when it came from a channel read, they are decrypted in a
+    /// single copy of it.
+    ///
+    /// This method must only be called while `canReadDataInPlace` is true.
+    func readDataInPlace(_ ciphertext: inout ByteBuffer, plaintext: inout [ByteBuffer]) -> AsyncOperationResult<Void> {
+        if var partialRecord = self.partialInPlaceRecord {
+            self.partialInPlaceRecord = nil
+            partialRecord.writeBuffer(&ciphertext)
+            ciphertext = partialRecord
+        }
+
+        // We decrypt every complete record before slicing any of them out: once a slice exists, further
+        // writes to the buffer would trigger a CoW.
+        var records: [(offset: Int, length: Int)] = []
+        var finalResult = CNIOBoringSSLShims_open_record_incomplete
+        var alert: UInt8 = 0
+        let consumed = ciphertext.withUnsafeMutableReadableBytes { buffer -> Int in
+            guard let base = buffer.baseAddress?.assumingMemoryBound(to: UInt8.self) else {
+                return 0
+            }
+            var consumed = 0
+
+            while consumed < buffer.count {
+                var plaintextOffset = 0
+                var plaintextLength = 0
+                var recordLength = 0
+                finalResult = CNIOBoringSSLShims_SSL_open_record(self.ssl, base + consumed, buffer.count - consumed,
+                                                                 &plaintextOffset, &plaintextLength, &recordLength, &alert)
+                switch finalResult {
+                case CNIOBoringSSLShims_open_record_ok:
+                    if plaintextLength > 0 {
+                        records.append((offset: consumed + plaintextOffset, length: plaintextLength))
+                    }
+                    consumed += recordLength
+                case CNIOBoringSSLShims_open_record_discard:
+                    consumed += recordLength
+                case CNIOBoringSSLShims_open_record_close_notify:
+                    consumed += recordLength
+                    return consumed
+                default:
+                    return consumed
+                }
+            }
+            return consumed
+        }
+
+        for record in records {
+            plaintext.append(ciphertext.getSlice(at: ciphertext.readerIndex + record.offset, length: record.length)!)
+        }
+        ciphertext.moveReaderIndex(forwardBy: consumed)
+        if ciphertext.readableBytes > 0 {
+            self.partialInPlaceRecord = ciphertext
+        }
+
+        switch finalResult {
+        case CNIOBoringSSLShims_open_record_close_notify:
+            return .failed(.zeroReturn)
+        case CNIOBoringSSLShims_open_record_error:
+            // Leave the connection in the same state SSL_read would have.
+            if alert != 0 {
+                CNIOBoringSSL_SSL_send_fatal_alert(self.ssl, alert)
+            }
+            return .failed(BoringSSLError.fromSSLGetErrorResult(SSL_ERROR_SSL)!)
+        default:
+            return .complete(())
+        }
+    }
+
+    /// Hands any partial record held for in-place decryption back to BoringSSL.
+    private func flushPartialInPlaceRecord() {
+        if let partialRecord = self.partialInPlaceRecord {
+            self.partialInPlaceRecord = nil
+            self.bio!.receiveFromNetwork(buffer: partialRecord)
+        }
+    }
+
     /// Obtains some encrypted data ready for the network from BoringSSL.
     ///
     /// This call obtains only data that BoringSSL has already written into its send
@@ -328,6 +464,10 @@ internal final class SSLConnection {
             return .complete(0)
         }
 
+        if self.canSealRecordsDirectly {
+            return self.sealRecordsDirectly(&data)
+        }
+
         let writtenBytes = data.withUnsafeReadableBytes { (pointer) -> CInt in
             return CNIOBoringSSL_SSL_write(ssl, pointer.baseAddress, CInt(pointer.count))
         }
@@ -342,6 +482,12 @@ internal final class SSLConnection {
             return .complete(writtenBytes)
         } else {
             let result = CNIOBoringSSL_SSL_get_error(ssl, writtenBytes)
+            if result == SSL_ERROR_EARLY_DATA_REJECTED {
+                // Writing past the early data limit drove the handshake, and the server rejected our
+                // early data. This write has been discarded: the handler will retry it.
+                CNIOBoringSSL_SSL_reset_early_data_reject(ssl)
+                return .incomplete
+            }
             let error = BoringSSLError.fromSSLGetErrorResult(result)!
             
             switch error {
@@ -353,6 +499,198 @@ internal final class SSLConnection {
         }
     }
 
+    /// Whether outbound application data can currently be encrypted with `sealRecordsDirectly`.
+    ///
+    /// Like in-place decryption, BoringSSL only supports this once the handshake has completed on a
+    /// TLS 1.2 or earlier connection. We also leave writes to `SSL_write` once we've sent a close_notify
+    /// or fatal alert, so that it can report the error.
+    var canSealRecordsDirectly: Bool {
+        guard self.parentContext.configuration.enableDirectEncryption else {
+            return false
+        }
+        return CNIOBoringSSL_SSL_in_init(self.ssl) == 0 &&
+            CNIOBoringSSL_SSL_version(self.ssl) <= TLS1_2_VERSION &&
+            CNIOBoringSSL_SSL_get_shutdown(self.ssl) & SSL_SENT_SHUTDOWN == 0
+    }
+
+    /// Encrypts `data` straight into the outbound ciphertext buffer, one record at a time.
+    ///
+    /// `SSL_write` seals records into BoringSSL's own write buffer, which our BIO then copies into the
+    /// outbound buffer. Sealing directly into the outbound buffer avoids that copy.
+    private func sealRecordsDirectly(_ data: inout ByteBuffer) -> AsyncOperationResult<CInt> {
+        CNIOBoringSSL_ERR_clear_error()
+        let bio = self.bio!
+
+        let writtenBytes = data.withUnsafeReadableBytes { plaintext -> Int in
+            var offset = 0
+            while offset < plaintext.count {
+                let chunk = UnsafeRawBufferPointer(rebasing: plaintext[offset..<min(offset + self.maxSendFragment, plaintext.count)])
+                let recordLength = CNIOBoringSSLShims_SSL_sealed_record_len(self.ssl, chunk.count)
+                let sealed = bio.writeOutboundCiphertext(length: recordLength) { record in
+                    return CNIOBoringSSLShims_SSL_seal_record(self.ssl,
+                                                              record.baseAddress!.assumingMemoryBound(to: UInt8.self),
+                                                              record.count,
+                                                              chunk.baseAddress!.assumingMemoryBound(to: UInt8.self),
+                                                              chunk.count) == 1
+                }
+                guard sealed else {
+                    return -1
+                }
+                offset += chunk.count
+            }
+            return offset
+        }
+
+        guard writtenBytes >= 0 else {
+            return .failed(BoringSSLError.fromSSLGetErrorResult(SSL_ERROR_SSL)!)
+        }
+        data.moveReaderIndex(forwardBy: writtenBytes)
+        return .complete(CInt(writtenBytes))
+    }
+
+    /// Seals a single record whose plaintext is the concatenation of `buffers`.
+    ///
+    /// BoringSSL reads each buffer directly and encrypts it into its place in the record body, so the
+    /// plaintext is never gathered into a contiguous buffer first. The buffers' total length must not
+    /// exceed `maxSendFragment`, and this must only be called while `canSealRecordsDirectly` is true.
+    func sealRecordDirectly<Buffers: Sequence>(gathering buffers: Buffers) -> AsyncOperationResult<CInt> where Buffers.Element == ByteBuffer {
+        // BoringSSL needs every buffer's address at once, so we hold a reference to each buffer's
+        // storage until the record has been sealed.
+        self.gatherStorage.removeAll(keepingCapacity: true)
+        self.gatherPointers.removeAll(keepingCapacity: true)
+        self.gatherLengths.removeAll(keepingCapacity: true)
+        defer {
+            self.gatherStorage.forEach { $0.release() }
+            self.gatherStorage.removeAll(keepingCapacity: true)
+        }
+
+        for buffer in buffers where buffer.readableBytes > 0 {
+            buffer.withUnsafeReadableBytesWithStorageManagement { bytes, storage in
+                self.gatherStorage.append(storage.retain())
+                self.gatherPointers.append(bytes.baseAddress!.assumingMemoryBound(to: UInt8.self))
+                self.gatherLengths.append(bytes.count)
+            }
+        }
+
+        let plaintextLength = self.gatherLengths.reduce(0, +)
+        precondition(plaintextLength <= self.maxSendFragment)
+        guard plaintextLength > 0 else {
+            return .complete(0)
+        }
+
+        CNIOBoringSSL_ERR_clear_error()
+        let recordLength = CNIOBoringSSLShims_SSL_sealed_record_len(self.ssl, plaintextLength)
+        let sealed = self.bio!.writeOutboundCiphertext(length: recordLength) { record in
+            return CNIOBoringSSLShims_SSL_seal_record_gather(self.ssl,
+                                                             record.baseAddress!.assumingMemoryBound(to: UInt8.self),
+                                                             record.count,
+                                                             self.gatherPointers,
+                                                             self.gatherLengths,
+                                                             self.gatherPointers.count) == 1
+        }
+
+        guard sealed else {
+            return .failed(BoringSSLError.fromSSLGetErrorResult(SSL_ERROR_SSL)!)
+        }
+        return .complete(CInt(plaintextLength))
+    }
+
+    /// Whether this connection may be handed over to kernel TLS now that its handshake has completed.
+    ///
+    /// Kernel TLS only passes application data to the reader, so we don't offload connections that may still
+    /// need to read handshake messages: TLS 1.3 clients, which receive session tickets after the handshake,
+    /// and connections that allow renegotiation.
+    var mayOffloadToKernel: Bool {
+        #if os(Linux)
+        guard self.parentContext.configuration.enableKernelTLSOffload,
+              self.parentContext.configuration.renegotiationSupport == .none,
+              CNIOBoringSSL_SSL_in_init(self.ssl) == 0,
+              !self.isInEarlyData else {
+            return false
+        }
+
+        switch CNIOBoringSSL_SSL_version(self.ssl) {
+        case TLS1_2_VERSION:
+            return true
+        case TLS1_3_VERSION:
+            return self.role == .server
+        default:
+            return false
+        }
+        #else
+        return false
+        #endif
+    }
+
+    /// Whether the inbound data not yet passed to BoringSSL is made up of whole records, so that once it
+    /// is decrypted the kernel can take over reading from the next record.
+    var inboundDataEndsOnRecordBoundary: Bool {
+        return self.partialInPlaceRecord == nil && self.bio!.inboundDataEndsOnRecordBoundary
+    }
+
+    /// Whether every record received has been decrypted and read, and all the ciphertext BoringSSL has written
+    /// has been taken for the network. Only then do the sequence numbers match what the peer has seen.
+    var isIdleAtRecordBoundary: Bool {
+        return self.partialInPlaceRecord == nil &&
+            CNIOBoringSSL_SSL_has_pending(self.ssl) == 0 &&
+            !self.bio!.hasInboundData &&
+            !self.bio!.hasOutboundData
+    }
+
+    /// Writes out handshake messages that BoringSSL holds back until the next write, such as TLS 1.3 session
+    /// tickets. They are already sealed, so they must be sent before the kernel takes over writing.
+    ///
+    /// - returns: Whether the flush succeeded.
+    func flushPendingHandshakeData() -> Bool {
+        CNIOBoringSSL_ERR_clear_error()
+        defer {
+            CNIOBoringSSL_ERR_clear_error()
+        }
+
+        var empty: UInt8 = 0
+        let rc = CNIOBoringSSL_SSL_write(self.ssl, &empty, 0)
+        let result = CNIOBoringSSL_SSL_get_error(self.ssl, rc)
+
+        // BoringSSL returns 0 from a zero-length write that flushed everything. SSL_get_error has no way to report
+        // that as success, so with nothing on the error queue it reports SSL_ERROR_SYSCALL. Any other result,
+        // including a peer that has already closed, means handshake data may still be held back.
+        return rc == 0 && result == SSL_ERROR_SYSCALL && CNIOBoringSSL_ERR_peek_error() == 0
+    }
+
+    /// The key material and sequence number for reading or writing this connection, in the form kernel TLS
+    /// takes them, or `nil` if the connection's cipher suite cannot be offloaded.
+    func kernelTLSCryptoInfo(forWriting: Bool) -> CNIOBoringSSLShims_kernel_tls_crypto_info? {
+        var info = CNIOBoringSSLShims_kernel_tls_crypto_info()
+        guard CNIOBoringSSLShims_SSL_get_kernel_tls_crypto_info(self.ssl, forWriting ? 1 : 0, &info) == 1 else {
+            return nil
+        }
+        return info
+    }
+
+    /// Whether BoringSSL has written ciphertext that has not yet been taken for the network.
+    var hasOutboundData: Bool {
+        return self.bio!.hasOutboundData
+    }
+
+    /// Serializes this established server connection, so that it can be restored by `applyHandback` in another
+    /// process. Returns `nil` if the connection is not using TLS 1.2 or earlier, or if BoringSSL is holding data
+    /// that it has read but not yet returned.
+    func serializeHandback() -> [UInt8]? {
+        return serializeWithCBB { CNIOBoringSSLShims_SSL_serialize_handback(self.ssl, $0) }
+    }
+
+    /// Restores a connection serialized by `serializeHandback`, in place of calling `setAcceptState`. The
+    /// connection is established by the next call to `doHandshake`.
+    ///
+    /// - returns: Whether the state could be restored.
+    func applyHandback(_ state: [UInt8]) -> Bool {
+        self.role = .server
+        let rc = state.withUnsafeBufferPointer {
+            CNIOBoringSSLShims_SSL_apply_handback(self.ssl, $0.baseAddress, $0.count)
+        }
+        return rc == 1
+    }
+
     /// Returns the protocol negotiated via ALPN, if any. Returns `nil` if no protocol
     /// was negotiated.
     func getAlpnProtocol() -> String? {
@@ -367,6 +705,66 @@ internal final class SSLConnection {
         return String(decoding: UnsafeBufferPointer(start: protoName, count: Int(protoLen)), as: UTF8.self)
     }
 
+    /// Whether the handshake on this connection resumed a previous session.
+    var sessionReused: Bool {
+        return CNIOBoringSSL_SSL_session_reused(self.ssl) == 1
+    }
+
+    /// Whether the server sent a HelloRetryRequest during the handshake on this connection.
+    var usedHelloRetryRequest: Bool {
+        return CNIOBoringSSL_SSL_used_hello_retry_request(self.ssl) == 1
+    }
+
+    /// Whether the handshake has progressed far enough to send (as a client) or receive (as a server)
+    /// early data, but has not yet completed.
+    var isInEarlyData: Bool {
+        return CNIOBoringSSL_SSL_in_early_data(self.ssl) == 1
+    }
+
+    /// Whether the server accepted early data on this connection.
+    var earlyDataAccepted: Bool {
+        return CNIOBoringSSL_SSL_early_data_accepted(self.ssl) == 1
+    }
+
+    /// Whether, as a server, we rejected early data the client offered.
+    var rejectedOfferedEarlyData: Bool {
+        // BoringSSL only distinguishes these reasons once it knows the client offered early data.
+        switch CNIOBoringSSL_SSL_get_early_data_reason(self.ssl) {
+        case ssl_early_data_channel_id,
+             ssl_early_data_alpn_mismatch,
+             ssl_early_data_alps_mismatch,
+             ssl_early_data_ticket_age_skew,
+             ssl_early_data_quic_parameter_mismatch,
+             ssl_early_data_hello_retry_request:
+            return true
+        default:
+            return false
+        }
+    }
+
+    /// Looks up a stored session for the peer this client connection is about to handshake with,
+    /// and offers it for resumption.
+    ///
+    /// Must be called before the handshake begins.
+    func offerStoredSession(remoteAddress: SocketAddress?) {
+        guard self.role == .client, let store = self.parentContext.configuration.clientSessionStore else {
+            return
+        }
+        guard let hostname = self.expectedHostname ?? remoteAddress?.ipAddress else {
+            return
+        }
+
+        let key = NIOSSLClientSessionKey(hostname: hostname,
+                                         port: remoteAddress?.port,
+                                         applicationProtocols: self.parentContext.configuration.applicationProtocols)
+        self.clientSessionKey = key
+
+        if let session = store.session(forKey: key) {
+            // SSL_set_session takes its own reference to the session.
+            CNIOBoringSSL_SSL_set_session(self.ssl, session.ref)
+        }
+    }
+
     /// Get the leaf certificate from the peer certificate chain as a managed object,
     /// if available.
     func getPeerCertificate() -> NIOSSLCertificate? {
@@ -377,6 +775,21 @@ internal final class SSLConnection {
         return NIOSSLCertificate.fromUnsafePointer(takingOwnership: certPtr)
     }
 
+    /// Obtains the identity of the peer leaf certificate, from the certificate identity cache of the
+    /// parent context if it has one.
+    func peerCertificateIdentity() -> CertificateIdentity? {
+        guard let cache = self.parentContext.certificateIdentities,
+              let chain = CNIOBoringSSL_SSL_get0_peer_certificates(self.ssl),
+              CNIOBoringSSL_sk_CRYPTO_BUFFER_num(chain) > 0,
+              let leaf = CNIOBoringSSL_sk_CRYPTO_BUFFER_value(chain, 0) else {
+            return self.getPeerCertificate().map { CertificateIdentity(leafCertificate: $0) }
+        }
+
+        return cache.identity(forCertificate: leaf) {
+            self.getPeerCertificate().map { CertificateIdentity(leafCertificate: $0) }
+        }
+    }
+
     /// Drops persistent connection state.
     ///
     /// Must only be called when the connection is no longer needed. The rest of this object
@@ -405,6 +818,9 @@ internal final class SSLConnection {
     ///
     /// - returns: The unconsumed `ByteBuffer`, if any.
     func extractUnconsumedData() -> ByteBuffer? {
+        if self.bio != nil {
+            self.flushPartialInPlaceRecord()
+        }
         return self.bio?.evacuateInboundData()
     }
     
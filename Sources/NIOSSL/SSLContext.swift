@@ -13,6 +13,7 @@
 //===----------------------------------------------------------------------===//
 
 import NIOCore
+import NIOConcurrencyHelpers
 @_implementationOnly import CNIOBoringSSL
 @_implementationOnly import CNIOBoringSSLShims
 
@@ -123,10 +124,20 @@ private func alpnCallback(ssl: OpaquePointer?,
 ///
 /// - Warning: Avoid creating `NIOSSLContext`s on any `EventLoop` because it does _blocking disk I/O_.
 public final class NIOSSLContext {
-    private let sslContext: OpaquePointer
+    internal let sslContext: OpaquePointer
     private let callbackManager: CallbackManagerProtocol?
     private var keyLogManager: KeyLogCallbackManager?
     internal let configuration: TLSConfiguration
+    internal let sessionCacheHits = NIOAtomic<Int>.makeAtomic(value: 0)
+    internal let sessionCacheMisses = NIOAtomic<Int>.makeAtomic(value: 0)
+    internal let keyExchangeHandshakes = NIOAtomic<Int>.makeAtomic(value: 0)
+    internal let keyExchangeHelloRetryRequests = NIOAtomic<Int>.makeAtomic(value: 0)
+    internal let compressedCertificates = CompressedCertificateCache()
+    internal let verifiedChains: VerifiedChainCache?
+    internal let certificateIdentities: CertificateIdentityCache?
+    internal let trustRootsDirectory: TrustRootsDirectoryIndex?
+    private let credentialsLock = Lock()
+    private var _replacementCredentials: NIOSSLIdentity?
 
     /// Initialize a context that will create multiple connections, all with the same
     /// configuration.
@@ -168,6 +179,12 @@ public final class NIOSSLContext {
         returnCode = CNIOBoringSSL_SSL_CTX_set_cipher_list(context, configuration.cipherSuites)
         precondition(1 == returnCode)
 
+        if configuration.keyExchangeGroups != nil || configuration.predictedKeyShare != nil {
+            try NIOSSLContext.configureKeyExchangeGroups(configuration.keyExchangeGroups,
+                                                         predictedKeyShare: configuration.predictedKeyShare,
+                                                         context: context)
+        }
+
         // On non-Linux platforms, when using the platform default trust roots, we make use of a
         // custom verify callback. If we have also been presented with additional trust roots of
         // type `.file`, we take the opportunity now to load them in memory to avoid doing so
@@ -187,10 +204,12 @@ public final class NIOSSLContext {
         }
 
         // Configure certificate validation
-        try NIOSSLContext.configureCertificateValidation(
+        let trustRootsDirectory = try NIOSSLContext.configureCertificateValidation(
             context: context,
             verification: configuration.certificateVerification,
             trustRoots: configuration.trustRoots,
+            trustStore: configuration.trustStore,
+            trustRootsDirectoryMode: configuration.trustRootsDirectoryMode,
             additionalTrustRoots: configuration.additionalTrustRoots,
             sendCANames: configuration.sendCANameList)
         
@@ -257,6 +276,45 @@ public final class NIOSSLContext {
             NIOSSLContext.setAlpnCallback(context: context)
         }
 
+        if let sessionCache = configuration.serverSessionCache {
+            NIOSSLContext.configureServerSessionCache(sessionCache, context: context)
+        }
+
+        if configuration.sessionTicketKeys != nil {
+            NIOSSLContext.configureSessionTicketKeys(context: context)
+        }
+
+        if configuration.clientSessionStore != nil {
+            NIOSSLContext.configureClientSessionStore(context: context)
+        }
+
+        if configuration.enableEarlyData {
+            CNIOBoringSSL_SSL_CTX_set_early_data_enabled(context, 1)
+        }
+
+        // Always installed, as credentials may be replaced at any time.
+        NIOSSLContext.configureCertificateSelection(context: context)
+
+        if let certificateBufferPool = configuration.certificateBufferPool {
+            NIOSSLContext.configureCertificateBufferPool(context: context, pool: certificateBufferPool)
+        }
+
+        if configuration.handshakeHintsCallback != nil {
+            NIOSSLContext.configureHandshakeHints(context: context)
+        }
+
+        if configuration.verifiedChainCache != nil && configuration.certificateVerification != .none {
+            NIOSSLContext.configureVerifiedChainCache(context: context)
+        }
+
+        if configuration.keySharePool != nil {
+            NIOSSLContext.configureKeySharePool(context: context)
+        }
+
+        if !configuration.certificateCompressionAlgorithms.isEmpty {
+            NIOSSLContext.configureCertificateCompression(configuration.certificateCompressionAlgorithms, context: context)
+        }
+
         // Add a key log callback.
         if let keyLogCallback = configuration.keyLogCallback {
             self.keyLogManager = KeyLogCallbackManager(callback: keyLogCallback)
@@ -267,11 +325,27 @@ public final class NIOSSLContext {
 
         self.sslContext = context
         self.configuration = configuration
+        self.verifiedChains = configuration.verifiedChainCache.map { VerifiedChainCache(configuration: $0) }
+        // Without a buffer pool, no two connections share a certificate buffer, so there would be nothing to reuse.
+        if let verifiedChainCache = configuration.verifiedChainCache, configuration.certificateBufferPool != nil {
+            self.certificateIdentities = CertificateIdentityCache(maximumSize: verifiedChainCache.maximumSize)
+        } else {
+            self.certificateIdentities = nil
+        }
+        self.trustRootsDirectory = trustRootsDirectory
         self.callbackManager = callbackManager
 
         // Always make it possible to get from an SSL_CTX structure back to this.
         let ptrToSelf = Unmanaged.passUnretained(self).toOpaque()
         CNIOBoringSSLShims_SSL_CTX_set_app_data(context, ptrToSelf)
+
+        if let trustRootsDirectory = trustRootsDirectory,
+           case .indexed(reloadInterval: .some(let reloadInterval)) = configuration.trustRootsDirectoryMode {
+            // Removed roots must stop being trusted, so results verified against them are discarded.
+            trustRootsDirectory.watch(every: reloadInterval) { [weak self] in
+                self?.invalidateVerifiedChainCache()
+            }
+        }
     }
 
     /// Initialize a context that will create multiple connections, all with the same
@@ -308,6 +382,39 @@ public final class NIOSSLContext {
         try self.init(configuration: configuration, callbackManager: manager)
     }
 
+    /// Replace the certificate chain and private key presented by connections from this context.
+    ///
+    /// Handshakes that start after this call use the new credentials. Established connections, and sessions
+    /// issued under the old credentials, are unaffected and can still be resumed. This is much cheaper than
+    /// creating a new `NIOSSLContext`, which reloads the trust roots and starts with an empty session cache,
+    /// and may be called from any thread.
+    ///
+    /// For server-side contexts with a `certificateStore`, the new credentials replace the configured
+    /// `certificateChain` and `privateKey`, which are used when the client's server name is not in the store.
+    ///
+    /// - parameters:
+    ///     - certificateChain: The certificate chain to present, leaf first. Must not be empty.
+    ///     - privateKey: The private key for the leaf certificate.
+    /// - throws: `NIOSSLError.failedToLoadPrivateKey` if `privateKey` does not match the leaf certificate.
+    public func setCredentials(certificateChain: [NIOSSLCertificate], privateKey: NIOSSLPrivateKey) throws {
+        let identity = try NIOSSLIdentity(certificateChain: certificateChain, privateKey: privateKey)
+        self.setCredentials(identity)
+    }
+
+    /// Replace the certificate chain and private key presented by connections from this context with `identity`.
+    ///
+    /// See `setCredentials(certificateChain:privateKey:)`.
+    public func setCredentials(_ identity: NIOSSLIdentity) {
+        self.credentialsLock.withLockVoid {
+            self._replacementCredentials = identity
+        }
+    }
+
+    /// The credentials most recently set with `setCredentials`, if any.
+    internal var replacementCredentials: NIOSSLIdentity? {
+        return self.credentialsLock.withLock { self._replacementCredentials }
+    }
+
     /// Create a new connection object with the configuration from this
     /// context.
     internal func createConnection() -> SSLConnection? {
@@ -321,6 +428,10 @@ public final class NIOSSLContext {
         #if os(macOS) || os(iOS) || os(watchOS) || os(tvOS)
         switch self.configuration.trustRoots {
         case .some(.default), .none:
+            // A trust store replaces the platform default trust roots.
+            guard self.configuration.trustStore == nil else {
+                break
+            }
             conn.setCustomVerificationCallback(CustomVerifyManager(callback: {
                 do {
                     conn.performSecurityFrameworkValidation(promise: $0, peerCertificates: try conn.getPeerCertificatesAsSecCertificate())
@@ -445,7 +556,9 @@ extension NIOSSLContext {
 
 // Configuring certificate verification
 extension NIOSSLContext {
-    private static func configureCertificateValidation(context: OpaquePointer, verification: CertificateVerification, trustRoots: NIOSSLTrustRoots?, additionalTrustRoots: [NIOSSLAdditionalTrustRoots], sendCANames: Bool) throws {
+    private static func configureCertificateValidation(context: OpaquePointer, verification: CertificateVerification, trustRoots: NIOSSLTrustRoots?, trustStore: NIOSSLTrustStore?, trustRootsDirectoryMode: NIOSSLTrustRootsDirectoryMode, additionalTrustRoots: [NIOSSLAdditionalTrustRoots], sendCANames: Bool) throws -> TrustRootsDirectoryIndex? {
+        var trustRootsDirectory: TrustRootsDirectoryIndex? = nil
+
         // If validation is turned on, set the trust roots and turn on cert validation.
         switch verification {
         case .fullVerification, .noHostnameVerification:
@@ -462,7 +575,16 @@ extension NIOSSLContext {
                 case .default:
                     try NIOSSLContext.platformDefaultConfiguration(context: context)
                 case .file(let path):
-                    try NIOSSLContext.loadVerifyLocations(path, context: context, sendCANames: sendCANames)
+                    if case .indexed = trustRootsDirectoryMode,
+                       FileSystemObject.pathType(path: path) == .directory {
+                        trustRootsDirectory = try TrustRootsDirectoryIndex(path: path)
+                        NIOSSLContext.configureTrustStore(context: context)
+                        if sendCANames {
+                            try NIOSSLContext.addCACertificateNamesFromDirectory(path, context: context)
+                        }
+                    } else {
+                        try NIOSSLContext.loadVerifyLocations(path, context: context, sendCANames: sendCANames)
+                    }
                 case .certificates(let certs):
                     for cert in certs {
                         try NIOSSLContext.addRootCertificate(cert, context: context)
@@ -473,11 +595,17 @@ extension NIOSSLContext {
                     }
                 }
             }
-            try configureTrustRoots(trustRoots: trustRoots ?? .default)
+            if trustStore != nil {
+                NIOSSLContext.configureTrustStore(context: context)
+            } else {
+                try configureTrustRoots(trustRoots: trustRoots ?? .default)
+            }
             try additionalTrustRoots.forEach { try configureTrustRoots(trustRoots: .init(from: $0)) }
         default:
             break
         }
+
+        return trustRootsDirectory
     }
     
     private static func addCACertificateNameToList(context: OpaquePointer, certificate: NIOSSLCertificate) throws {
@@ -514,16 +642,20 @@ extension NIOSSLContext {
             // This could be from a location like /etc/ssl/cert.pem as an example.
             CNIOBoringSSL_SSL_CTX_set_client_CA_list(context, CNIOBoringSSL_SSL_load_client_CA_file(path))
         } else if sendCANames, isDirectory {
-            // Match the c_rehash directory format and load the certificate based on this criteria.
-            let certificateFilePaths = try DirectoryContents(path: path).filter {
-                try self._isRehashFormat(path: $0)
-            }
-            // Load only the certificates that resolve to an existing certificate in the directory.
-            for symPath in certificateFilePaths {
-                // c_rehash only support pem files.
-                let cert = try NIOSSLCertificate(file: symPath, format: .pem)
-                try addCACertificateNameToList(context: context, certificate: cert)
-            }
+            try self.addCACertificateNamesFromDirectory(path, context: context)
+        }
+    }
+
+    private static func addCACertificateNamesFromDirectory(_ path: String, context: OpaquePointer) throws {
+        // Match the c_rehash directory format and load the certificate based on this criteria.
+        let certificateFilePaths = try DirectoryContents(path: path).filter {
+            try self._isRehashFormat(path: $0)
+        }
+        // Load only the certificates that resolve to an existing certificate in the directory.
+        for symPath in certificateFilePaths {
+            // c_rehash only support pem files.
+            let cert = try NIOSSLCertificate(file: symPath, format: .pem)
+            try addCACertificateNameToList(context: context, certificate: cert)
         }
     }
 
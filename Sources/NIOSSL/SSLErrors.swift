@@ -191,6 +191,15 @@ extension NIOSSLExtraError {
         case serverHostnameImpossibleToMatch
         case cannotUseIPAddressInSNI
         case invalidSNIHostname
+        case invalidSessionData
+        case invalidSessionTicketKey
+        case cannotUnwrapOffloadedConnection
+        case invalidCertificateStoreName
+        case invalidBatchSigningResult
+        case failedToGenerateHandshakeHints
+        case cannotExportConnection
+        case invalidConnectionHandback
+        case invalidPredictedKeyShare
     }
 }
 
@@ -216,6 +225,33 @@ extension NIOSSLExtraError {
     /// - hostname contains the `0` unicode scalar (which would be encoded as the `0` byte which is unsupported).
     public static let invalidSNIHostname = NIOSSLExtraError(baseError: .invalidSNIHostname, description: nil)
 
+    /// The serialized TLS session could not be parsed.
+    public static let invalidSessionData = NIOSSLExtraError(baseError: .invalidSessionData, description: nil)
+
+    /// The session ticket key material was not a whole number of 48 byte keys.
+    public static let invalidSessionTicketKey = NIOSSLExtraError(baseError: .invalidSessionTicketKey, description: nil)
+
+    /// TLS cannot be removed from a connection that has been offloaded to kernel TLS.
+    public static let cannotUnwrapOffloadedConnection = NIOSSLExtraError(baseError: .cannotUnwrapOffloadedConnection, description: nil)
+
+    /// A server name given to a `NIOSSLCertificateStore` was neither a DNS name nor a wildcard DNS name.
+    public static let invalidCertificateStoreName = NIOSSLExtraError(baseError: .invalidCertificateStoreName, description: nil)
+
+    /// A `NIOSSLBatchSigningKey` returned a different number of results than there were requests in the batch.
+    public static let invalidBatchSigningResult = NIOSSLExtraError(baseError: .invalidBatchSigningResult, description: nil)
+
+    /// Handshake hints could not be computed for the ClientHello in a `NIOSSLHandshakeHintsRequest`.
+    public static let failedToGenerateHandshakeHints = NIOSSLExtraError(baseError: .failedToGenerateHandshakeHints, description: nil)
+
+    /// The connection could not be exported, as it is not an established TLS 1.2 server connection that is idle.
+    public static let cannotExportConnection = NIOSSLExtraError(baseError: .cannotExportConnection, description: nil)
+
+    /// The state in a `NIOSSLConnectionHandback` could not be restored.
+    public static let invalidConnectionHandback = NIOSSLExtraError(baseError: .invalidConnectionHandback, description: nil)
+
+    /// The `predictedKeyShare` of a `TLSConfiguration` was not one of its `keyExchangeGroups`.
+    public static let invalidPredictedKeyShare = NIOSSLExtraError(baseError: .invalidPredictedKeyShare, description: nil)
+
     @inline(never)
     internal static func failedToValidateHostname(expectedName: String) -> NIOSSLExtraError {
         let description = "Couldn't find \(expectedName) in certificate from peer"
@@ -233,6 +269,35 @@ extension NIOSSLExtraError {
         let description = "IP addresses cannot validly be used for Server Name Indication, got \(ipAddress)"
         return NIOSSLExtraError(baseError: .cannotUseIPAddressInSNI, description: description)
     }
+
+    @inline(never)
+    internal static func invalidSessionTicketKey(length: Int) -> NIOSSLExtraError {
+        let description = "Session ticket keys must be \(NIOSSLSessionTicketKey.length) bytes long, got \(length) bytes"
+        return NIOSSLExtraError(baseError: .invalidSessionTicketKey, description: description)
+    }
+
+    @inline(never)
+    internal static func invalidCertificateStoreName(serverName: String) -> NIOSSLExtraError {
+        let description = "\(serverName) is not a valid server name for a certificate store"
+        return NIOSSLExtraError(baseError: .invalidCertificateStoreName, description: description)
+    }
+
+    @inline(never)
+    internal static func invalidBatchSigningResult(expected: Int, actual: Int) -> NIOSSLExtraError {
+        let description = "Expected \(expected) results from batch signing, got \(actual)"
+        return NIOSSLExtraError(baseError: .invalidBatchSigningResult, description: description)
+    }
+
+    @inline(never)
+    internal static func cannotExportConnection(reason: String) -> NIOSSLExtraError {
+        return NIOSSLExtraError(baseError: .cannotExportConnection, description: reason)
+    }
+
+    @inline(never)
+    internal static func invalidPredictedKeyShare(groupID: UInt16) -> NIOSSLExtraError {
+        let description = "The predicted key share for group \(groupID) is not one of the key exchange groups"
+        return NIOSSLExtraError(baseError: .invalidPredictedKeyShare, description: description)
+    }
 }
 
 
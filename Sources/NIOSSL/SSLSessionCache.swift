@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+@_implementationOnly import CNIOBoringSSL
+
+/// Configuration for the in-memory session cache used by server-side `NIOSSLContext`s.
+///
+/// When a client reconnects and offers a session that is present in the cache, the server can resume that
+/// session instead of performing a full handshake, avoiding the key exchange and signature operations.
+public struct NIOSSLServerSessionCacheConfiguration: Hashable {
+    /// The maximum number of sessions to hold in the cache. Once the cache is full, the least recently used
+    /// sessions are evicted. A value of `0` disables the session cache entirely.
+    public var maximumSize: Int
+
+    /// The amount of time for which a cached session may be resumed. Applies to both session IDs and
+    /// TLS 1.3 pre-shared keys. The resolution is one second.
+    public var timeout: TimeAmount
+
+    /// Create a new session cache configuration.
+    ///
+    /// - parameters:
+    ///     - maximumSize: The maximum number of sessions to cache. Defaults to 20480, BoringSSL's default.
+    ///     - timeout: How long a cached session remains resumable. Defaults to 2 hours.
+    public init(maximumSize: Int = 20480, timeout: TimeAmount = .hours(2)) {
+        precondition(maximumSize >= 0, "maximumSize must not be negative")
+        precondition(timeout.nanoseconds > 0, "timeout must be positive")
+        self.maximumSize = maximumSize
+        self.timeout = timeout
+    }
+
+    /// A configuration that disables the server-side session cache.
+    public static let disabled = NIOSSLServerSessionCacheConfiguration(maximumSize: 0)
+}
+
+/// A snapshot of the session cache counters of a `NIOSSLContext`.
+public struct NIOSSLSessionCacheStatistics: Hashable {
+    /// The number of completed handshakes that resumed a previous session.
+    ///
+    /// This includes sessions resumed from session tickets as well as from the in-memory cache.
+    public var hits: Int
+
+    /// The number of completed handshakes that performed a full handshake.
+    public var misses: Int
+
+    /// The number of sessions currently held in the in-memory session cache.
+    public var cachedSessions: Int
+
+    public init(hits: Int, misses: Int, cachedSessions: Int) {
+        self.hits = hits
+        self.misses = misses
+        self.cachedSessions = cachedSessions
+    }
+}
+
+extension NIOSSLContext {
+    /// Applies the server-side session cache configuration to a `SSL_CTX`.
+    internal static func configureServerSessionCache(_ configuration: NIOSSLServerSessionCacheConfiguration,
+                                                     context: OpaquePointer) {
+        guard configuration.maximumSize > 0 else {
+            CNIOBoringSSL_SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_OFF)
+            return
+        }
+
+        // BoringSSL treats a cache size of zero as unbounded, so we never pass that through.
+        CNIOBoringSSL_SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_SERVER)
+        CNIOBoringSSL_SSL_CTX_sess_set_cache_size(context, UInt(configuration.maximumSize))
+
+        let timeoutSeconds = UInt32(clamping: max(configuration.timeout.nanoseconds / 1_000_000_000, 1))
+        CNIOBoringSSL_SSL_CTX_set_timeout(context, timeoutSeconds)
+        CNIOBoringSSL_SSL_CTX_set_session_psk_dhe_timeout(context, timeoutSeconds)
+    }
+}
+
+extension NIOSSLContext {
+    /// The current session cache counters for this context.
+    ///
+    /// Hits and misses are counted for every connection created from this context that completes a handshake.
+    public var sessionCacheStatistics: NIOSSLSessionCacheStatistics {
+        return NIOSSLSessionCacheStatistics(hits: self.sessionCacheHits.load(),
+                                            misses: self.sessionCacheMisses.load(),
+                                            cachedSessions: Int(CNIOBoringSSL_SSL_CTX_sess_number(self.sslContext)))
+    }
+
+    /// Records the outcome of a completed handshake in the session cache counters.
+    internal func recordHandshakeCompletion(sessionReused: Bool) {
+        if sessionReused {
+            self.sessionCacheHits.add(1)
+        } else {
+            self.sessionCacheMisses.add(1)
+        }
+    }
+}
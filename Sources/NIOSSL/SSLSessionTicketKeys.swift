@@ -0,0 +1,244 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+import NIOConcurrencyHelpers
+@_implementationOnly import CNIOBoringSSL
+@_implementationOnly import CNIOBoringSSLShims
+
+#if os(macOS) || os(iOS) || os(watchOS) || os(tvOS)
+import Darwin.C
+#elseif os(Linux) || os(FreeBSD) || os(Android)
+import Glibc
+#else
+#error("unsupported os")
+#endif
+
+/// A key used to encrypt and authenticate TLS session tickets.
+///
+/// A ticket key is 48 bytes of secret material: a 16 byte key name, a 16 byte HMAC-SHA256 key and a 16 byte
+/// AES-128 key. This is the same layout as used by BoringSSL's `SSL_CTX_set_tlsext_ticket_keys` and by
+/// nginx's `ssl_session_ticket_key` files.
+public struct NIOSSLSessionTicketKey: Hashable {
+    /// The length of a serialized ticket key.
+    public static let length = 48
+
+    /// The public name of this key, used to select the key when decrypting a ticket.
+    public let name: [UInt8]
+
+    internal let hmacKey: [UInt8]
+
+    internal let aesKey: [UInt8]
+
+    /// Create a ticket key from its 48 byte serialized form.
+    ///
+    /// - throws: `NIOSSLExtraError.invalidSessionTicketKey` if `bytes` is not 48 bytes long.
+    public init<Bytes: Collection>(bytes: Bytes) throws where Bytes.Element == UInt8 {
+        let bytes = Array(bytes)
+        guard bytes.count == NIOSSLSessionTicketKey.length else {
+            throw NIOSSLExtraError.invalidSessionTicketKey(length: bytes.count)
+        }
+        self.name = Array(bytes[0..<16])
+        self.hmacKey = Array(bytes[16..<32])
+        self.aesKey = Array(bytes[32..<48])
+    }
+
+    /// Generate a new random ticket key.
+    public static func random() -> NIOSSLSessionTicketKey {
+        var bytes = [UInt8](repeating: 0, count: NIOSSLSessionTicketKey.length)
+        let rc = bytes.withUnsafeMutableBufferPointer {
+            CNIOBoringSSL_RAND_bytes($0.baseAddress, $0.count)
+        }
+        precondition(rc == 1, "Unable to generate random session ticket key")
+        return try! NIOSSLSessionTicketKey(bytes: bytes)
+    }
+}
+
+/// A set of session ticket keys used by a server-side `NIOSSLContext`.
+///
+/// New tickets are always encrypted with the primary key. Tickets encrypted with any of the secondary keys are
+/// still accepted, and are re-issued under the primary key. By loading the same keys into each process of a
+/// load-balanced fleet, clients can resume their sessions regardless of which process they connect to.
+///
+/// Keys may be changed at any time, and changes apply to all contexts using the key ring. This object is thread-safe.
+///
+/// - warning: Compromise of a ticket key allows an attacker to decrypt any session resumed with it. Keys must be
+///     rotated regularly to preserve forward secrecy.
+public final class NIOSSLSessionTicketKeyRing {
+    private let lock = Lock()
+    private var _primary: NIOSSLSessionTicketKey
+    private var _secondaries: [NIOSSLSessionTicketKey]
+
+    /// Create a new key ring.
+    ///
+    /// - parameters:
+    ///     - primary: The key used to encrypt new tickets.
+    ///     - secondaries: Additional keys accepted when decrypting tickets. Defaults to none.
+    public init(primary: NIOSSLSessionTicketKey, secondaries: [NIOSSLSessionTicketKey] = []) {
+        self._primary = primary
+        self._secondaries = secondaries
+    }
+
+    /// Create a new key ring from a file of concatenated 48 byte keys. The first key in the file becomes the
+    /// primary key, the remainder become secondary keys.
+    ///
+    /// - warning: This performs blocking disk I/O.
+    public convenience init(file path: String) throws {
+        let (primary, secondaries) = try NIOSSLSessionTicketKeyRing.readKeys(fromFile: path)
+        self.init(primary: primary, secondaries: secondaries)
+    }
+
+    /// The key used to encrypt new tickets.
+    public var primary: NIOSSLSessionTicketKey {
+        return self.lock.withLock { self._primary }
+    }
+
+    /// The keys, other than the primary, that are accepted when decrypting tickets.
+    public var secondaries: [NIOSSLSessionTicketKey] {
+        return self.lock.withLock { self._secondaries }
+    }
+
+    /// Replace all the keys in the ring.
+    public func setKeys(primary: NIOSSLSessionTicketKey, secondaries: [NIOSSLSessionTicketKey] = []) {
+        self.lock.withLockVoid {
+            self._primary = primary
+            self._secondaries = secondaries
+        }
+    }
+
+    /// Make `newPrimary` the primary key. The previous primary key becomes the first secondary key, and
+    /// only the `retainingSecondaries` most recent secondary keys are kept.
+    public func rotate(to newPrimary: NIOSSLSessionTicketKey, retainingSecondaries: Int = 1) {
+        precondition(retainingSecondaries >= 0, "retainingSecondaries must not be negative")
+        self.lock.withLockVoid {
+            self._secondaries.insert(self._primary, at: 0)
+            self._secondaries.removeLast(max(self._secondaries.count - retainingSecondaries, 0))
+            self._primary = newPrimary
+        }
+    }
+
+    /// Replace all the keys in the ring with those stored in `path`, in the format accepted by `init(file:)`.
+    ///
+    /// - warning: This performs blocking disk I/O.
+    public func reload(fromFile path: String) throws {
+        let (primary, secondaries) = try NIOSSLSessionTicketKeyRing.readKeys(fromFile: path)
+        self.setKeys(primary: primary, secondaries: secondaries)
+    }
+
+    /// Rotate to a freshly generated random key every `interval`, keeping the previous primary as a secondary.
+    ///
+    /// Processes rotating independently do not share keys: fleets that need cross-process resumption should
+    /// instead distribute keys out of band and call `reload(fromFile:)` or `rotate(to:)`.
+    ///
+    /// - returns: The `RepeatedTask` performing the rotation. Cancel it to stop rotating.
+    @discardableResult
+    public func scheduleRotation(every interval: TimeAmount, on eventLoop: EventLoop) -> RepeatedTask {
+        return eventLoop.scheduleRepeatedTask(initialDelay: interval, delay: interval) { _ in
+            self.rotate(to: .random())
+        }
+    }
+
+    /// Find the key to use for a ticket with the given key name, and whether that key is the primary.
+    fileprivate func key(named name: UnsafeRawBufferPointer) -> (key: NIOSSLSessionTicketKey, isPrimary: Bool)? {
+        return self.lock.withLock {
+            if self._primary.name.elementsEqual(name) {
+                return (self._primary, true)
+            }
+            return self._secondaries.first(where: { $0.name.elementsEqual(name) }).map { ($0, false) }
+        }
+    }
+
+    private static func readKeys(fromFile path: String) throws -> (NIOSSLSessionTicketKey, [NIOSSLSessionTicketKey]) {
+        let bytes = try readFile(path: path)
+        guard bytes.count > 0, bytes.count % NIOSSLSessionTicketKey.length == 0 else {
+            throw NIOSSLExtraError.invalidSessionTicketKey(length: bytes.count)
+        }
+
+        let keys = try stride(from: 0, to: bytes.count, by: NIOSSLSessionTicketKey.length).map {
+            try NIOSSLSessionTicketKey(bytes: bytes[$0..<($0 + NIOSSLSessionTicketKey.length)])
+        }
+        return (keys.first!, Array(keys.dropFirst()))
+    }
+}
+
+/// Reads the entire contents of a file.
+private func readFile(path: String) throws -> [UInt8] {
+    let fileObject = try Posix.fopen(file: path, mode: "rb")
+    defer {
+        fclose(fileObject)
+    }
+
+    var contents = [UInt8]()
+    var buffer = [UInt8](repeating: 0, count: 1024)
+    while true {
+        let read = buffer.withUnsafeMutableBytes { fread($0.baseAddress, 1, $0.count, fileObject) }
+        contents.append(contentsOf: buffer[0..<read])
+        if read < buffer.count {
+            break
+        }
+    }
+    return contents
+}
+
+extension NIOSSLContext {
+    /// Installs the callback that encrypts and decrypts session tickets using a key ring.
+    internal static func configureSessionTicketKeys(context: OpaquePointer) {
+        CNIOBoringSSL_SSL_CTX_set_tlsext_ticket_key_cb(context) { ssl, keyName, iv, cipherContext, hmacContext, encrypt in
+            guard let ssl = ssl, let keyName = keyName, let iv = iv else {
+                return -1
+            }
+
+            let parentCtx = CNIOBoringSSL_SSL_get_SSL_CTX(ssl)!
+            let parentPtr = CNIOBoringSSLShims_SSL_CTX_get_app_data(parentCtx)!
+            let parentSwiftContext: NIOSSLContext = Unmanaged.fromOpaque(parentPtr).takeUnretainedValue()
+            guard let keyRing = parentSwiftContext.configuration.sessionTicketKeys else {
+                return -1
+            }
+
+            let ivLength = Int(CNIOBoringSSL_EVP_CIPHER_iv_length(CNIOBoringSSL_EVP_aes_128_cbc()))
+            let key: NIOSSLSessionTicketKey
+            let result: CInt
+
+            if encrypt == 1 {
+                key = keyRing.primary
+                result = 1
+                key.name.withUnsafeBufferPointer {
+                    keyName.assign(from: $0.baseAddress!, count: $0.count)
+                }
+                guard CNIOBoringSSL_RAND_bytes(iv, ivLength) == 1 else {
+                    return -1
+                }
+            } else {
+                guard let found = keyRing.key(named: UnsafeRawBufferPointer(start: keyName, count: Int(SSL_TICKET_KEY_NAME_LEN))) else {
+                    // Unknown key: fall back to a full handshake.
+                    return 0
+                }
+                key = found.key
+                // Tickets decrypted with a secondary key are renewed under the primary.
+                result = found.isPrimary ? 1 : 2
+            }
+
+            let hmacRC = key.hmacKey.withUnsafeBufferPointer {
+                CNIOBoringSSL_HMAC_Init_ex(hmacContext, $0.baseAddress, $0.count, CNIOBoringSSL_EVP_sha256(), nil)
+            }
+            let cipherRC = key.aesKey.withUnsafeBufferPointer {
+                CNIOBoringSSL_EVP_CipherInit_ex(cipherContext, CNIOBoringSSL_EVP_aes_128_cbc(), nil, $0.baseAddress, iv, encrypt)
+            }
+            guard hmacRC == 1, cipherRC == 1 else {
+                return -1
+            }
+            return result
+        }
+    }
+}
@@ -306,6 +306,114 @@ public struct TLSConfiguration {
     /// This instructs the client which identities can be used by evaluating what CA the identity certificate was issued from.
     public var sendCANameList: Bool
 
+    /// Configuration for the server-side in-memory session cache. If `nil`, BoringSSL's default
+    /// session cache settings are used. Has no effect on client-side contexts.
+    public var serverSessionCache: NIOSSLServerSessionCacheConfiguration?
+
+    /// A store used by client-side contexts to save sessions issued by servers and offer them on later
+    /// connections to the same peer. If `nil`, clients never resume sessions. Has no effect on server-side contexts.
+    public var clientSessionStore: NIOSSLClientSessionStore?
+
+    /// The keys used by server-side contexts to encrypt and decrypt session tickets. If `nil`, each context
+    /// uses its own randomly generated, automatically rotated key. Has no effect on client-side contexts.
+    public var sessionTicketKeys: NIOSSLSessionTicketKeyRing?
+
+    /// Whether to use TLS 1.3 early data ("0-RTT"). Clients send writes flushed before the handshake completes
+    /// as early data when resuming a session that allows it, which requires a `clientSessionStore`. Servers
+    /// issue sessions that allow early data, and accept it when offered. See `NIOSSLEarlyDataEvent`.
+    ///
+    /// - warning: Early data is not protected against replay. Only enable this for application protocols that
+    ///     can tolerate it.
+    public var enableEarlyData: Bool
+
+    /// Whether to decrypt inbound records in place, rather than copying them through BoringSSL. The channel
+    /// still holds each buffer it reads, so the handler decrypts a single copy of the received ciphertext
+    /// instead of the two copies BoringSSL makes: into its read buffer, and of the plaintext out of it.
+    /// Application data is then delivered as slices of that copy, one per TLS record, which keeps the copy
+    /// alive for as long as the slices are held.
+    ///
+    /// This only applies to connections that negotiate TLS 1.2 or earlier with `renegotiationSupport` set to
+    /// `.none`. Other connections are unaffected.
+    public var enableInPlaceDecryption: Bool
+
+    /// Whether to encrypt outbound application data directly into the buffers written to the network, rather
+    /// than through BoringSSL's write buffer. This saves a copy of every byte written. Small writes that are
+    /// packed into one record are encrypted straight from their own buffers, rather than copied together first.
+    ///
+    /// This only applies to connections that negotiate TLS 1.2 or earlier. Other connections are unaffected.
+    public var enableDirectEncryption: Bool
+
+    /// Configuration for adaptive record sizing, where connections send small records until they have warmed up.
+    /// If `nil`, all records are sent at the maximum size.
+    public var dynamicRecordSizing: NIOSSLDynamicRecordSizing?
+
+    /// Whether to hand record encryption and decryption over to the kernel once the handshake completes. When
+    /// this succeeds, `NIOSSLHandler` passes reads and writes through unchanged, so the channel can also write
+    /// `FileRegion`s, which the kernel sends with `sendfile` and encrypts without copying them into user space.
+    ///
+    /// This requires Linux with the `tls` kernel module loaded, and a connection using an AES-GCM or
+    /// ChaCha20-Poly1305 cipher suite. For TLS 1.3 it only applies to servers, as clients must be able to read
+    /// post-handshake messages. Connections that cannot be offloaded carry on as normal.
+    ///
+    /// - warning: Once a connection is offloaded, it can no longer send or receive TLS alerts. It is closed without
+    ///     sending CLOSE_NOTIFY, cannot be unwrapped, and any record other than application data, such as a
+    ///     TLS 1.3 `KeyUpdate`, causes a read error.
+    public var enableKernelTLSOffload: Bool
+
+    /// A store of certificate chains and private keys from which server-side contexts pick the identity for each
+    /// connection, based on the server name the client sends using SNI. Connections whose server name is not in
+    /// the store use `certificateChain` and `privateKey`. Has no effect on client-side contexts.
+    public var certificateStore: NIOSSLCertificateStore?
+
+    /// A callback that server-side contexts use to choose the identity for connections whose server name is not in
+    /// the `certificateStore`, suspending the handshake until it completes. Has no effect on client-side contexts.
+    public var certificateSelectionCallback: NIOSSLCertificateSelectionCallback?
+
+    /// A callback that server-side contexts use to obtain handshake hints from a worker holding the private key,
+    /// which lets the worker perform the key share and signature for TLS 1.3 handshakes. Connections whose hints
+    /// do not apply fall back to `privateKey`. Has no effect on client-side contexts.
+    public var handshakeHintsCallback: NIOSSLHandshakeHintsCallback?
+
+    /// The algorithms with which certificate chains may be compressed in TLS 1.3 handshakes, in order of preference.
+    /// Servers compress their chain with the first of these the client also supports, compressing each chain once
+    /// per context. Clients offer these algorithms, and decompress the server's chain with them. Algorithms whose
+    /// `isAvailable` is false are left out, and repeated algorithms are only used at their first position.
+    public var certificateCompressionAlgorithms: [NIOSSLCertificateCompressionAlgorithm]
+
+    /// The groups that may be used for key exchange, in order of preference. Passing nil means that BoringSSL's
+    /// default list will be used, which prefers X25519.
+    public var keyExchangeGroups: [NIOSSLKeyExchangeGroup]?
+
+    /// The group for which clients send a key share in their ClientHello. It must be one of `keyExchangeGroups`, and
+    /// is offered ahead of the others. When nil, clients predict the first of `keyExchangeGroups`. Creating a context
+    /// with any other group throws `NIOSSLExtraError.invalidPredictedKeyShare`.
+    ///
+    /// Servers that do not support the predicted group send a HelloRetryRequest, costing a round trip. The
+    /// `NIOSSLContext.keyExchangeStatistics` count how often this happens. Has no effect on server-side contexts.
+    public var predictedKeyShare: NIOSSLKeyExchangeGroup?
+
+    /// A pool of precomputed ephemeral key pairs from which handshakes take their key shares, instead of generating
+    /// them on the event loop.
+    public var keySharePool: NIOSSLKeySharePool?
+
+    /// Configuration for remembering the peer certificate chains that pass verification, so that repeat peers are
+    /// not verified again. When nil, every chain is verified. Has no effect unless `certificateVerification` is
+    /// enabled.
+    public var verifiedChainCache: NIOSSLVerifiedChainCacheConfiguration?
+
+    /// A trust store, shared with other contexts, to use in place of `trustRoots`. When set, `trustRoots` is
+    /// ignored, and `additionalTrustRoots` are trusted in addition to the roots in the store. Roots in the store are
+    /// not sent in the CA name list.
+    public var trustStore: NIOSSLTrustStore?
+
+    /// How to find trust roots when `trustRoots` is a directory. Defaults to looking them up in the directory
+    /// during each verification.
+    public var trustRootsDirectoryMode: NIOSSLTrustRootsDirectoryMode
+
+    /// A pool, shared with other contexts, in which the certificates received by connections are interned. When
+    /// nil, each connection holds its own copy of its peer's certificates.
+    public var certificateBufferPool: NIOSSLCertificateBufferPool?
+
     private init(cipherSuiteValues: [NIOTLSCipher] = [],
                  cipherSuites: String = defaultCipherSuites,
                  verifySignatureAlgorithms: [SignatureAlgorithm]?,
@@ -321,7 +429,26 @@ public struct TLSConfiguration {
                  keyLogCallback: NIOSSLKeyLogCallback?,
                  renegotiationSupport: NIORenegotiationSupport,
                  additionalTrustRoots: [NIOSSLAdditionalTrustRoots],
-                 sendCANameList: Bool = false) {
+                 sendCANameList: Bool = false,
+                 serverSessionCache: NIOSSLServerSessionCacheConfiguration? = nil,
+                 clientSessionStore: NIOSSLClientSessionStore? = nil,
+                 sessionTicketKeys: NIOSSLSessionTicketKeyRing? = nil,
+                 enableEarlyData: Bool = false,
+                 enableInPlaceDecryption: Bool = false,
+                 enableDirectEncryption: Bool = false,
+                 dynamicRecordSizing: NIOSSLDynamicRecordSizing? = nil,
+                 enableKernelTLSOffload: Bool = false,
+                 certificateStore: NIOSSLCertificateStore? = nil,
+                 certificateSelectionCallback: NIOSSLCertificateSelectionCallback? = nil,
+                 handshakeHintsCallback: NIOSSLHandshakeHintsCallback? = nil,
+                 certificateCompressionAlgorithms: [NIOSSLCertificateCompressionAlgorithm] = [],
+                 keyExchangeGroups: [NIOSSLKeyExchangeGroup]? = nil,
+                 predictedKeyShare: NIOSSLKeyExchangeGroup? = nil,
+                 keySharePool: NIOSSLKeySharePool? = nil,
+                 verifiedChainCache: NIOSSLVerifiedChainCacheConfiguration? = nil,
+                 trustStore: NIOSSLTrustStore? = nil,
+                 trustRootsDirectoryMode: NIOSSLTrustRootsDirectoryMode = .lookupOnDemand,
+                 certificateBufferPool: NIOSSLCertificateBufferPool? = nil) {
         self.cipherSuites = cipherSuites
         self.verifySignatureAlgorithms = verifySignatureAlgorithms
         self.signingSignatureAlgorithms = signingSignatureAlgorithms
@@ -336,6 +463,25 @@ public struct TLSConfiguration {
         self.shutdownTimeout = shutdownTimeout
         self.renegotiationSupport = renegotiationSupport
         self.sendCANameList = sendCANameList
+        self.serverSessionCache = serverSessionCache
+        self.clientSessionStore = clientSessionStore
+        self.sessionTicketKeys = sessionTicketKeys
+        self.enableEarlyData = enableEarlyData
+        self.enableInPlaceDecryption = enableInPlaceDecryption
+        self.enableDirectEncryption = enableDirectEncryption
+        self.dynamicRecordSizing = dynamicRecordSizing
+        self.enableKernelTLSOffload = enableKernelTLSOffload
+        self.certificateStore = certificateStore
+        self.certificateSelectionCallback = certificateSelectionCallback
+        self.handshakeHintsCallback = handshakeHintsCallback
+        self.certificateCompressionAlgorithms = certificateCompressionAlgorithms
+        self.keyExchangeGroups = keyExchangeGroups
+        self.predictedKeyShare = predictedKeyShare
+        self.keySharePool = keySharePool
+        self.verifiedChainCache = verifiedChainCache
+        self.trustStore = trustStore
+        self.trustRootsDirectoryMode = trustRootsDirectoryMode
+        self.certificateBufferPool = certificateBufferPool
         self.applicationProtocols = applicationProtocols
         self.keyLogCallback = keyLogCallback
         if !cipherSuiteValues.isEmpty {
@@ -348,7 +494,8 @@ public struct TLSConfiguration {
 extension TLSConfiguration {
     /// Returns a best effort result of whether two `TLSConfiguration` objects are equal.
     ///
-    /// The "best effort" stems from the fact that we are checking the pointer to the `keyLogCallback` closure.
+    /// The "best effort" stems from the fact that we are checking the pointers to the `keyLogCallback`,
+    /// `certificateSelectionCallback` and `handshakeHintsCallback` closures, and compare `clientSessionStore`, `sessionTicketKeys`, `certificateStore`, `keySharePool`, `trustStore` and `certificateBufferPool` by identity.
     ///
     /// - warning: You should probably not use this function. This function can return false-negatives, but not false-positives.
     public func bestEffortEquals(_ comparing: TLSConfiguration) -> Bool {
@@ -357,6 +504,16 @@ extension TLSConfiguration {
                 return callbackPointer1.elementsEqual(callbackPointer2)
             }
         }
+        let isCertificateSelectionCallbacksEqual = withUnsafeBytes(of: self.certificateSelectionCallback) { callbackPointer1 in
+            return withUnsafeBytes(of: comparing.certificateSelectionCallback) { callbackPointer2 in
+                return callbackPointer1.elementsEqual(callbackPointer2)
+            }
+        }
+        let isHandshakeHintsCallbacksEqual = withUnsafeBytes(of: self.handshakeHintsCallback) { callbackPointer1 in
+            return withUnsafeBytes(of: comparing.handshakeHintsCallback) { callbackPointer2 in
+                return callbackPointer1.elementsEqual(callbackPointer2)
+            }
+        }
         
         return self.minimumTLSVersion == comparing.minimumTLSVersion &&
             self.maximumTLSVersion == comparing.maximumTLSVersion &&
@@ -371,12 +528,32 @@ extension TLSConfiguration {
             self.encodedApplicationProtocols == comparing.encodedApplicationProtocols &&
             self.shutdownTimeout == comparing.shutdownTimeout &&
             isKeyLoggerCallbacksEqual &&
-            self.renegotiationSupport == comparing.renegotiationSupport
+            self.renegotiationSupport == comparing.renegotiationSupport &&
+            self.serverSessionCache == comparing.serverSessionCache &&
+            self.clientSessionStore === comparing.clientSessionStore &&
+            self.sessionTicketKeys === comparing.sessionTicketKeys &&
+            self.enableEarlyData == comparing.enableEarlyData &&
+            self.enableInPlaceDecryption == comparing.enableInPlaceDecryption &&
+            self.enableDirectEncryption == comparing.enableDirectEncryption &&
+            self.dynamicRecordSizing == comparing.dynamicRecordSizing &&
+            self.enableKernelTLSOffload == comparing.enableKernelTLSOffload &&
+            self.certificateStore === comparing.certificateStore &&
+            isCertificateSelectionCallbacksEqual &&
+            isHandshakeHintsCallbacksEqual &&
+            self.certificateCompressionAlgorithms == comparing.certificateCompressionAlgorithms &&
+            self.keyExchangeGroups == comparing.keyExchangeGroups &&
+            self.predictedKeyShare == comparing.predictedKeyShare &&
+            self.keySharePool === comparing.keySharePool &&
+            self.verifiedChainCache == comparing.verifiedChainCache &&
+            self.trustStore === comparing.trustStore &&
+            self.trustRootsDirectoryMode == comparing.trustRootsDirectoryMode &&
+            self.certificateBufferPool === comparing.certificateBufferPool
     }
     
     /// Returns a best effort hash of this TLS configuration.
     ///
-    /// The "best effort" stems from the fact that we are hashing the pointer bytes of the `keyLogCallback` closure.
+    /// The "best effort" stems from the fact that we are hashing the pointer bytes of the `keyLogCallback`,
+    /// `certificateSelectionCallback` and `handshakeHintsCallback` closures.
     ///
     /// - warning: You should probably not use this function. This function can return false-negatives, but not false-positives.
     public func bestEffortHash(into hasher: inout Hasher) {
@@ -396,6 +573,29 @@ extension TLSConfiguration {
             hasher.combine(bytes: closureBits)
         }
         hasher.combine(renegotiationSupport)
+        hasher.combine(serverSessionCache)
+        hasher.combine(clientSessionStore.map { ObjectIdentifier($0) })
+        hasher.combine(sessionTicketKeys.map { ObjectIdentifier($0) })
+        hasher.combine(enableEarlyData)
+        hasher.combine(enableInPlaceDecryption)
+        hasher.combine(enableDirectEncryption)
+        hasher.combine(dynamicRecordSizing)
+        hasher.combine(enableKernelTLSOffload)
+        hasher.combine(certificateStore.map { ObjectIdentifier($0) })
+        withUnsafeBytes(of: certificateSelectionCallback) { closureBits in
+            hasher.combine(bytes: closureBits)
+        }
+        withUnsafeBytes(of: handshakeHintsCallback) { closureBits in
+            hasher.combine(bytes: closureBits)
+        }
+        hasher.combine(certificateCompressionAlgorithms)
+        hasher.combine(keyExchangeGroups)
+        hasher.combine(predictedKeyShare)
+        hasher.combine(keySharePool.map { ObjectIdentifier($0) })
+        hasher.combine(verifiedChainCache)
+        hasher.combine(trustStore.map { ObjectIdentifier($0) })
+        hasher.combine(trustRootsDirectoryMode)
+        hasher.combine(certificateBufferPool.map { ObjectIdentifier($0) })
     }
 
     /// Creates a TLS configuration for use with client-side contexts.
@@ -448,6 +648,32 @@ extension TLSConfiguration {
                                 additionalTrustRoots: [],
                                 sendCANameList: false)
     }
+
+    /// Create a TLS configuration for use with server-side contexts that choose the certificate for each
+    /// connection from a `NIOSSLCertificateStore`.
+    ///
+    /// The configuration has no certificate of its own, so handshakes from clients that don't send SNI, or that
+    /// ask for a server name not in the store, fail. Set `certificateChain` and `privateKey` to serve those clients.
+    ///
+    /// For customising fields, modify the returned TLSConfiguration object.
+    public static func makeServerConfiguration(certificateStore: NIOSSLCertificateStore) -> TLSConfiguration {
+        return TLSConfiguration(cipherSuites: defaultCipherSuites,
+                                verifySignatureAlgorithms: nil,
+                                signingSignatureAlgorithms: nil,
+                                minimumTLSVersion: .tlsv1,
+                                maximumTLSVersion: nil,
+                                certificateVerification: .none,
+                                trustRoots: .default,
+                                certificateChain: [],
+                                privateKey: nil,
+                                applicationProtocols: [],
+                                shutdownTimeout: .seconds(5),
+                                keyLogCallback: nil,
+                                renegotiationSupport: .none,
+                                additionalTrustRoots: [],
+                                sendCANameList: false,
+                                certificateStore: certificateStore)
+    }
 }
 
 // MARK: Deprecated constructors.
@@ -0,0 +1,177 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+import NIOPosix
+@_implementationOnly import CNIOBoringSSL
+
+/// A `NIOSSLCustomPrivateKey` that performs the operations of an in-memory private key on a `NIOThreadPool`,
+/// instead of on the event loop.
+///
+/// An RSA signature takes around a millisecond, during which a key used directly would stop the event loop from
+/// serving any other connection. Moving the signature to a thread pool keeps that time off the event loop, at the
+/// cost of a thread hop per handshake.
+public final class NIOSSLThreadPoolPrivateKey: NIOSSLCustomPrivateKey, Hashable {
+    private let key: NIOSSLPrivateKey
+    private let threadPool: NIOThreadPool
+
+    public let signatureAlgorithms: [SignatureAlgorithm]
+
+    /// Create a key that signs with `key` on `threadPool`.
+    ///
+    /// - parameters:
+    ///     - key: An RSA, ECDSA or Ed25519 private key. Must not itself be a custom private key.
+    ///     - threadPool: The thread pool to sign on. It must be started, and kept running for as long as the key
+    ///         is in use.
+    /// - throws: `NIOSSLError.failedToLoadPrivateKey` if `key` is not a supported key.
+    public init(key: NIOSSLPrivateKey, threadPool: NIOThreadPool) throws {
+        guard case .native = key.representation else {
+            throw NIOSSLError.failedToLoadPrivateKey
+        }
+
+        let signatureAlgorithms = key.withUnsafeMutableEVPPKEYPointer { NIOSSLThreadPoolPrivateKey.signatureAlgorithms(for: $0) }
+        guard !signatureAlgorithms.isEmpty else {
+            throw NIOSSLError.failedToLoadPrivateKey
+        }
+
+        self.key = key
+        self.threadPool = threadPool
+        self.signatureAlgorithms = signatureAlgorithms
+    }
+
+    public func sign(channel: Channel, algorithm: SignatureAlgorithm, data: ByteBuffer) -> EventLoopFuture<ByteBuffer> {
+        let allocator = channel.allocator
+        return self.threadPool.runIfActive(eventLoop: channel.eventLoop) {
+            try self.key.sign(algorithm: algorithm, data: data, allocator: allocator)
+        }
+    }
+
+    public func decrypt(channel: Channel, data: ByteBuffer) -> EventLoopFuture<ByteBuffer> {
+        let allocator = channel.allocator
+        return self.threadPool.runIfActive(eventLoop: channel.eventLoop) {
+            try self.key.rawRSADecrypt(data: data, allocator: allocator)
+        }
+    }
+
+    public static func ==(lhs: NIOSSLThreadPoolPrivateKey, rhs: NIOSSLThreadPoolPrivateKey) -> Bool {
+        return lhs.key == rhs.key && lhs.threadPool === rhs.threadPool
+    }
+
+    public func hash(into hasher: inout Hasher) {
+        hasher.combine(self.key)
+        hasher.combine(ObjectIdentifier(self.threadPool))
+    }
+
+    /// The signature algorithms that TLS can use with `key`.
+    private static func signatureAlgorithms(for key: UnsafeMutablePointer<EVP_PKEY>) -> [SignatureAlgorithm] {
+        switch CNIOBoringSSL_EVP_PKEY_id(key) {
+        case EVP_PKEY_RSA:
+            return [.rsaPssRsaeSha256, .rsaPssRsaeSha384, .rsaPssRsaeSha512,
+                    .rsaPkcs1Sha256, .rsaPkcs1Sha384, .rsaPkcs1Sha512, .rsaPkcs1Sha1]
+        case EVP_PKEY_EC:
+            let group = CNIOBoringSSL_EC_KEY_get0_group(CNIOBoringSSL_EVP_PKEY_get0_EC_KEY(key))
+            switch CNIOBoringSSL_EC_GROUP_get_curve_name(group) {
+            case NID_X9_62_prime256v1:
+                return [.ecdsaSecp256R1Sha256, .ecdsaSha1]
+            case NID_secp384r1:
+                return [.ecdsaSecp384R1Sha384, .ecdsaSha1]
+            case NID_secp521r1:
+                return [.ecdsaSecp521R1Sha512, .ecdsaSha1]
+            default:
+                return []
+            }
+        case EVP_PKEY_ED25519:
+            return [.ed25519]
+        default:
+            return []
+        }
+    }
+}
+
+extension NIOSSLPrivateKey {
+    /// Signs `data` as TLS requires for `algorithm`: hashing it with the algorithm's digest, and using PSS padding
+    /// with a salt the length of the digest for RSA-PSS.
+    fileprivate func sign(algorithm: SignatureAlgorithm, data: ByteBuffer, allocator: ByteBufferAllocator) throws -> ByteBuffer {
+        let digestContext = CNIOBoringSSL_EVP_MD_CTX_new()!
+        defer {
+            CNIOBoringSSL_EVP_MD_CTX_free(digestContext)
+        }
+
+        var keyContext: OpaquePointer? = nil
+        let initialized = self.withUnsafeMutableEVPPKEYPointer { key -> Bool in
+            // The digest is nil for Ed25519, which hashes internally.
+            let digest = CNIOBoringSSL_SSL_get_signature_algorithm_digest(algorithm.rawValue)
+            guard CNIOBoringSSL_EVP_DigestSignInit(digestContext, &keyContext, digest, nil, key) == 1 else {
+                return false
+            }
+            if CNIOBoringSSL_SSL_is_signature_algorithm_rsa_pss(algorithm.rawValue) == 1 {
+                return CNIOBoringSSL_EVP_PKEY_CTX_set_rsa_padding(keyContext, RSA_PKCS1_PSS_PADDING) == 1 &&
+                    CNIOBoringSSL_EVP_PKEY_CTX_set_rsa_pss_saltlen(keyContext, -1) == 1
+            }
+            return true
+        }
+        guard initialized else {
+            throw BoringSSLError.unknownError(BoringSSLError.buildErrorStack())
+        }
+
+        return try data.withUnsafeReadableBytes { input in
+            let inputPointer = input.bindMemory(to: UInt8.self).baseAddress
+
+            var maximumLength = 0
+            guard CNIOBoringSSL_EVP_DigestSign(digestContext, nil, &maximumLength, inputPointer, input.count) == 1 else {
+                throw BoringSSLError.unknownError(BoringSSLError.buildErrorStack())
+            }
+
+            var signature = allocator.buffer(capacity: maximumLength)
+            var rc: CInt = 0
+            signature.writeWithUnsafeMutableBytes(minimumWritableBytes: maximumLength) { output in
+                var length = output.count
+                rc = CNIOBoringSSL_EVP_DigestSign(digestContext, output.bindMemory(to: UInt8.self).baseAddress,
+                                                  &length, inputPointer, input.count)
+                return rc == 1 ? length : 0
+            }
+            guard rc == 1 else {
+                throw BoringSSLError.unknownError(BoringSSLError.buildErrorStack())
+            }
+            return signature
+        }
+    }
+
+    /// Performs a raw RSA decryption, without padding, as TLS RSA key exchange requires.
+    fileprivate func rawRSADecrypt(data: ByteBuffer, allocator: ByteBufferAllocator) throws -> ByteBuffer {
+        return try self.withUnsafeMutableEVPPKEYPointer { key in
+            guard let rsa = CNIOBoringSSL_EVP_PKEY_get0_RSA(key) else {
+                throw NIOSSLError.failedToLoadPrivateKey
+            }
+
+            let maximumLength = Int(CNIOBoringSSL_RSA_size(rsa))
+            var output = allocator.buffer(capacity: maximumLength)
+            var rc: CInt = 0
+            output.writeWithUnsafeMutableBytes(minimumWritableBytes: maximumLength) { outputBytes in
+                var written = 0
+                rc = data.withUnsafeReadableBytes { inputBytes in
+                    CNIOBoringSSL_RSA_decrypt(rsa, &written,
+                                              outputBytes.bindMemory(to: UInt8.self).baseAddress, outputBytes.count,
+                                              inputBytes.bindMemory(to: UInt8.self).baseAddress, inputBytes.count,
+                                              RSA_NO_PADDING)
+                }
+                return rc == 1 ? written : 0
+            }
+            guard rc == 1 else {
+                throw BoringSSLError.unknownError(BoringSSLError.buildErrorStack())
+            }
+            return output
+        }
+    }
+}
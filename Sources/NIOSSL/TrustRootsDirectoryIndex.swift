@@ -0,0 +1,160 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+import NIOConcurrencyHelpers
+import Dispatch
+
+#if os(macOS) || os(iOS) || os(watchOS) || os(tvOS)
+import Darwin.C
+#elseif os(Linux) || os(FreeBSD) || os(Android)
+import Glibc
+#else
+#error("unsupported os")
+#endif
+
+/// How a `NIOSSLContext` finds trust roots in a directory given as its `trustRoots`.
+public enum NIOSSLTrustRootsDirectoryMode: Hashable {
+    /// Look for the roots in the directory during each verification, probing the `c_rehash` file names for the
+    /// issuer being looked for.
+    case lookupOnDemand
+
+    /// Read the whole directory once, when the context is created, and look for the roots in memory.
+    ///
+    /// When `reloadInterval` is set, the modification time of the directory is checked once per interval on a
+    /// background queue, and the directory is read again if it has changed. This picks up roots being added or
+    /// removed, but not a file being rewritten in place. Verifications never wait for the directory to be read.
+    /// `NIOSSLContext.reloadTrustRootsDirectory()` reads the directory again immediately, for use with a file
+    /// system watcher.
+    case indexed(reloadInterval: TimeAmount?)
+}
+
+/// The roots in a `c_rehash` directory, indexed by subject in memory.
+///
+/// The directory is only ever read when the index is created, when `reload()` is called, and when a change is
+/// found by the background check started with `watch(every:onReload:)`. Verifications only read the current
+/// index, so they never touch the file system.
+internal final class TrustRootsDirectoryIndex {
+    /// The queue the directories of every index are checked for changes on.
+    private static let watchQueue = DispatchQueue(label: "io.swiftnio.ssl.trustRootsDirectoryQueue")
+
+    private let path: String
+    private let lock = Lock()
+    private var store: NIOSSLTrustStore
+    private var modificationTime: timespec?
+    private var timer: DispatchSourceTimer?
+
+    init(path: String) throws {
+        self.path = path
+        self.modificationTime = TrustRootsDirectoryIndex.modificationTime(of: path)
+        self.store = try NIOSSLTrustStore(directory: path)
+    }
+
+    deinit {
+        self.timer?.cancel()
+    }
+
+    /// The number of roots in the index.
+    var count: Int {
+        return self.lock.withLock { self.store.count }
+    }
+
+    /// Finds a root that issued `certificate`.
+    ///
+    /// - returns: An owned reference to the issuing root, or nil if no root in the directory issued `certificate`.
+    func issuer(of certificate: OpaquePointer) -> OpaquePointer? {
+        let store = self.lock.withLock { self.store }
+        return store.issuer(of: certificate)
+    }
+
+    /// Reads the directory again.
+    func reload() throws {
+        let modificationTime = TrustRootsDirectoryIndex.modificationTime(of: self.path)
+        let store = try NIOSSLTrustStore(directory: self.path)
+        self.lock.withLockVoid {
+            self.store = store
+            self.modificationTime = modificationTime
+        }
+    }
+
+    /// Starts checking the modification time of the directory every `interval` on a background queue, and reading
+    /// the directory again when it has changed. `onReload` is called on that queue after each reload.
+    func watch(every interval: TimeAmount, onReload: @escaping () -> Void) {
+        let timer = DispatchSource.makeTimerSource(queue: TrustRootsDirectoryIndex.watchQueue)
+        let repeating = DispatchTimeInterval.nanoseconds(Int(max(interval.nanoseconds, 1)))
+        timer.schedule(deadline: .now() + repeating, repeating: repeating)
+        timer.setEventHandler { [weak self] in
+            if self?.reloadIfChanged() ?? false {
+                onReload()
+            }
+        }
+        self.lock.withLockVoid {
+            self.timer = timer
+        }
+        timer.resume()
+    }
+
+    /// Reads the directory again if it has changed.
+    ///
+    /// - returns: Whether the directory was read again.
+    private func reloadIfChanged() -> Bool {
+        let modificationTime = TrustRootsDirectoryIndex.modificationTime(of: self.path)
+        let changed = self.lock.withLock { () -> Bool in
+            switch (self.modificationTime, modificationTime) {
+            case (.some(let old), .some(let new)):
+                return old.tv_sec != new.tv_sec || old.tv_nsec != new.tv_nsec
+            case (.none, .none):
+                return false
+            default:
+                return true
+            }
+        }
+        guard changed else {
+            return false
+        }
+
+        // If the directory can't be read right now, keep using the roots we have.
+        return (try? self.reload()) != nil
+    }
+
+    private static func modificationTime(of path: String) -> timespec? {
+        var statObj = stat()
+        do {
+            try Posix.stat(path: path, buf: &statObj)
+        } catch {
+            return nil
+        }
+
+        #if os(macOS) || os(iOS) || os(watchOS) || os(tvOS)
+        return statObj.st_mtimespec
+        #else
+        return statObj.st_mtim
+        #endif
+    }
+}
+
+extension NIOSSLContext {
+    /// Reads the trust roots directory again, for a context whose `trustRoots` is a directory indexed with
+    /// `NIOSSLTrustRootsDirectoryMode.indexed`. Does nothing for other contexts.
+    ///
+    /// Call this when a file system watcher reports that the directory has changed. Results held by the verified
+    /// chain cache are discarded, so that removed roots stop being trusted immediately.
+    public func reloadTrustRootsDirectory() throws {
+        guard let trustRootsDirectory = self.trustRootsDirectory else {
+            return
+        }
+        try trustRootsDirectory.reload()
+        self.invalidateVerifiedChainCache()
+    }
+}
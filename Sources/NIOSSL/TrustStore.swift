@@ -0,0 +1,260 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOConcurrencyHelpers
+@_implementationOnly import CNIOBoringSSL
+@_implementationOnly import CNIOBoringSSLShims
+
+/// A set of trusted root certificates that can be shared by any number of `NIOSSLContext`s.
+///
+/// Each context configured with `trustRoots` holds its own parsed copy of its roots, and parses them again every
+/// time a context is created. A trust store instead holds its roots once for the whole process, in the form they
+/// have on the wire, and parses each root the first time a verification needs it. Contexts using a trust store
+/// are therefore cheap to create, however many roots the store holds.
+///
+/// Set a store as the `TLSConfiguration.trustStore` of any number of contexts. A trust store cannot be changed
+/// once created. This object is thread-safe.
+public final class NIOSSLTrustStore {
+    /// A trusted root, parsed on first use.
+    private final class Root {
+        let buffer: OpaquePointer
+        var certificate: OpaquePointer?
+
+        init(buffer: OpaquePointer) {
+            self.buffer = buffer
+        }
+
+        deinit {
+            CNIOBoringSSL_CRYPTO_BUFFER_free(self.buffer)
+            if let certificate = self.certificate {
+                CNIOBoringSSL_X509_free(certificate)
+            }
+        }
+    }
+
+    /// The pool every trust store's roots are interned in, so that a root held by several stores, such as the
+    /// system default store and one loaded from the same bundle, is only held once. It is never freed. It is
+    /// separate from any `NIOSSLCertificateBufferPool`, so roots neither share a lock with peer certificates
+    /// nor appear in a pool's statistics.
+    private static let rootPool: OpaquePointer = CNIOBoringSSL_CRYPTO_BUFFER_POOL_new()!
+
+    private let lock = Lock()
+
+    /// The roots, keyed by the `X509_NAME_hash` of their subject.
+    private let roots: [UInt32: [Root]]
+
+    /// The number of roots in the store.
+    public let count: Int
+
+    /// Create a trust store from DER-encoded certificates.
+    private init(derCertificates: [[UInt8]]) throws {
+        var roots: [UInt32: [Root]] = [:]
+        var count = 0
+        for der in derCertificates {
+            guard let buffer = der.withUnsafeBufferPointer({
+                CNIOBoringSSL_CRYPTO_BUFFER_new($0.baseAddress, $0.count, NIOSSLTrustStore.rootPool)
+            }) else {
+                throw NIOSSLError.failedToLoadCertificate
+            }
+            let root = Root(buffer: buffer)
+
+            var subjectNameHash: UInt32 = 0
+            guard CNIOBoringSSLShims_CRYPTO_BUFFER_subject_name_hash(buffer, &subjectNameHash) == 1 else {
+                throw NIOSSLError.failedToLoadCertificate
+            }
+
+            // The pool returns the same buffer for the same bytes, so duplicates are easy to spot.
+            if roots[subjectNameHash]?.contains(where: { $0.buffer == buffer }) ?? false {
+                continue
+            }
+            roots[subjectNameHash, default: []].append(root)
+            count += 1
+        }
+
+        self.roots = roots
+        self.count = count
+    }
+
+    /// Create a trust store holding the given certificates.
+    ///
+    /// - parameters:
+    ///     - certificates: The trusted root certificates.
+    public convenience init(certificates: [NIOSSLCertificate]) throws {
+        try self.init(derCertificates: certificates.map { try $0.toDERBytes() })
+    }
+
+    /// Create a trust store holding the certificates in a PEM file, such as a system CA bundle.
+    ///
+    /// The certificates are only decoded from PEM: none is parsed until it is needed.
+    ///
+    /// - parameters:
+    ///     - file: The path to a file containing one or more PEM-encoded certificates.
+    public convenience init(file: String) throws {
+        try self.init(derCertificates: NIOSSLTrustStore.readDERCertificates(fromPEMFile: file))
+    }
+
+    /// Create a trust store holding the certificates in a directory prepared with `c_rehash` or `openssl rehash`.
+    ///
+    /// Every file named like `HHHHHHHH.D`, where `H` is a hexadecimal digit and `D` a decimal one, is read as a PEM
+    /// file. Other files are ignored.
+    ///
+    /// - parameters:
+    ///     - directory: The path to the directory.
+    /// - throws: `NIOSSLError.noSuchFilesystemObject` if `directory` is not a directory.
+    public convenience init(directory: String) throws {
+        guard FileSystemObject.pathType(path: directory) == .directory else {
+            throw NIOSSLError.noSuchFilesystemObject
+        }
+
+        let prefix = directory.hasSuffix("/") ? directory : directory + "/"
+        var certificates: [[UInt8]] = []
+        for path in DirectoryContents(path: prefix) where NIOSSLTrustStore.isHashedCertificateName(path) {
+            certificates.append(contentsOf: try NIOSSLTrustStore.readDERCertificates(fromPEMFile: path))
+        }
+        try self.init(derCertificates: certificates)
+    }
+
+    #if os(Linux) || os(FreeBSD)
+    private static let systemDefaultLock = Lock()
+    private static var _systemDefault: NIOSSLTrustStore?
+
+    /// The trust store holding the system default root certificates, loaded the first time it is used and
+    /// shared for the rest of the life of the process.
+    ///
+    /// - throws: `NIOSSLError.noSuchFilesystemObject` if the system CA bundle could not be found.
+    public static func systemDefault() throws -> NIOSSLTrustStore {
+        return try self.systemDefaultLock.withLock {
+            if let store = self._systemDefault {
+                return store
+            }
+            guard let path = rootCAFilePath else {
+                throw NIOSSLError.noSuchFilesystemObject
+            }
+            let store = try NIOSSLTrustStore(file: path)
+            self._systemDefault = store
+            return store
+        }
+    }
+    #endif
+
+    /// The number of roots that have been parsed so far.
+    internal var parsedCount: Int {
+        return self.lock.withLock {
+            self.roots.values.reduce(0) { count, roots in
+                count + roots.filter { $0.certificate != nil }.count
+            }
+        }
+    }
+
+    /// The buffers holding the roots. A root held by several stores is held in the same buffer by each.
+    internal var rootBuffers: Set<OpaquePointer> {
+        return Set(self.roots.values.joined().map { $0.buffer })
+    }
+
+    /// Finds a root that issued `certificate`, parsing candidate roots as needed.
+    ///
+    /// - returns: An owned reference to the issuing root, or nil if no root in the store issued `certificate`.
+    internal func issuer(of certificate: OpaquePointer) -> OpaquePointer? {
+        let issuerNameHash = UInt32(truncatingIfNeeded: CNIOBoringSSL_X509_NAME_hash(CNIOBoringSSL_X509_get_issuer_name(certificate)))
+        guard let candidates = self.roots[issuerNameHash] else {
+            return nil
+        }
+
+        return self.lock.withLock {
+            for root in candidates {
+                if root.certificate == nil {
+                    root.certificate = CNIOBoringSSL_X509_parse_from_buffer(root.buffer)
+                }
+                guard let rootCertificate = root.certificate,
+                      CNIOBoringSSL_X509_check_issued(rootCertificate, certificate) == X509_V_OK else {
+                    continue
+                }
+                CNIOBoringSSL_X509_up_ref(rootCertificate)
+                return rootCertificate
+            }
+            return nil
+        }
+    }
+
+    /// Whether the last component of `path` has the `HHHHHHHH.D` form `c_rehash` gives certificates.
+    private static func isHashedCertificateName(_ path: String) -> Bool {
+        guard let name = path.utf8.split(separator: UInt8(ascii: "/")).last else {
+            return false
+        }
+        let parts = name.split(separator: UInt8(ascii: "."), omittingEmptySubsequences: false)
+        guard parts.count == 2, let hash = parts.first, let index = parts.last else {
+            return false
+        }
+        return hash.count == 8 && hash.allSatisfy({ $0.isHexDigit }) &&
+            !index.isEmpty && index.allSatisfy({ UInt8(ascii: "0")...UInt8(ascii: "9") ~= $0 })
+    }
+
+    private static func readDERCertificates(fromPEMFile path: String) throws -> [[UInt8]] {
+        CNIOBoringSSL_ERR_clear_error()
+        defer {
+            CNIOBoringSSL_ERR_clear_error()
+        }
+
+        guard let bio = CNIOBoringSSL_BIO_new(CNIOBoringSSL_BIO_s_file()) else {
+            fatalError("Failed to create a BIO handle to read a PEM file")
+        }
+        defer {
+            CNIOBoringSSL_BIO_free(bio)
+        }
+
+        guard CNIOBoringSSL_BIO_read_filename(bio, path) > 0 else {
+            throw NIOSSLError.failedToLoadCertificate
+        }
+
+        var certificates: [[UInt8]] = []
+        var data: UnsafeMutablePointer<UInt8>? = nil
+        var length = 0
+        while CNIOBoringSSL_PEM_bytes_read_bio(&data, &length, nil, PEM_STRING_X509, bio, nil, nil) == 1 {
+            certificates.append(Array(UnsafeBufferPointer(start: data, count: length)))
+            CNIOBoringSSL_OPENSSL_free(data)
+        }
+
+        // If we hit the end of the file then it's not a real error, we just read as much as we could.
+        let err = CNIOBoringSSL_ERR_peek_error()
+        guard CNIOBoringSSLShims_ERR_GET_LIB(err) == ERR_LIB_PEM && CNIOBoringSSLShims_ERR_GET_REASON(err) == PEM_R_NO_START_LINE,
+              !certificates.isEmpty else {
+            throw NIOSSLError.failedToLoadCertificate
+        }
+        return certificates
+    }
+}
+
+extension NIOSSLContext {
+    /// Makes a `SSL_CTX` look for trusted issuers in the `trustStore` of its configuration, or in its index of a trust
+    /// roots directory, after its own trust roots.
+    internal static func configureTrustStore(context: OpaquePointer) {
+        let store = CNIOBoringSSL_SSL_CTX_get_cert_store(context)!
+        CNIOBoringSSL_X509_STORE_set_get_issuer(store) { issuer, storeContext, certificate in
+            // Roots added to the context itself, such as its additionalTrustRoots, are found as usual.
+            let result = CNIOBoringSSL_X509_STORE_CTX_get1_issuer(issuer, storeContext, certificate)
+            guard result == 0, let certificate = certificate,
+                  let ssl = CNIOBoringSSL_X509_STORE_CTX_get_ex_data(storeContext, CNIOBoringSSL_SSL_get_ex_data_X509_STORE_CTX_idx()) else {
+                return result
+            }
+
+            let parentContext = SSLConnection.loadConnectionFromSSL(OpaquePointer(ssl)).parentContext
+            guard let root = parentContext.configuration.trustStore?.issuer(of: certificate) ??
+                    parentContext.trustRootsDirectory?.issuer(of: certificate) else {
+                return 0
+            }
+            issuer!.pointee = root
+            return 1
+        }
+    }
+}
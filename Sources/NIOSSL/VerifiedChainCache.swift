@@ -0,0 +1,232 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the SwiftNIO open source project
+//
+// Copyright (c) 2021 Apple Inc. and the SwiftNIO project authors
+// Licensed under Apache License v2.0
+//
+// See LICENSE.txt for license information
+// See CONTRIBUTORS.txt for the list of SwiftNIO project authors
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+//===----------------------------------------------------------------------===//
+
+import NIOCore
+import NIOConcurrencyHelpers
+@_implementationOnly import CNIOBoringSSL
+
+#if os(macOS) || os(iOS) || os(watchOS) || os(tvOS)
+import Darwin.C
+#elseif os(Linux) || os(FreeBSD) || os(Android)
+import Glibc
+#else
+#error("unsupported os")
+#endif
+
+/// Configuration for the cache of verified peer certificate chains used by `NIOSSLContext`s.
+///
+/// Verifying a certificate chain builds a path to a trust root and checks the signature of every certificate on it.
+/// When the same peers connect again and again, as clients presenting certificates often do, a context with a
+/// verified chain cache remembers which chains it has verified, and accepts them again without repeating that work.
+///
+/// Only the default certificate verification is cached. Connections using a custom verification callback are not
+/// affected.
+///
+/// A context with a verified chain cache also remembers the names and addresses each peer leaf certificate is valid
+/// for, up to `maximumSize` certificates, so that hostname validation does not analyse the same certificate again.
+/// Certificates are recognised by their buffer, so this needs the context to have a `certificateBufferPool`.
+public struct NIOSSLVerifiedChainCacheConfiguration: Hashable {
+    /// The maximum number of chains to remember. Once the cache is full, chains that have not been used recently
+    /// are evicted.
+    public var maximumSize: Int
+
+    /// The amount of time for which a verification result is reused. Results are also never reused outside the
+    /// validity period of the chain.
+    ///
+    /// Revocation and changes to the trust roots take effect once cached results expire, or once
+    /// `NIOSSLContext.invalidateVerifiedChainCache()` is called.
+    public var maximumAge: TimeAmount
+
+    /// Create a new verified chain cache configuration.
+    ///
+    /// - parameters:
+    ///     - maximumSize: The maximum number of chains to remember. Defaults to 1024.
+    ///     - maximumAge: How long a verification result is reused. Defaults to 5 minutes.
+    public init(maximumSize: Int = 1024, maximumAge: TimeAmount = .minutes(5)) {
+        precondition(maximumSize > 0, "maximumSize must be positive")
+        precondition(maximumAge.nanoseconds > 0, "maximumAge must be positive")
+        self.maximumSize = maximumSize
+        self.maximumAge = maximumAge
+    }
+}
+
+/// A snapshot of the verified chain cache counters of a `NIOSSLContext`.
+public struct NIOSSLVerifiedChainCacheStatistics: Hashable {
+    /// The number of chains accepted from the cache without being verified.
+    public var hits: Int
+
+    /// The number of chains that were verified.
+    public var misses: Int
+
+    /// The number of chains currently held in the cache.
+    public var cachedChains: Int
+
+    public init(hits: Int, misses: Int, cachedChains: Int) {
+        self.hits = hits
+        self.misses = misses
+        self.cachedChains = cachedChains
+    }
+}
+
+/// The peer certificate chains a context has verified, keyed by a SHA-256 digest of their DER bytes.
+///
+/// Eviction gives each chain a second chance if it has been used since it was last considered, which approximates
+/// least-recently-used order without reordering on every hit.
+internal final class VerifiedChainCache {
+    private struct Entry {
+        var notValidBefore: time_t
+        var notValidAfter: time_t
+        var expiry: NIODeadline
+        var recentlyUsed: Bool
+    }
+
+    private let configuration: NIOSSLVerifiedChainCacheConfiguration
+    private let lock = Lock()
+    private var entries: [[UInt8]: Entry] = [:]
+    private var evictionOrder = CircularBuffer<[UInt8]>()
+    private var hits = 0
+    private var misses = 0
+
+    init(configuration: NIOSSLVerifiedChainCacheConfiguration) {
+        self.configuration = configuration
+    }
+
+    /// Whether the chain with digest `key` was verified recently enough to accept it again.
+    func containsValidChain(forKey key: [UInt8]) -> Bool {
+        let now = time(nil)
+        return self.lock.withLock {
+            guard var entry = self.entries[key],
+                  entry.notValidBefore <= now, now <= entry.notValidAfter,
+                  NIODeadline.now() < entry.expiry else {
+                self.misses += 1
+                return false
+            }
+            entry.recentlyUsed = true
+            self.entries[key] = entry
+            self.hits += 1
+            return true
+        }
+    }
+
+    /// Records that the chain with digest `key` has been verified, and is valid between the given times.
+    func insertChain(forKey key: [UInt8], notValidBefore: time_t, notValidAfter: time_t) {
+        let entry = Entry(notValidBefore: notValidBefore,
+                          notValidAfter: notValidAfter,
+                          expiry: .now() + self.configuration.maximumAge,
+                          recentlyUsed: false)
+        self.lock.withLockVoid {
+            guard self.entries.updateValue(entry, forKey: key) == nil else {
+                return
+            }
+            self.evictionOrder.append(key)
+
+            while self.entries.count > self.configuration.maximumSize {
+                let candidate = self.evictionOrder.removeFirst()
+                if self.entries[candidate]!.recentlyUsed {
+                    self.entries[candidate]!.recentlyUsed = false
+                    self.evictionOrder.append(candidate)
+                } else {
+                    self.entries.removeValue(forKey: candidate)
+                }
+            }
+        }
+    }
+
+    func removeAll() {
+        self.lock.withLockVoid {
+            self.entries.removeAll()
+            self.evictionOrder.removeAll()
+        }
+    }
+
+    var statistics: NIOSSLVerifiedChainCacheStatistics {
+        return self.lock.withLock {
+            NIOSSLVerifiedChainCacheStatistics(hits: self.hits, misses: self.misses, cachedChains: self.entries.count)
+        }
+    }
+}
+
+extension NIOSSLContext {
+    /// Makes a `SSL_CTX` consult the verified chain cache before verifying a peer certificate chain.
+    internal static func configureVerifiedChainCache(context: OpaquePointer) {
+        CNIOBoringSSL_SSL_CTX_set_cert_verify_callback(context, { storeContext, _ in
+            guard let storeContext = storeContext,
+                  let ssl = CNIOBoringSSL_X509_STORE_CTX_get_ex_data(storeContext, CNIOBoringSSL_SSL_get_ex_data_X509_STORE_CTX_idx()) else {
+                preconditionFailure("Unable to obtain SSL * from X509_STORE_CTX * \(String(describing: storeContext))")
+            }
+
+            let connection = SSLConnection.loadConnectionFromSSL(OpaquePointer(ssl))
+            guard let cache = connection.parentContext.verifiedChains,
+                  !connection.hasVerificationCallback,
+                  let key = connection.peerCertificateChainDigest() else {
+                // The old-style verification callback must see every certificate, so these are never cached.
+                return CNIOBoringSSL_X509_verify_cert(storeContext)
+            }
+
+            if cache.containsValidChain(forKey: key) {
+                return 1
+            }
+
+            let result = CNIOBoringSSL_X509_verify_cert(storeContext)
+            if result == 1, let chain = CNIOBoringSSL_X509_STORE_CTX_get0_chain(storeContext) {
+                // The result is only valid while every certificate on the verified path is.
+                var notValidBefore = time_t.min
+                var notValidAfter = time_t.max
+                for index in 0..<CNIOBoringSSL_sk_X509_num(chain) {
+                    let certificate = CNIOBoringSSL_sk_X509_value(chain, index)
+                    notValidBefore = max(notValidBefore, CNIOBoringSSL_X509_get0_notBefore(certificate)!.timeSinceEpoch)
+                    notValidAfter = min(notValidAfter, CNIOBoringSSL_X509_get0_notAfter(certificate)!.timeSinceEpoch)
+                }
+                cache.insertChain(forKey: key, notValidBefore: notValidBefore, notValidAfter: notValidAfter)
+            }
+            return result
+        }, nil)
+    }
+
+    /// The current verified chain cache counters for this context, or nil if it does not cache verified chains.
+    public var verifiedChainCacheStatistics: NIOSSLVerifiedChainCacheStatistics? {
+        return self.verifiedChains?.statistics
+    }
+
+    /// Forgets every chain this context has verified, so that each is verified again on its next use.
+    ///
+    /// Call this after revoking a certificate, or after changing the trust roots the context uses.
+    public func invalidateVerifiedChainCache() {
+        self.verifiedChains?.removeAll()
+    }
+}
+
+extension SSLConnection {
+    /// A SHA-256 digest of the DER bytes of the peer certificate chain, or nil if there is no chain.
+    fileprivate func peerCertificateChainDigest() -> [UInt8]? {
+        return self.withPeerCertificateChainBuffers { buffers in
+            guard let buffers = buffers, buffers.count > 0 else {
+                return nil
+            }
+
+            var context = SHA256_CTX()
+            CNIOBoringSSL_SHA256_Init(&context)
+            for buffer in buffers {
+                // Each certificate is length-prefixed, so that different splits of the same bytes differ.
+                var length = UInt32(buffer.count).bigEndian
+                withUnsafeBytes(of: &length) { _ = CNIOBoringSSL_SHA256_Update(&context, $0.baseAddress, $0.count) }
+                CNIOBoringSSL_SHA256_Update(&context, buffer.baseAddress, buffer.count)
+            }
+
+            var digest = Array(repeating: UInt8(0), count: Int(SHA256_DIGEST_LENGTH))
+            CNIOBoringSSL_SHA256_Final(&digest, &context)
+            return digest
+        }
+    }
+}
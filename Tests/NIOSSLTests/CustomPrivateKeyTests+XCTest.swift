@@ -37,6 +37,8 @@ extension CustomPrivateKeyTests {
                 ("testThrowingCustomErrorsSigning", testThrowingCustomErrorsSigning),
                 ("testKeyEquatability", testKeyEquatability),
                 ("testKeyHashability", testKeyHashability),
+                ("testBatchingKeyCollectsRequestsWithinWindow", testBatchingKeyCollectsRequestsWithinWindow),
+                ("testBatchingKeySubmitsFullBatchImmediately", testBatchingKeySubmitsFullBatchImmediately),
            ]
    }
 }
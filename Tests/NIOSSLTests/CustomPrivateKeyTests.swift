@@ -218,6 +218,27 @@ fileprivate final class CustomKeyDelayedCompletion: NIOSSLCustomPrivateKey, Hash
     }
 }
 
+fileprivate final class CustomBatchSigningKey: NIOSSLBatchSigningKey {
+    let backing: CustomPKEY
+    let signatureAlgorithms: [SignatureAlgorithm]
+    var batchSizes: [Int]
+
+    fileprivate init(_ backing: CustomPKEY, signatureAlgorithms: [SignatureAlgorithm]) {
+        self.backing = backing
+        self.signatureAlgorithms = signatureAlgorithms
+        self.batchSizes = []
+    }
+
+    func sign(batch: [NIOSSLSigningRequest], eventLoop: EventLoop) -> EventLoopFuture<[Result<ByteBuffer, Error>]> {
+        self.batchSizes.append(batch.count)
+        return eventLoop.makeSucceededFuture(batch.map { .success(self.backing.sign(algorithm: $0.algorithm, data: $0.data)) })
+    }
+
+    func decrypt(channel: Channel, data: ByteBuffer) -> EventLoopFuture<ByteBuffer> {
+        return channel.eventLoop.makeSucceededFuture(self.backing.decrypt(data: data))
+    }
+}
+
 final class CustomPrivateKeyTests: XCTestCase {
     fileprivate static let customECDSACertAndKey: (certificate: NIOSSLCertificate, key: CustomPKEY) = {
         let (cert, originalKey) = generateSelfSignedCert(keygenFunction: { generateECPrivateKey(curveNID: NID_X9_62_prime256v1) })
@@ -610,6 +631,62 @@ final class CustomPrivateKeyTests: XCTestCase {
             Set([NIOSSLPrivateKey(customPrivateKey: firstKey), NIOSSLPrivateKey(customPrivateKey: secondKey), NIOSSLPrivateKey(customPrivateKey: thirdKey)])
         )
     }
+
+    private func batchingChannels(loop: EmbeddedEventLoop, key: NIOSSLBatchingCustomPrivateKey) throws -> BackToBackEmbeddedChannel {
+        let b2b = BackToBackEmbeddedChannel(loop: loop)
+        let clientContext = self.configuredClientContext(trustRoot: CustomPrivateKeyTests.customECDSACertAndKey.certificate)
+        let serverContext = self.configuredServerContext(
+            certificate: CustomPrivateKeyTests.customECDSACertAndKey.certificate,
+            privateKey: NIOSSLPrivateKey(customPrivateKey: key)
+        )
+        try b2b.client.pipeline.syncOperations.addHandlers(
+            [try NIOSSLClientHandler(context: clientContext, serverHostname: "localhost"), HandshakeCompletedHandler()]
+        )
+        try b2b.server.pipeline.syncOperations.addHandlers(
+            [NIOSSLServerHandler(context: serverContext), HandshakeCompletedHandler()]
+        )
+        return b2b
+    }
+
+    func testBatchingKeyCollectsRequestsWithinWindow() throws {
+        let loop = EmbeddedEventLoop()
+        let batchKey = CustomBatchSigningKey(CustomPrivateKeyTests.customECDSACertAndKey.key,
+                                             signatureAlgorithms: [.ecdsaSecp256R1Sha256])
+        let key = NIOSSLBatchingCustomPrivateKey(key: batchKey, maximumBatchSize: 32, batchingWindow: .milliseconds(5))
+        let first = try assertNoThrowWithValue(self.batchingChannels(loop: loop, key: key))
+        let second = try assertNoThrowWithValue(self.batchingChannels(loop: loop, key: key))
+
+        XCTAssertNoThrow(try first.connectInMemory())
+        XCTAssertNoThrow(try second.connectInMemory())
+
+        // Both handshakes are waiting for the batch to be submitted.
+        XCTAssertEqual(batchKey.batchSizes, [])
+        XCTAssertFalse(first.server.handshakeSucceeded)
+        XCTAssertFalse(second.server.handshakeSucceeded)
+
+        loop.advanceTime(by: .milliseconds(5))
+        XCTAssertNoThrow(try first.interactInMemory())
+        XCTAssertNoThrow(try second.interactInMemory())
+
+        XCTAssertEqual(batchKey.batchSizes, [2])
+        XCTAssertTrue(first.client.handshakeSucceeded)
+        XCTAssertTrue(first.server.handshakeSucceeded)
+        XCTAssertTrue(second.client.handshakeSucceeded)
+        XCTAssertTrue(second.server.handshakeSucceeded)
+    }
+
+    func testBatchingKeySubmitsFullBatchImmediately() throws {
+        let loop = EmbeddedEventLoop()
+        let batchKey = CustomBatchSigningKey(CustomPrivateKeyTests.customECDSACertAndKey.key,
+                                             signatureAlgorithms: [.ecdsaSecp256R1Sha256])
+        let key = NIOSSLBatchingCustomPrivateKey(key: batchKey, maximumBatchSize: 1, batchingWindow: .seconds(60))
+        let b2b = try assertNoThrowWithValue(self.batchingChannels(loop: loop, key: key))
+
+        XCTAssertNoThrow(try b2b.connectInMemory())
+        XCTAssertEqual(batchKey.batchSizes, [1])
+        XCTAssertTrue(b2b.client.handshakeSucceeded)
+        XCTAssertTrue(b2b.server.handshakeSucceeded)
+    }
 }
 
 
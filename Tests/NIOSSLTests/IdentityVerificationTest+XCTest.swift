@@ -55,6 +55,9 @@ extension IdentityVerificationTest {
                 ("testRejectsUnicodeCommonNameWithEncodedIDNALabel", testRejectsUnicodeCommonNameWithEncodedIDNALabel),
                 ("testHandlesMissingCommonName", testHandlesMissingCommonName),
                 ("testDoesNotFallBackToCNWithSans", testDoesNotFallBackToCNWithSans),
+                ("testSkipsNonStringSANs", testSkipsNonStringSANs),
+                ("testIdentityCanBeMatchedRepeatedly", testIdentityCanBeMatchedRepeatedly),
+                ("testPeerIdentitiesAreCachedWithVerifiedChains", testPeerIdentitiesAreCachedWithVerifiedChains),
            ]
    }
 }
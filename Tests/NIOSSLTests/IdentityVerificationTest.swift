@@ -14,6 +14,7 @@
 
 import XCTest
 import NIOCore
+import NIOEmbedded
 @testable import NIOSSL
 
 /// This cert contains the following SAN fields:
@@ -60,6 +61,27 @@ rwIUx8hwcI3A
 -----END CERTIFICATE-----
 """
 
+/// This cert contains the following SAN fields:
+/// otherName:1.3.6.1.4.1.311.20.2.3;UTF8:user@example.com - A UPN, which is not a string name type.
+/// dirName:/CN=directory.example.com/O=Example - A directory name, which is not a string name type.
+/// DNS:localhost - A plain DNS name, should match.
+///
+/// This also contains a commonName of othername.example.com.
+private let nonStringSANCert = """
+-----BEGIN CERTIFICATE-----
+MIIB1DCCAXugAwIBAgIUdi+9PAemBNQiYDNSvyOeOy3FBM8wCgYIKoZIzj0EAwIw
+IDEeMBwGA1UEAwwVb3RoZXJuYW1lLmV4YW1wbGUuY29tMCAXDTI2MTAxNjIzNTkw
+MFoYDzIxMjYwOTIyMjM1OTAwWjAgMR4wHAYDVQQDDBVvdGhlcm5hbWUuZXhhbXBs
+ZS5jb20wWTATBgcqhkjOPQIBBggqhkjOPQMBBwNCAAToBnXYcABLE6w8KrC2ax76
+QC05pWDeLd+M02sDf8qp0GLqwL1Nd5Bwo9MyQKUZDuTqum/flkDTYYQCGnw3QSOi
+o4GQMIGNMGwGA1UdEQRlMGOgIAYKKwYBBAGCNxQCA6ASDBB1c2VyQGV4YW1wbGUu
+Y29tpDQwMjEeMBwGA1UEAwwVZGlyZWN0b3J5LmV4YW1wbGUuY29tMRAwDgYDVQQK
+DAdFeGFtcGxlgglsb2NhbGhvc3QwHQYDVR0OBBYEFOe4zakl6CjhhisIV6cMZHmC
+A1RjMAoGCCqGSM49BAMCA0cAMEQCIAdfnAttT/Bm24Mrbvv/BMgynEEixLPy+eWR
+lZEqOZI6AiAUaiDsSxhwfDrR6ppUnyeB6nJisy/lG8JEJ0SK/uLB3g==
+-----END CERTIFICATE-----
+"""
+
 /// Returns whether this system supports resolving IPv6 function.
 func ipv6Supported() throws -> Bool {
     do {
@@ -318,4 +340,56 @@ class IdentityVerificationTest: XCTestCase {
                                                   leafCertificate: cert)
         XCTAssertFalse(matched)
     }
+
+    func testSkipsNonStringSANs() throws {
+        let cert = try NIOSSLCertificate(bytes: .init(nonStringSANCert.utf8), format: .pem)
+        let address = try SocketAddress(unixDomainSocketPath: "/path")
+
+        XCTAssertTrue(try validIdentityForService(serverHostname: "localhost", socketAddress: address, leafCertificate: cert))
+        XCTAssertFalse(try validIdentityForService(serverHostname: "directory.example.com", socketAddress: address, leafCertificate: cert))
+        XCTAssertFalse(try validIdentityForService(serverHostname: "othername.example.com", socketAddress: address, leafCertificate: cert))
+    }
+
+    func testIdentityCanBeMatchedRepeatedly() throws {
+        let cert = try NIOSSLCertificate(bytes: .init(weirdoPEMCert.utf8), format: .pem)
+        let identity = CertificateIdentity(leafCertificate: cert)
+        let address = try SocketAddress(unixDomainSocketPath: "/path")
+
+        XCTAssertTrue(try identity.matches(serverHostname: "this.wildcard.example.com", socketAddress: address))
+        XCTAssertTrue(try identity.matches(serverHostname: "BAZ.example.com.", socketAddress: address))
+        XCTAssertTrue(try identity.matches(serverHostname: "trailing.period.example.com", socketAddress: address))
+        XCTAssertFalse(try identity.matches(serverHostname: "ar.example.com", socketAddress: address))
+        XCTAssertFalse(try identity.matches(serverHostname: "wildcard.example.com", socketAddress: address))
+        XCTAssertFalse(try identity.matches(serverHostname: nil, socketAddress: address))
+    }
+
+    func testPeerIdentitiesAreCachedWithVerifiedChains() throws {
+        let (serverCert, serverKey) = generateSelfSignedCert()
+        let serverContext = try assertNoThrowWithValue(NIOSSLContext(configuration: .makeServerConfiguration(
+            certificateChain: [.certificate(serverCert)],
+            privateKey: .privateKey(serverKey)
+        )))
+
+        var clientConfig = TLSConfiguration.makeClientConfiguration()
+        clientConfig.trustRoots = .certificates([serverCert])
+        clientConfig.verifiedChainCache = .init()
+        clientConfig.certificateBufferPool = NIOSSLCertificateBufferPool()
+        let clientContext = try assertNoThrowWithValue(NIOSSLContext(configuration: clientConfig))
+        XCTAssertEqual(clientContext.certificateIdentities?.count, 0)
+
+        func connect(serverHostname: String) throws {
+            let b2b = BackToBackEmbeddedChannel()
+            try b2b.client.pipeline.syncOperations.addHandler(NIOSSLClientHandler(context: clientContext, serverHostname: serverHostname))
+            try b2b.server.pipeline.syncOperations.addHandler(NIOSSLServerHandler(context: serverContext))
+            try b2b.connectInMemory()
+        }
+
+        XCTAssertNoThrow(try connect(serverHostname: "localhost"))
+        XCTAssertNoThrow(try connect(serverHostname: "localhost"))
+        XCTAssertEqual(clientContext.certificateIdentities?.count, 1)
+
+        // The cached identity is still matched against the hostname of each connection.
+        XCTAssertThrowsError(try connect(serverHostname: "example.com"))
+        XCTAssertEqual(clientContext.certificateIdentities?.count, 1)
+    }
 }
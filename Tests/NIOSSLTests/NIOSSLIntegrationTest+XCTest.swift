@@ -63,8 +63,54 @@ extension NIOSSLIntegrationTest {
                 ("testKeyLoggingClientAndServer", testKeyLoggingClientAndServer),
                 ("testLoadsOfCloses", testLoadsOfCloses),
                 ("testWriteFromFailureOfWrite", testWriteFromFailureOfWrite),
+                ("testSmallWritesAreCoalescedIntoFullRecords", testSmallWritesAreCoalescedIntoFullRecords),
+                ("testDynamicRecordSizing", testDynamicRecordSizing),
+                ("testDynamicRecordSizingRampsUpWithinASingleWrite", testDynamicRecordSizingRampsUpWithinASingleWrite),
+                ("testKernelTLSOffloadFallsBackWithoutSocket", testKernelTLSOffloadFallsBackWithoutSocket),
+                ("testFlushingPendingHandshakeDataFailsAfterShutdown", testFlushingPendingHandshakeDataFailsAfterShutdown),
+                ("testKernelTLSOffloadEcho", testKernelTLSOffloadEcho),
+                ("testThreadPoolPrivateKeyEcho", testThreadPoolPrivateKeyEcho),
+                ("testThreadPoolPrivateKeyRejectsCustomKeys", testThreadPoolPrivateKeyRejectsCustomKeys),
+                ("testKeySharePoolSuppliesBothPeers", testKeySharePoolSuppliesBothPeers),
+                ("testKeySharePoolSuppliesSecp256r1KeyPairs", testKeySharePoolSuppliesSecp256r1KeyPairs),
+                ("testKeySharePoolDropsStocksOfReleasedEventLoops", testKeySharePoolDropsStocksOfReleasedEventLoops),
+                ("testKeySharePoolFallsBackWhenEmpty", testKeySharePoolFallsBackWhenEmpty),
                 ("testChannelInactiveDuringHandshakeSucceeded", testChannelInactiveDuringHandshakeSucceeded),
                 ("testTrustedFirst", testTrustedFirst),
+                ("testInPlaceDecryptionTLS12", testInPlaceDecryptionTLS12),
+                ("testInPlaceDecryptionIsIgnoredForTLS13", testInPlaceDecryptionIsIgnoredForTLS13),
+                ("testInPlaceDecryptionOfRecordsSplitAcrossReads", testInPlaceDecryptionOfRecordsSplitAcrossReads),
+                ("testUniquelyReferencedCiphertextIsDecryptedInItsOwnStorage", testUniquelyReferencedCiphertextIsDecryptedInItsOwnStorage),
+                ("testChannelReadDecryptsOneCopyOfTheCiphertext", testChannelReadDecryptsOneCopyOfTheCiphertext),
+                ("testDirectEncryptionTLS12", testDirectEncryptionTLS12),
+                ("testDirectEncryptionWithInPlaceDecryption", testDirectEncryptionWithInPlaceDecryption),
+                ("testDirectEncryptionIsIgnoredForTLS13", testDirectEncryptionIsIgnoredForTLS13),
+                ("testSmallWritesAreGatheredIntoRecords", testSmallWritesAreGatheredIntoRecords),
+                ("testNoEarlyDataOnFirstConnection", testNoEarlyDataOnFirstConnection),
+                ("testEarlyDataAcceptedOnResumption", testEarlyDataAcceptedOnResumption),
+                ("testResumptionWithoutEarlyWritesCompletesHandshake", testResumptionWithoutEarlyWritesCompletesHandshake),
+                ("testRejectedEarlyDataIsResent", testRejectedEarlyDataIsResent),
+                ("testServerWithEarlyDataDisabledRejectsEarlyData", testServerWithEarlyDataDisabledRejectsEarlyData),
+                ("testExportedConnectionResumesInNewChannel", testExportedConnectionResumesInNewChannel),
+                ("testUnconsumedDataMovesWithConnection", testUnconsumedDataMovesWithConnection),
+                ("testTLS13ConnectionCannotBeExported", testTLS13ConnectionCannotBeExported),
+                ("testConnectionWithPendingWritesCannotBeExported", testConnectionWithPendingWritesCannotBeExported),
+                ("testInvalidHandbackIsRejected", testInvalidHandbackIsRejected),
+                ("testHintsReplaceFrontEndSignature", testHintsReplaceFrontEndSignature),
+                ("testMissingHintsFallBackToFrontEndKey", testMissingHintsFallBackToFrontEndKey),
+                ("testTLS12HintsAreEmpty", testTLS12HintsAreEmpty),
+                ("testInvalidClientHelloIsRejected", testInvalidClientHelloIsRejected),
+                ("testHandshakeWaitsForSelectedIdentity", testHandshakeWaitsForSelectedIdentity),
+                ("testNilIdentityUsesConfiguredIdentity", testNilIdentityUsesConfiguredIdentity),
+                ("testStoreMatchSkipsCallback", testStoreMatchSkipsCallback),
+                ("testFailedSelectionFailsHandshake", testFailedSelectionFailsHandshake),
+                ("testExactNameSelectsIdentity", testExactNameSelectsIdentity),
+                ("testWildcardNameSelectsIdentity", testWildcardNameSelectsIdentity),
+                ("testUnknownOrMissingNameUsesConfiguredIdentity", testUnknownOrMissingNameUsesConfiguredIdentity),
+                ("testCertificateStoreChangesApplyToLaterHandshakes", testCertificateStoreChangesApplyToLaterHandshakes),
+                ("testInvalidCertificateStoreNamesAreRejected", testInvalidCertificateStoreNamesAreRejected),
+                ("testSetCredentialsAppliesToNewHandshakes", testSetCredentialsAppliesToNewHandshakes),
+                ("testSetCredentialsRejectsMismatchedKey", testSetCredentialsRejectsMismatchedKey),
            ]
    }
 }
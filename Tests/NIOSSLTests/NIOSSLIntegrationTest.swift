@@ -34,6 +34,24 @@ public func assertNoThrowWithValue<T>(_ body: @autoclosure () throws -> T, defau
     }
 }
 
+/// The body lengths of the TLS records in a buffer of ciphertext.
+private func recordLengths(_ ciphertext: ByteBuffer) -> [Int] {
+    var records = ciphertext
+    var lengths: [Int] = []
+    while let recordLength = records.getInteger(at: records.readerIndex + 3, as: UInt16.self),
+          records.readableBytes >= 5 + Int(recordLength) {
+        records.moveReaderIndex(forwardBy: 5 + Int(recordLength))
+        lengths.append(Int(recordLength))
+    }
+    XCTAssertEqual(records.readableBytes, 0, "Truncated record")
+    return lengths
+}
+
+/// Counts the TLS records in a buffer of ciphertext.
+private func recordCount(_ ciphertext: ByteBuffer) -> Int {
+    return recordLengths(ciphertext).count
+}
+
 internal func interactInMemory(clientChannel: EmbeddedChannel, serverChannel: EmbeddedChannel) throws {
     var workToDo = true
     while workToDo {
@@ -402,6 +420,59 @@ fileprivate func _clientTLSChannel<TLS: NIOClientTLSProvider>(context: NIOSSLCon
     .wait(), file: file, line: line)
 }
 
+/// Records early data events and reads, in the order they were delivered.
+private final class EarlyDataRecorder: ChannelInboundHandler {
+    typealias InboundIn = ByteBuffer
+
+    enum Record: Equatable {
+        case event(NIOSSLEarlyDataEvent)
+        case read(String)
+    }
+
+    var records: [Record] = []
+
+    func channelRead(context: ChannelHandlerContext, data: NIOAny) {
+        let buffer = self.unwrapInboundIn(data)
+        self.records.append(.read(String(decoding: buffer.readableBytesView, as: UTF8.self)))
+    }
+
+    func userInboundEventTriggered(context: ChannelHandlerContext, event: Any) {
+        if let event = event as? NIOSSLEarlyDataEvent {
+            self.records.append(.event(event))
+        }
+        context.fireUserInboundEventTriggered(event)
+    }
+}
+
+/// A private key for the front end, which does not hold the real key. It counts the signatures it is asked
+/// for, and fails them.
+private final class UnavailablePrivateKey: NIOSSLCustomPrivateKey, Hashable {
+    struct KeyUnavailable: Error { }
+
+    var signCallCount = 0
+
+    var signatureAlgorithms: [SignatureAlgorithm] {
+        return [.rsaPssRsaeSha256, .rsaPkcs1Sha256]
+    }
+
+    func sign(channel: Channel, algorithm: SignatureAlgorithm, data: ByteBuffer) -> EventLoopFuture<ByteBuffer> {
+        self.signCallCount += 1
+        return channel.eventLoop.makeFailedFuture(KeyUnavailable())
+    }
+
+    func decrypt(channel: Channel, data: ByteBuffer) -> EventLoopFuture<ByteBuffer> {
+        return channel.eventLoop.makeFailedFuture(KeyUnavailable())
+    }
+
+    static func ==(lhs: UnavailablePrivateKey, rhs: UnavailablePrivateKey) -> Bool {
+        return lhs === rhs
+    }
+
+    func hash(into hasher: inout Hasher) {
+        hasher.combine(ObjectIdentifier(self))
+    }
+}
+
 class NIOSSLIntegrationTest: XCTestCase {
     static var cert: NIOSSLCertificate!
     static var key: NIOSSLPrivateKey!
@@ -2046,6 +2117,365 @@ class NIOSSLIntegrationTest: XCTestCase {
         serverChannel.pipeline.fireChannelInactive()
     }
 
+    func testSmallWritesAreCoalescedIntoFullRecords() throws {
+        let context = try configuredSSLContext()
+        let b2b = BackToBackEmbeddedChannel()
+        XCTAssertNoThrow(try b2b.server.pipeline.syncOperations.addHandler(NIOSSLServerHandler(context: context)))
+        XCTAssertNoThrow(try b2b.client.pipeline.syncOperations.addHandler(try NIOSSLClientHandler(context: context, serverHostname: nil)))
+        XCTAssertNoThrow(try b2b.connectInMemory())
+
+        // 100 writes of 512 bytes should fit into 4 records of up to 16kB.
+        let writeFutures: [EventLoopFuture<Void>] = (0..<100).map { i in
+            b2b.client.write(ByteBuffer(repeating: UInt8(i), count: 512))
+        }
+        b2b.client.flush()
+
+        var ciphertext = b2b.client.allocator.buffer(capacity: 1024)
+        while case .some(.byteBuffer(var data)) = try b2b.client.readOutbound(as: IOData.self) {
+            ciphertext.writeBuffer(&data)
+        }
+        XCTAssertNoThrow(try EventLoopFuture<Void>.andAllSucceed(writeFutures, on: b2b.client.eventLoop).wait())
+
+        XCTAssertEqual(recordCount(ciphertext), 4)
+
+        // The server sees the writes in order.
+        XCTAssertNoThrow(try b2b.server.writeInbound(ciphertext))
+        var received = b2b.server.allocator.buffer(capacity: 51200)
+        while var data = try b2b.server.readInbound(as: ByteBuffer.self) {
+            received.writeBuffer(&data)
+        }
+        XCTAssertEqual(received.readableBytes, 51200)
+        for i in 0..<100 {
+            XCTAssertEqual(received.readSlice(length: 512), ByteBuffer(repeating: UInt8(i), count: 512))
+        }
+    }
+
+    func testDynamicRecordSizing() throws {
+        var config = TLSConfiguration.makeServerConfiguration(
+            certificateChain: [.certificate(NIOSSLIntegrationTest.cert)],
+            privateKey: .privateKey(NIOSSLIntegrationTest.key)
+        )
+        config.trustRoots = .certificates([NIOSSLIntegrationTest.cert])
+        config.dynamicRecordSizing = NIOSSLDynamicRecordSizing(initialRecordSize: 1024, boostThreshold: 8192, idleTimeout: .hours(1))
+        let context = try assertNoThrowWithValue(NIOSSLContext(configuration: config))
+
+        let b2b = BackToBackEmbeddedChannel()
+        XCTAssertNoThrow(try b2b.server.pipeline.syncOperations.addHandler(NIOSSLServerHandler(context: context)))
+        XCTAssertNoThrow(try b2b.client.pipeline.syncOperations.addHandler(try NIOSSLClientHandler(context: context, serverHostname: nil)))
+        XCTAssertNoThrow(try b2b.connectInMemory())
+
+        func flushedRecordCount() throws -> Int {
+            var ciphertext = b2b.client.allocator.buffer(capacity: 1024)
+            while case .some(.byteBuffer(var data)) = try b2b.client.readOutbound(as: IOData.self) {
+                ciphertext.writeBuffer(&data)
+            }
+            return recordCount(ciphertext)
+        }
+
+        // The first 8kB go out in 1kB records.
+        b2b.client.writeAndFlush(ByteBuffer(repeating: 0, count: 8192), promise: nil)
+        XCTAssertEqual(try flushedRecordCount(), 8)
+
+        // After that, the connection is warmed up.
+        b2b.client.writeAndFlush(ByteBuffer(repeating: 0, count: 8192), promise: nil)
+        XCTAssertEqual(try flushedRecordCount(), 1)
+    }
+
+    func testDynamicRecordSizingRampsUpWithinASingleWrite() throws {
+        var config = TLSConfiguration.makeServerConfiguration(
+            certificateChain: [.certificate(NIOSSLIntegrationTest.cert)],
+            privateKey: .privateKey(NIOSSLIntegrationTest.key)
+        )
+        config.trustRoots = .certificates([NIOSSLIntegrationTest.cert])
+        config.dynamicRecordSizing = NIOSSLDynamicRecordSizing(initialRecordSize: 1024, boostThreshold: 8192, idleTimeout: .hours(1))
+        let context = try assertNoThrowWithValue(NIOSSLContext(configuration: config))
+
+        let b2b = BackToBackEmbeddedChannel()
+        XCTAssertNoThrow(try b2b.server.pipeline.syncOperations.addHandler(NIOSSLServerHandler(context: context)))
+        XCTAssertNoThrow(try b2b.client.pipeline.syncOperations.addHandler(try NIOSSLClientHandler(context: context, serverHostname: nil)))
+        XCTAssertNoThrow(try b2b.connectInMemory())
+
+        // The first 8kB of the write go out in 1kB records, and the other 16kB in a single full-size record.
+        let writeFuture = b2b.client.writeAndFlush(ByteBuffer(repeating: 0, count: 8192 + SSL_MAX_RECORD_SIZE))
+        var ciphertext = b2b.client.allocator.buffer(capacity: 32768)
+        while case .some(.byteBuffer(var data)) = try b2b.client.readOutbound(as: IOData.self) {
+            ciphertext.writeBuffer(&data)
+        }
+        XCTAssertNoThrow(try writeFuture.wait())
+
+        let lengths = recordLengths(ciphertext)
+        XCTAssertEqual(lengths.count, 9)
+        XCTAssertEqual(Set(lengths.prefix(8)).count, 1)
+        XCTAssertGreaterThan(lengths.last!, lengths.first! + 8192)
+
+        // The server sees the whole write.
+        XCTAssertNoThrow(try b2b.server.writeInbound(ciphertext))
+        var received = 0
+        while let buffer = try b2b.server.readInbound(as: ByteBuffer.self) {
+            received += buffer.readableBytes
+        }
+        XCTAssertEqual(received, 8192 + SSL_MAX_RECORD_SIZE)
+    }
+
+    func testKernelTLSOffloadFallsBackWithoutSocket() throws {
+        var config = TLSConfiguration.makeServerConfiguration(
+            certificateChain: [.certificate(NIOSSLIntegrationTest.cert)],
+            privateKey: .privateKey(NIOSSLIntegrationTest.key)
+        )
+        config.trustRoots = .certificates([NIOSSLIntegrationTest.cert])
+        config.enableKernelTLSOffload = true
+        let context = try assertNoThrowWithValue(NIOSSLContext(configuration: config))
+
+        let b2b = BackToBackEmbeddedChannel()
+        XCTAssertNoThrow(try b2b.server.pipeline.syncOperations.addHandler(NIOSSLServerHandler(context: context)))
+        XCTAssertNoThrow(try b2b.client.pipeline.syncOperations.addHandler(try NIOSSLClientHandler(context: context, serverHostname: nil)))
+
+        // Data written before the handshake completes is held until the offload attempt is over.
+        let serverWrite = b2b.server.writeAndFlush(ByteBuffer(string: "early"))
+        XCTAssertNoThrow(try b2b.connectInMemory())
+        XCTAssertNoThrow(try b2b.interactInMemory())
+        XCTAssertNoThrow(try serverWrite.wait())
+        XCTAssertEqual(try b2b.client.readInbound(as: ByteBuffer.self), ByteBuffer(string: "early"))
+
+        // Embedded channels have no socket, so the connection stays in user space.
+        b2b.client.writeAndFlush(ByteBuffer(string: "hello"), promise: nil)
+        XCTAssertNoThrow(try b2b.interactInMemory())
+        XCTAssertEqual(try b2b.server.readInbound(as: ByteBuffer.self), ByteBuffer(string: "hello"))
+
+        let closeFuture = b2b.client.close()
+        XCTAssertNoThrow(try b2b.interactInMemory())
+        XCTAssertNoThrow(try closeFuture.wait())
+    }
+
+    func testFlushingPendingHandshakeDataFailsAfterShutdown() throws {
+        var config = TLSConfiguration.makeServerConfiguration(
+            certificateChain: [.certificate(NIOSSLIntegrationTest.cert)],
+            privateKey: .privateKey(NIOSSLIntegrationTest.key)
+        )
+        config.trustRoots = .certificates([NIOSSLIntegrationTest.cert])
+        let context = try assertNoThrowWithValue(NIOSSLContext(configuration: config))
+
+        let b2b = BackToBackEmbeddedChannel()
+        let serverHandler = NIOSSLServerHandler(context: context)
+        XCTAssertNoThrow(try b2b.server.pipeline.syncOperations.addHandler(serverHandler))
+        XCTAssertNoThrow(try b2b.client.pipeline.syncOperations.addHandler(try NIOSSLClientHandler(context: context, serverHostname: nil)))
+        XCTAssertNoThrow(try b2b.connectInMemory())
+
+        XCTAssertTrue(serverHandler.connection.flushPendingHandshakeData())
+
+        // Once close_notify has been sent nothing more can be written, and the zero-length write reports an error.
+        _ = serverHandler.connection.doShutdown()
+        XCTAssertFalse(serverHandler.connection.flushPendingHandshakeData())
+    }
+
+    func testKernelTLSOffloadEcho() throws {
+        // Whether or not this kernel supports TLS offload, the connection must keep working.
+        for version in [TLSVersion.tlsv12, .tlsv13] {
+            var config = TLSConfiguration.makeServerConfiguration(
+                certificateChain: [.certificate(NIOSSLIntegrationTest.cert)],
+                privateKey: .privateKey(NIOSSLIntegrationTest.key)
+            )
+            config.trustRoots = .certificates([NIOSSLIntegrationTest.cert])
+            config.maximumTLSVersion = version
+            config.enableKernelTLSOffload = true
+            let context = try assertNoThrowWithValue(NIOSSLContext(configuration: config))
+
+            let group = MultiThreadedEventLoopGroup(numberOfThreads: 1)
+            defer {
+                XCTAssertNoThrow(try group.syncShutdownGracefully())
+            }
+
+            let completionPromise: EventLoopPromise<ByteBuffer> = group.next().makePromise()
+            let serverChannel = try serverTLSChannel(context: context, handlers: [SimpleEchoServer()], group: group)
+            defer {
+                XCTAssertNoThrow(try serverChannel.close().wait())
+            }
+
+            let clientChannel = try clientTLSChannel(context: context,
+                                                     preHandlers: [],
+                                                     postHandlers: [PromiseOnReadHandler(promise: completionPromise)],
+                                                     group: group,
+                                                     connectingTo: serverChannel.localAddress!)
+            defer {
+                XCTAssertNoThrow(try clientChannel.close().wait())
+            }
+
+            let originalBuffer = ByteBuffer(string: "Hello")
+            XCTAssertNoThrow(try clientChannel.writeAndFlush(originalBuffer).wait())
+            XCTAssertEqual(try completionPromise.futureResult.wait(), originalBuffer)
+        }
+    }
+
+    func testThreadPoolPrivateKeyEcho() throws {
+        let threadPool = NIOThreadPool(numberOfThreads: 1)
+        threadPool.start()
+        defer {
+            XCTAssertNoThrow(try threadPool.syncShutdownGracefully())
+        }
+
+        let rsa = (NIOSSLIntegrationTest.cert!, NIOSSLIntegrationTest.key!)
+        let ecdsa = generateSelfSignedCert(keygenFunction: { generateECPrivateKey() })
+        for (cert, key) in [rsa, ecdsa] {
+            for version in [TLSVersion.tlsv12, .tlsv13] {
+                let offloadedKey = try assertNoThrowWithValue(NIOSSLThreadPoolPrivateKey(key: key, threadPool: threadPool))
+                var serverConfig = TLSConfiguration.makeServerConfiguration(
+                    certificateChain: [.certificate(cert)],
+                    privateKey: .privateKey(NIOSSLPrivateKey(customPrivateKey: offloadedKey))
+                )
+                serverConfig.maximumTLSVersion = version
+                let serverContext = try assertNoThrowWithValue(NIOSSLContext(configuration: serverConfig))
+
+                var clientConfig = TLSConfiguration.makeClientConfiguration()
+                clientConfig.trustRoots = .certificates([cert])
+                let clientContext = try assertNoThrowWithValue(NIOSSLContext(configuration: clientConfig))
+
+                let group = MultiThreadedEventLoopGroup(numberOfThreads: 1)
+                defer {
+                    XCTAssertNoThrow(try group.syncShutdownGracefully())
+                }
+
+                let completionPromise: EventLoopPromise<ByteBuffer> = group.next().makePromise()
+                let serverChannel = try serverTLSChannel(context: serverContext, handlers: [SimpleEchoServer()], group: group)
+                defer {
+                    XCTAssertNoThrow(try serverChannel.close().wait())
+                }
+
+                let clientChannel = try clientTLSChannel(context: clientContext,
+                                                         preHandlers: [],
+                                                         postHandlers: [PromiseOnReadHandler(promise: completionPromise)],
+                                                         group: group,
+                                                         connectingTo: serverChannel.localAddress!)
+                defer {
+                    XCTAssertNoThrow(try clientChannel.close().wait())
+                }
+
+                let originalBuffer = ByteBuffer(string: "Hello")
+                XCTAssertNoThrow(try clientChannel.writeAndFlush(originalBuffer).wait())
+                XCTAssertEqual(try completionPromise.futureResult.wait(), originalBuffer)
+            }
+        }
+    }
+
+    func testThreadPoolPrivateKeyRejectsCustomKeys() throws {
+        let threadPool = NIOThreadPool(numberOfThreads: 1)
+        let offloadedKey = try assertNoThrowWithValue(NIOSSLThreadPoolPrivateKey(key: NIOSSLIntegrationTest.key, threadPool: threadPool))
+        XCTAssertThrowsError(try NIOSSLThreadPoolPrivateKey(key: NIOSSLPrivateKey(customPrivateKey: offloadedKey),
+                                                            threadPool: threadPool)) { error in
+            XCTAssertEqual(error as? NIOSSLError, .failedToLoadPrivateKey)
+        }
+    }
+
+    private func echoWithKeySharePool(_ pool: NIOSSLKeySharePool,
+                                      group: EventLoopGroup,
+                                      keyExchangeGroups: [NIOSSLKeyExchangeGroup]? = nil) throws {
+        var serverConfig = TLSConfiguration.makeServerConfiguration(
+            certificateChain: [.certificate(NIOSSLIntegrationTest.cert)],
+            privateKey: .privateKey(NIOSSLIntegrationTest.key)
+        )
+        serverConfig.keySharePool = pool
+        serverConfig.keyExchangeGroups = keyExchangeGroups
+        let serverContext = try NIOSSLContext(configuration: serverConfig)
+
+        var clientConfig = TLSConfiguration.makeClientConfiguration()
+        clientConfig.trustRoots = .certificates([NIOSSLIntegrationTest.cert])
+        clientConfig.keySharePool = pool
+        clientConfig.keyExchangeGroups = keyExchangeGroups
+        let clientContext = try NIOSSLContext(configuration: clientConfig)
+
+        let completionPromise: EventLoopPromise<ByteBuffer> = group.next().makePromise()
+        let serverChannel = try serverTLSChannel(context: serverContext, handlers: [SimpleEchoServer()], group: group)
+        defer {
+            XCTAssertNoThrow(try serverChannel.close().wait())
+        }
+
+        let clientChannel = try clientTLSChannel(context: clientContext,
+                                                 preHandlers: [],
+                                                 postHandlers: [PromiseOnReadHandler(promise: completionPromise)],
+                                                 group: group,
+                                                 connectingTo: serverChannel.localAddress!)
+        defer {
+            XCTAssertNoThrow(try clientChannel.close().wait())
+        }
+
+        let originalBuffer = ByteBuffer(string: "Hello")
+        XCTAssertNoThrow(try clientChannel.writeAndFlush(originalBuffer).wait())
+        XCTAssertEqual(try completionPromise.futureResult.wait(), originalBuffer)
+    }
+
+    func testKeySharePoolSuppliesBothPeers() throws {
+        let threadPool = NIOThreadPool(numberOfThreads: 1)
+        threadPool.start()
+        defer {
+            XCTAssertNoThrow(try threadPool.syncShutdownGracefully())
+        }
+        let group = MultiThreadedEventLoopGroup(numberOfThreads: 1)
+        defer {
+            XCTAssertNoThrow(try group.syncShutdownGracefully())
+        }
+
+        let pool = NIOSSLKeySharePool(groups: [.x25519], keyPairsPerGroup: 4, threadPool: threadPool)
+        let eventLoop = group.next()
+        XCTAssertNoThrow(try pool.prefill(eventLoop: eventLoop).wait())
+        XCTAssertEqual(pool.availableKeyPairs(for: .x25519, eventLoop: eventLoop), 4)
+
+        XCTAssertNoThrow(try self.echoWithKeySharePool(pool, group: group))
+
+        // The client's key share and the server's each used one key pair, leaving enough not to refill.
+        XCTAssertEqual(pool.availableKeyPairs(for: .x25519, eventLoop: eventLoop), 2)
+    }
+
+    func testKeySharePoolSuppliesSecp256r1KeyPairs() throws {
+        let threadPool = NIOThreadPool(numberOfThreads: 1)
+        threadPool.start()
+        defer {
+            XCTAssertNoThrow(try threadPool.syncShutdownGracefully())
+        }
+        let group = MultiThreadedEventLoopGroup(numberOfThreads: 1)
+        defer {
+            XCTAssertNoThrow(try group.syncShutdownGracefully())
+        }
+
+        let pool = NIOSSLKeySharePool(groups: [.secp256r1], keyPairsPerGroup: 4, threadPool: threadPool)
+        let eventLoop = group.next()
+        XCTAssertNoThrow(try pool.prefill(eventLoop: eventLoop).wait())
+        XCTAssertEqual(pool.availableKeyPairs(for: .secp256r1, eventLoop: eventLoop), 4)
+
+        // Only offering P-256 makes both peers use it, so the handshake only succeeds if the pooled P-256 key pairs
+        // are usable.
+        XCTAssertNoThrow(try self.echoWithKeySharePool(pool, group: group, keyExchangeGroups: [.secp256r1]))
+        XCTAssertEqual(pool.availableKeyPairs(for: .secp256r1, eventLoop: eventLoop), 2)
+    }
+
+    func testKeySharePoolDropsStocksOfReleasedEventLoops() throws {
+        let threadPool = NIOThreadPool(numberOfThreads: 1)
+        let pool = NIOSSLKeySharePool(groups: [.x25519], keyPairsPerGroup: 4, threadPool: threadPool)
+
+        var firstLoop: EmbeddedEventLoop? = EmbeddedEventLoop()
+        XCTAssertEqual(pool.availableKeyPairs(for: .x25519, eventLoop: firstLoop!), 0)
+        XCTAssertEqual(pool.stockCount, 1)
+        firstLoop = nil
+
+        let secondLoop = EmbeddedEventLoop()
+        XCTAssertEqual(pool.availableKeyPairs(for: .x25519, eventLoop: secondLoop), 0)
+        XCTAssertEqual(pool.stockCount, 1)
+    }
+
+    func testKeySharePoolFallsBackWhenEmpty() throws {
+        let threadPool = NIOThreadPool(numberOfThreads: 1)
+        threadPool.start()
+        defer {
+            XCTAssertNoThrow(try threadPool.syncShutdownGracefully())
+        }
+        let group = MultiThreadedEventLoopGroup(numberOfThreads: 1)
+        defer {
+            XCTAssertNoThrow(try group.syncShutdownGracefully())
+        }
+
+        // Nothing has been generated yet, so both peers generate their key pairs inline.
+        let pool = NIOSSLKeySharePool(groups: [.x25519, .secp256r1], keyPairsPerGroup: 4, threadPool: threadPool)
+        XCTAssertNoThrow(try self.echoWithKeySharePool(pool, group: group))
+    }
+
     func testChannelInactiveDuringHandshakeSucceeded() throws {
         // This test aims to reproduce a very unusual crash. I've never been able to come up with a clear justification of
         // how we managed to hit it, but it goes a bit like this:
@@ -2180,4 +2610,722 @@ class NIOSSLIntegrationTest: XCTestCase {
         let newBuffer = try completionPromise.futureResult.wait()
         XCTAssertEqual(newBuffer, originalBuffer)
     }
+
+    /// Creates a pair of channels that have completed a handshake with `serverContext`, whose client trusts the shared
+    /// test identity.
+    private func connectedTestChannels(serverContext: NIOSSLContext,
+                                       maximumTLSVersion: TLSVersion) throws -> BackToBackEmbeddedChannel {
+        var clientConfig = TLSConfiguration.makeTestClientConfiguration()
+        clientConfig.maximumTLSVersion = maximumTLSVersion
+        let b2b = try BackToBackEmbeddedChannel(clientContext: NIOSSLContext(configuration: clientConfig),
+                                                serverContext: serverContext,
+                                                serverHostname: "localhost")
+        try b2b.handshakeInMemory()
+        return b2b
+    }
+
+    /// Creates a pair of channels that have completed a handshake with a server presenting the shared test identity.
+    /// `serverConfigurationTransform` adjusts the server's configuration.
+    private func connectedTestChannels(maximumTLSVersion: TLSVersion,
+                                       serverConfigurationTransform: (inout TLSConfiguration) -> Void) throws -> BackToBackEmbeddedChannel {
+        var serverConfig = TLSConfiguration.makeTestServerConfiguration()
+        serverConfigurationTransform(&serverConfig)
+        return try self.connectedTestChannels(serverContext: NIOSSLContext(configuration: serverConfig),
+                                              maximumTLSVersion: maximumTLSVersion)
+    }
+
+    private func readAllInbound(_ channel: EmbeddedChannel) throws -> (String, reads: Int) {
+        var received = ""
+        var reads = 0
+        while let buffer = try channel.readInbound(as: ByteBuffer.self) {
+            received += String(decoding: buffer.readableBytesView, as: UTF8.self)
+            reads += 1
+        }
+        return (received, reads)
+    }
+
+    private func storageIdentity(of buffer: ByteBuffer) -> ObjectIdentifier {
+        return buffer.withUnsafeReadableBytesWithStorageManagement { _, storage in
+            ObjectIdentifier(storage.takeUnretainedValue())
+        }
+    }
+
+    private func assertServerDecryptsInPlace(maximumTLSVersion: TLSVersion) throws {
+        let b2b = try assertNoThrowWithValue(self.connectedTestChannels(maximumTLSVersion: maximumTLSVersion) {
+            $0.enableInPlaceDecryption = true
+        })
+        let largeMessage = String(repeating: "x", count: 40_000)
+
+        b2b.client.write(ByteBuffer(string: "hello, "), promise: nil)
+        b2b.client.write(ByteBuffer(string: "world"), promise: nil)
+        b2b.client.writeAndFlush(ByteBuffer(string: largeMessage), promise: nil)
+        XCTAssertNoThrow(try b2b.interactInMemory())
+        XCTAssertEqual(try self.readAllInbound(b2b.server).0, "hello, world" + largeMessage)
+
+        // A clean shutdown exercises the close_notify path.
+        let closeFuture = b2b.client.close()
+        XCTAssertNoThrow(try b2b.interactInMemory())
+        XCTAssertNoThrow(try closeFuture.wait())
+        XCTAssertFalse(b2b.server.isActive)
+    }
+
+    func testInPlaceDecryptionTLS12() throws {
+        try self.assertServerDecryptsInPlace(maximumTLSVersion: .tlsv12)
+    }
+
+    func testInPlaceDecryptionIsIgnoredForTLS13() throws {
+        try self.assertServerDecryptsInPlace(maximumTLSVersion: .tlsv13)
+    }
+
+    func testInPlaceDecryptionOfRecordsSplitAcrossReads() throws {
+        let b2b = try assertNoThrowWithValue(self.connectedTestChannels(maximumTLSVersion: .tlsv12) {
+            $0.enableInPlaceDecryption = true
+        })
+        b2b.client.write(ByteBuffer(string: "first"), promise: nil)
+        b2b.client.writeAndFlush(ByteBuffer(string: "second"), promise: nil)
+
+        guard case .some(.byteBuffer(var ciphertext)) = try b2b.client.readOutbound(as: IOData.self) else {
+            XCTFail("No ciphertext written")
+            return
+        }
+
+        // Deliver the two records a few bytes at a time, so that record boundaries fall mid-read.
+        while ciphertext.readableBytes > 0 {
+            let chunk = ciphertext.readSlice(length: min(7, ciphertext.readableBytes))!
+            XCTAssertNoThrow(try b2b.server.writeInbound(chunk))
+        }
+
+        let (received, reads) = try self.readAllInbound(b2b.server)
+        XCTAssertEqual(received, "firstsecond")
+        XCTAssertEqual(reads, 2)
+    }
+
+    func testUniquelyReferencedCiphertextIsDecryptedInItsOwnStorage() throws {
+        let b2b = try assertNoThrowWithValue(self.connectedTestChannels(maximumTLSVersion: .tlsv12) {
+            $0.enableInPlaceDecryption = true
+        })
+        b2b.client.writeAndFlush(ByteBuffer(string: "hello"), promise: nil)
+        guard case .some(.byteBuffer(var ciphertext)) = try b2b.client.readOutbound(as: IOData.self) else {
+            XCTFail("No ciphertext written")
+            return
+        }
+
+        let serverHandler = try assertNoThrowWithValue(b2b.server.pipeline.handler(type: NIOSSLServerHandler.self).wait())
+        let connection = serverHandler.connection
+        XCTAssertTrue(connection.canReadDataInPlace)
+
+        let storage = ciphertext.withUnsafeReadableBytes { bytes -> Range<UInt> in
+            let start = UInt(bitPattern: bytes.baseAddress)
+            return start..<(start + UInt(bytes.count))
+        }
+        var plaintext: [ByteBuffer] = []
+        guard case .complete = connection.readDataInPlace(&ciphertext, plaintext: &plaintext) else {
+            XCTFail("Decryption failed")
+            return
+        }
+
+        // A copy of the ciphertext would have been decrypted in a new allocation.
+        XCTAssertEqual(plaintext, [ByteBuffer(string: "hello")])
+        let plaintextAddress = plaintext[0].withUnsafeReadableBytes { UInt(bitPattern: $0.baseAddress) }
+        XCTAssertTrue(storage.contains(plaintextAddress))
+    }
+
+    func testChannelReadDecryptsOneCopyOfTheCiphertext() throws {
+        let b2b = try assertNoThrowWithValue(self.connectedTestChannels(maximumTLSVersion: .tlsv12) {
+            $0.enableInPlaceDecryption = true
+        })
+
+        // Two flushes make two records, which we hand to the server in a single read.
+        var ciphertext = b2b.client.allocator.buffer(capacity: 0)
+        for message in ["hello, ", "world"] {
+            b2b.client.writeAndFlush(ByteBuffer(string: message), promise: nil)
+            while case .some(.byteBuffer(var record)) = try b2b.client.readOutbound(as: IOData.self) {
+                ciphertext.writeBuffer(&record)
+            }
+        }
+
+        // Like a channel's read loop, we keep our reference to the buffer we pass down the pipeline.
+        let originalCiphertext = Array(ciphertext.readableBytesView)
+        XCTAssertNoThrow(try b2b.server.writeInbound(ciphertext))
+
+        var plaintext: [ByteBuffer] = []
+        while let buffer = try b2b.server.readInbound(as: ByteBuffer.self) {
+            plaintext.append(buffer)
+        }
+        XCTAssertEqual(plaintext, [ByteBuffer(string: "hello, "), ByteBuffer(string: "world")])
+
+        // The buffer we still hold must not be decrypted underneath us, so the records are decrypted
+        // in a copy. There is one copy per read, not per record.
+        XCTAssertEqual(Array(ciphertext.readableBytesView), originalCiphertext)
+        XCTAssertNotEqual(self.storageIdentity(of: plaintext[0]), self.storageIdentity(of: ciphertext))
+        XCTAssertEqual(self.storageIdentity(of: plaintext[0]), self.storageIdentity(of: plaintext[1]))
+    }
+
+    private func assertServerEncryptsDirectly(maximumTLSVersion: TLSVersion,
+                                              serverConfigurationTransform: @escaping (inout TLSConfiguration) -> Void = { _ in }) throws {
+        let b2b = try assertNoThrowWithValue(self.connectedTestChannels(maximumTLSVersion: maximumTLSVersion) {
+            $0.enableDirectEncryption = true
+            serverConfigurationTransform(&$0)
+        })
+        // Larger than a single record.
+        let largeMessage = String(repeating: "x", count: 40_000)
+
+        let firstWrite = b2b.server.write(ByteBuffer(string: "hello, "))
+        let secondWrite = b2b.server.writeAndFlush(ByteBuffer(string: largeMessage))
+        XCTAssertNoThrow(try b2b.interactInMemory())
+        XCTAssertNoThrow(try firstWrite.wait())
+        XCTAssertNoThrow(try secondWrite.wait())
+        XCTAssertEqual(try self.readAllInbound(b2b.client).0, "hello, " + largeMessage)
+
+        let closeFuture = b2b.server.close()
+        XCTAssertNoThrow(try b2b.interactInMemory())
+        XCTAssertNoThrow(try closeFuture.wait())
+    }
+
+    func testDirectEncryptionTLS12() throws {
+        try self.assertServerEncryptsDirectly(maximumTLSVersion: .tlsv12)
+    }
+
+    func testDirectEncryptionWithInPlaceDecryption() throws {
+        try self.assertServerEncryptsDirectly(maximumTLSVersion: .tlsv12) { $0.enableInPlaceDecryption = true }
+    }
+
+    func testDirectEncryptionIsIgnoredForTLS13() throws {
+        try self.assertServerEncryptsDirectly(maximumTLSVersion: .tlsv13)
+    }
+
+    func testSmallWritesAreGatheredIntoRecords() throws {
+        let b2b = try assertNoThrowWithValue(self.connectedTestChannels(maximumTLSVersion: .tlsv12) {
+            $0.enableDirectEncryption = true
+        })
+
+        let writeFutures: [EventLoopFuture<Void>] = (0..<100).map { i in
+            b2b.server.write(ByteBuffer(repeating: UInt8(i), count: 512))
+        }
+        b2b.server.flush()
+
+        var ciphertext = b2b.server.allocator.buffer(capacity: 1024)
+        while case .some(.byteBuffer(var data)) = try b2b.server.readOutbound(as: IOData.self) {
+            ciphertext.writeBuffer(&data)
+        }
+        XCTAssertNoThrow(try EventLoopFuture<Void>.andAllSucceed(writeFutures, on: b2b.server.eventLoop).wait())
+
+        // 100 writes of 512 bytes fit into 4 records.
+        XCTAssertEqual(recordCount(ciphertext), 4)
+
+        XCTAssertNoThrow(try b2b.client.writeInbound(ciphertext))
+        var received = b2b.client.allocator.buffer(capacity: 51200)
+        while var data = try b2b.client.readInbound(as: ByteBuffer.self) {
+            received.writeBuffer(&data)
+        }
+        XCTAssertEqual(received.readableBytes, 51200)
+        for i in 0..<100 {
+            XCTAssertEqual(received.readSlice(length: 512), ByteBuffer(repeating: UInt8(i), count: 512))
+        }
+    }
+
+    private func makeEarlyDataClientContext(store: NIOSSLClientSessionStore) throws -> NIOSSLContext {
+        var config = TLSConfiguration.makeTestClientConfiguration()
+        config.maximumTLSVersion = .tlsv13
+        config.clientSessionStore = store
+        config.enableEarlyData = true
+        return try NIOSSLContext(configuration: config)
+    }
+
+    private func makeEarlyDataServerContext(enableEarlyData: Bool = true,
+                                            ticketKeys: NIOSSLSessionTicketKeyRing? = nil) throws -> NIOSSLContext {
+        var config = TLSConfiguration.makeTestServerConfiguration()
+        config.sessionTicketKeys = ticketKeys
+        config.enableEarlyData = enableEarlyData
+        return try NIOSSLContext(configuration: config)
+    }
+
+    /// Connects the two contexts in memory. The client writes `message`, if any, before the handshake starts.
+    private func connectWithEarlyData(clientContext: NIOSSLContext,
+                                      serverContext: NIOSSLContext,
+                                      message: String?,
+                                      file: StaticString = #file,
+                                      line: UInt = #line) throws -> (client: [EarlyDataRecorder.Record], server: [EarlyDataRecorder.Record]) {
+        let clientRecorder = EarlyDataRecorder()
+        let serverRecorder = EarlyDataRecorder()
+        let b2b = try BackToBackEmbeddedChannel(clientContext: clientContext,
+                                                serverContext: serverContext,
+                                                serverHostname: "localhost",
+                                                clientHandlers: [clientRecorder],
+                                                serverHandlers: [serverRecorder])
+
+        let writeFuture = message.map { b2b.client.writeAndFlush(ByteBuffer(string: $0)) }
+        XCTAssertNoThrow(try b2b.connectInMemory(), file: file, line: line)
+        XCTAssertNoThrow(try writeFuture?.wait(), file: file, line: line)
+
+        let closeFuture = b2b.client.close()
+        XCTAssertNoThrow(try b2b.interactInMemory(), file: file, line: line)
+        XCTAssertNoThrow(try closeFuture.wait(), file: file, line: line)
+        return (clientRecorder.records, serverRecorder.records)
+    }
+
+    func testNoEarlyDataOnFirstConnection() throws {
+        let clientContext = try assertNoThrowWithValue(self.makeEarlyDataClientContext(store: NIOSSLInMemoryClientSessionStore()))
+        let serverContext = try assertNoThrowWithValue(self.makeEarlyDataServerContext())
+
+        let records = try self.connectWithEarlyData(clientContext: clientContext, serverContext: serverContext, message: "hello")
+        XCTAssertEqual(records.client, [])
+        XCTAssertEqual(records.server, [.read("hello")])
+    }
+
+    func testEarlyDataAcceptedOnResumption() throws {
+        let clientContext = try assertNoThrowWithValue(self.makeEarlyDataClientContext(store: NIOSSLInMemoryClientSessionStore()))
+        let serverContext = try assertNoThrowWithValue(self.makeEarlyDataServerContext())
+
+        _ = try self.connectWithEarlyData(clientContext: clientContext, serverContext: serverContext, message: "first")
+        let records = try self.connectWithEarlyData(clientContext: clientContext, serverContext: serverContext, message: "early")
+        XCTAssertEqual(records.client, [.event(.accepted)])
+        XCTAssertEqual(records.server, [.event(.accepted), .read("early"), .event(.replaySafe)])
+    }
+
+    func testResumptionWithoutEarlyWritesCompletesHandshake() throws {
+        let clientContext = try assertNoThrowWithValue(self.makeEarlyDataClientContext(store: NIOSSLInMemoryClientSessionStore()))
+        let serverContext = try assertNoThrowWithValue(self.makeEarlyDataServerContext())
+
+        _ = try self.connectWithEarlyData(clientContext: clientContext, serverContext: serverContext, message: "first")
+        let records = try self.connectWithEarlyData(clientContext: clientContext, serverContext: serverContext, message: nil)
+        XCTAssertEqual(records.client, [.event(.accepted)])
+        XCTAssertEqual(records.server, [.event(.accepted), .event(.replaySafe)])
+        XCTAssertEqual(serverContext.sessionCacheStatistics.hits, 1)
+    }
+
+    func testRejectedEarlyDataIsResent() throws {
+        // The second server can't decrypt the ticket, so falls back to a full handshake.
+        let clientContext = try assertNoThrowWithValue(self.makeEarlyDataClientContext(store: NIOSSLInMemoryClientSessionStore()))
+        let firstServer = try assertNoThrowWithValue(self.makeEarlyDataServerContext(ticketKeys: NIOSSLSessionTicketKeyRing(primary: .random())))
+        let secondServer = try assertNoThrowWithValue(self.makeEarlyDataServerContext(ticketKeys: NIOSSLSessionTicketKeyRing(primary: .random())))
+
+        _ = try self.connectWithEarlyData(clientContext: clientContext, serverContext: firstServer, message: "first")
+        let records = try self.connectWithEarlyData(clientContext: clientContext, serverContext: secondServer, message: "early")
+        XCTAssertEqual(records.client, [.event(.rejected)])
+        XCTAssertEqual(records.server, [.read("early")])
+    }
+
+    func testServerWithEarlyDataDisabledRejectsEarlyData() throws {
+        let keys = NIOSSLSessionTicketKeyRing(primary: .random())
+        let clientContext = try assertNoThrowWithValue(self.makeEarlyDataClientContext(store: NIOSSLInMemoryClientSessionStore()))
+        let firstServer = try assertNoThrowWithValue(self.makeEarlyDataServerContext(ticketKeys: keys))
+        let secondServer = try assertNoThrowWithValue(self.makeEarlyDataServerContext(enableEarlyData: false, ticketKeys: keys))
+
+        _ = try self.connectWithEarlyData(clientContext: clientContext, serverContext: firstServer, message: "first")
+        let records = try self.connectWithEarlyData(clientContext: clientContext, serverContext: secondServer, message: "early")
+        XCTAssertEqual(records.client, [.event(.rejected)])
+        XCTAssertEqual(records.server, [.read("early")])
+        XCTAssertEqual(secondServer.sessionCacheStatistics.hits, 1)
+    }
+
+    /// Moves the server side of `b2b` into a new channel, resuming it from `handback`.
+    private func importServer(_ b2b: BackToBackEmbeddedChannel,
+                              context: NIOSSLContext,
+                              handback: NIOSSLConnectionHandback) throws -> HandshakeCompletedHandler {
+        let completionHandler = HandshakeCompletedHandler()
+        let server = b2b.replaceServer()
+        try server.pipeline.syncOperations.addHandler(NIOSSLServerHandler(context: context, handback: handback))
+        try server.pipeline.syncOperations.addHandler(completionHandler)
+        server.pipeline.fireChannelActive()
+        return completionHandler
+    }
+
+    func testExportedConnectionResumesInNewChannel() throws {
+        let serverContext = try assertNoThrowWithValue(NIOSSLContext(configuration: .makeTestServerConfiguration()))
+        let b2b = try assertNoThrowWithValue(self.connectedTestChannels(serverContext: serverContext, maximumTLSVersion: .tlsv12))
+
+        XCTAssertNoThrow(try b2b.client.writeAndFlush(ByteBuffer(string: "before")).wait())
+        XCTAssertNoThrow(try b2b.interactInMemory())
+        XCTAssertEqual(try b2b.server.readInbound(as: ByteBuffer.self), ByteBuffer(string: "before"))
+
+        let exportingHandler = try b2b.server.pipeline.syncOperations.handler(type: NIOSSLServerHandler.self)
+        let handback = try assertNoThrowWithValue(exportingHandler.exportConnection())
+        XCTAssertEqual(handback.unconsumedData, [])
+
+        // The exported handler can no longer write.
+        XCTAssertThrowsError(try b2b.server.writeAndFlush(ByteBuffer(string: "stale")).wait()) { error in
+            XCTAssertEqual(error as? ChannelError, .ioOnClosedChannel)
+        }
+
+        let completionHandler = try assertNoThrowWithValue(self.importServer(b2b, context: serverContext, handback: handback))
+        XCTAssertTrue(completionHandler.handshakeSucceeded)
+
+        XCTAssertNoThrow(try b2b.client.writeAndFlush(ByteBuffer(string: "after")).wait())
+        XCTAssertNoThrow(try b2b.server.writeAndFlush(ByteBuffer(string: "reply")).wait())
+        XCTAssertNoThrow(try b2b.interactInMemory())
+        XCTAssertEqual(try b2b.server.readInbound(as: ByteBuffer.self), ByteBuffer(string: "after"))
+        XCTAssertEqual(try b2b.client.readInbound(as: ByteBuffer.self), ByteBuffer(string: "reply"))
+    }
+
+    func testUnconsumedDataMovesWithConnection() throws {
+        var serverConfig = TLSConfiguration.makeTestServerConfiguration()
+        serverConfig.enableInPlaceDecryption = true
+        let serverContext = try assertNoThrowWithValue(NIOSSLContext(configuration: serverConfig))
+        let b2b = try assertNoThrowWithValue(self.connectedTestChannels(serverContext: serverContext, maximumTLSVersion: .tlsv12))
+
+        // Deliver only the start of a record to the server.
+        XCTAssertNoThrow(try b2b.client.writeAndFlush(ByteBuffer(string: "split across processes")).wait())
+        guard case .some(.byteBuffer(var record)) = try b2b.client.readOutbound(as: IOData.self) else {
+            XCTFail("No ciphertext written")
+            return
+        }
+        let start = record.readSlice(length: 10)!
+        XCTAssertNoThrow(try b2b.server.writeInbound(start))
+        XCTAssertNil(try b2b.server.readInbound(as: ByteBuffer.self))
+
+        let exportingHandler = try b2b.server.pipeline.syncOperations.handler(type: NIOSSLServerHandler.self)
+        let handback = try assertNoThrowWithValue(exportingHandler.exportConnection())
+        XCTAssertEqual(handback.unconsumedData, Array(start.readableBytesView))
+
+        XCTAssertNoThrow(try self.importServer(b2b, context: serverContext, handback: handback))
+        XCTAssertNoThrow(try b2b.server.writeInbound(record))
+        XCTAssertEqual(try b2b.server.readInbound(as: ByteBuffer.self), ByteBuffer(string: "split across processes"))
+    }
+
+    func testTLS13ConnectionCannotBeExported() throws {
+        let serverContext = try assertNoThrowWithValue(NIOSSLContext(configuration: .makeTestServerConfiguration()))
+        let b2b = try assertNoThrowWithValue(self.connectedTestChannels(serverContext: serverContext, maximumTLSVersion: .tlsv13))
+
+        let handler = try b2b.server.pipeline.syncOperations.handler(type: NIOSSLServerHandler.self)
+        XCTAssertThrowsError(try handler.exportConnection()) { error in
+            XCTAssertEqual(error as? NIOSSLExtraError, .cannotExportConnection)
+        }
+
+        // The connection carries on as before.
+        XCTAssertNoThrow(try b2b.client.writeAndFlush(ByteBuffer(string: "hello")).wait())
+        XCTAssertNoThrow(try b2b.interactInMemory())
+        XCTAssertEqual(try b2b.server.readInbound(as: ByteBuffer.self), ByteBuffer(string: "hello"))
+    }
+
+    func testConnectionWithPendingWritesCannotBeExported() throws {
+        let serverContext = try assertNoThrowWithValue(NIOSSLContext(configuration: .makeTestServerConfiguration()))
+        let b2b = try assertNoThrowWithValue(self.connectedTestChannels(serverContext: serverContext, maximumTLSVersion: .tlsv12))
+
+        b2b.server.write(ByteBuffer(string: "unflushed"), promise: nil)
+        let handler = try b2b.server.pipeline.syncOperations.handler(type: NIOSSLServerHandler.self)
+        XCTAssertThrowsError(try handler.exportConnection()) { error in
+            XCTAssertEqual(error as? NIOSSLExtraError, .cannotExportConnection)
+        }
+    }
+
+    func testInvalidHandbackIsRejected() throws {
+        let serverContext = try assertNoThrowWithValue(NIOSSLContext(configuration: .makeTestServerConfiguration()))
+        let handback = NIOSSLConnectionHandback(state: [0x30, 0x03, 0x02, 0x01, 0x07], unconsumedData: [])
+        XCTAssertThrowsError(try NIOSSLServerHandler(context: serverContext, handback: handback)) { error in
+            XCTAssertEqual(error as? NIOSSLExtraError, .invalidConnectionHandback)
+        }
+    }
+
+    /// Makes a front-end context, which holds `key` in place of the shared test identity's real key.
+    private func makeFrontEndContext(key: UnavailablePrivateKey,
+                                     callback: @escaping NIOSSLHandshakeHintsCallback) throws -> NIOSSLContext {
+        var config = TLSConfiguration.makeTestServerConfiguration()
+        config.privateKey = .privateKey(NIOSSLPrivateKey(customPrivateKey: key))
+        config.handshakeHintsCallback = callback
+        return try NIOSSLContext(configuration: config)
+    }
+
+    private func makeFrontEndChannels(serverContext: NIOSSLContext, maximumTLSVersion: TLSVersion) throws -> BackToBackEmbeddedChannel {
+        var config = TLSConfiguration.makeTestClientConfiguration()
+        config.maximumTLSVersion = maximumTLSVersion
+        return try BackToBackEmbeddedChannel(clientContext: NIOSSLContext(configuration: config), serverContext: serverContext)
+    }
+
+    func testHintsReplaceFrontEndSignature() throws {
+        let workerContext = try assertNoThrowWithValue(NIOSSLContext(configuration: .makeTestServerConfiguration()))
+        let frontEndKey = UnavailablePrivateKey()
+        var requests: [NIOSSLHandshakeHintsRequest] = []
+        let frontEndContext = try assertNoThrowWithValue(self.makeFrontEndContext(key: frontEndKey) { request, channel in
+            requests.append(request)
+            return channel.eventLoop.submit { try workerContext.makeHandshakeHints(for: request) }
+        })
+
+        let b2b = try assertNoThrowWithValue(self.makeFrontEndChannels(serverContext: frontEndContext, maximumTLSVersion: .tlsv13))
+        XCTAssertNoThrow(try b2b.handshakeInMemory())
+
+        XCTAssertEqual(requests.count, 1)
+        XCTAssertFalse(requests.first?.clientHello.isEmpty ?? true)
+        XCTAssertEqual(frontEndKey.signCallCount, 0)
+
+        // The connection works.
+        XCTAssertNoThrow(try b2b.client.writeAndFlush(ByteBuffer(string: "hello")).wait())
+        XCTAssertNoThrow(try b2b.interactInMemory())
+        XCTAssertEqual(try b2b.server.readInbound(as: ByteBuffer.self), ByteBuffer(string: "hello"))
+    }
+
+    func testMissingHintsFallBackToFrontEndKey() throws {
+        let frontEndKey = UnavailablePrivateKey()
+        let frontEndContext = try assertNoThrowWithValue(self.makeFrontEndContext(key: frontEndKey) { _, channel in
+            return channel.eventLoop.makeSucceededFuture(nil)
+        })
+
+        let b2b = try assertNoThrowWithValue(self.makeFrontEndChannels(serverContext: frontEndContext, maximumTLSVersion: .tlsv13))
+        XCTAssertThrowsError(try b2b.connectInMemory())
+        XCTAssertEqual(frontEndKey.signCallCount, 1)
+    }
+
+    func testTLS12HintsAreEmpty() throws {
+        let workerContext = try assertNoThrowWithValue(NIOSSLContext(configuration: .makeTestServerConfiguration()))
+        let frontEndKey = UnavailablePrivateKey()
+        var hints: [[UInt8]] = []
+        let frontEndContext = try assertNoThrowWithValue(self.makeFrontEndContext(key: frontEndKey) { request, channel in
+            return channel.eventLoop.submit {
+                let result = try workerContext.makeHandshakeHints(for: request)
+                hints.append(result)
+                return result
+            }
+        })
+
+        let b2b = try assertNoThrowWithValue(self.makeFrontEndChannels(serverContext: frontEndContext, maximumTLSVersion: .tlsv12))
+        XCTAssertThrowsError(try b2b.connectInMemory())
+        XCTAssertEqual(hints, [[]])
+        XCTAssertEqual(frontEndKey.signCallCount, 1)
+    }
+
+    func testInvalidClientHelloIsRejected() throws {
+        let workerContext = try assertNoThrowWithValue(NIOSSLContext(configuration: .makeTestServerConfiguration()))
+        let request = NIOSSLHandshakeHintsRequest(clientHello: [1, 2, 3], capabilities: [])
+        XCTAssertThrowsError(try workerContext.makeHandshakeHints(for: request)) { error in
+            XCTAssertEqual(error as? NIOSSLExtraError, .failedToGenerateHandshakeHints)
+        }
+    }
+
+    /// Sets up a handshake with `serverContext`, sending `serverHostname` in SNI. `presented` is updated with the
+    /// leaf certificate the server presents.
+    private func makeCertificateSelectionChannels(serverContext: NIOSSLContext,
+                                                  serverHostname: String?,
+                                                  presented: @escaping (NIOSSLCertificate?) -> Void) throws -> BackToBackEmbeddedChannel {
+        var config = TLSConfiguration.makeClientConfiguration()
+        config.certificateVerification = .none
+        return try BackToBackEmbeddedChannel(clientContext: NIOSSLContext(configuration: config),
+                                             serverContext: serverContext,
+                                             serverHostname: serverHostname,
+                                             customVerificationCallback: { certificates, promise in
+            presented(certificates.first)
+            promise.succeed(.certificateVerified)
+        })
+    }
+
+    /// Handshakes with `serverContext`, sending `serverHostname` in SNI, and returns the leaf certificate the
+    /// server presented.
+    private func presentedCertificate(serverContext: NIOSSLContext,
+                                      serverHostname: String?,
+                                      file: StaticString = #file,
+                                      line: UInt = #line) throws -> NIOSSLCertificate? {
+        var presented: NIOSSLCertificate? = nil
+        let b2b = try self.makeCertificateSelectionChannels(serverContext: serverContext,
+                                                            serverHostname: serverHostname) { presented = $0 }
+        XCTAssertNoThrow(try b2b.handshakeInMemory(file: file, line: line), file: file, line: line)
+        return presented
+    }
+
+    private func makeServerContext(certificateSelectionCallback: @escaping NIOSSLCertificateSelectionCallback) throws -> NIOSSLContext {
+        var config = TLSConfiguration.makeTestServerConfiguration()
+        config.certificateSelectionCallback = certificateSelectionCallback
+        return try NIOSSLContext(configuration: config)
+    }
+
+    func testHandshakeWaitsForSelectedIdentity() throws {
+        var requestedNames: [String?] = []
+        var pendingPromise: EventLoopPromise<NIOSSLIdentity?>? = nil
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext { serverName, channel in
+            requestedNames.append(serverName)
+            let promise = channel.eventLoop.makePromise(of: NIOSSLIdentity?.self)
+            pendingPromise = promise
+            return promise.futureResult
+        })
+
+        var presented: NIOSSLCertificate? = nil
+        let b2b = try assertNoThrowWithValue(self.makeCertificateSelectionChannels(serverContext: serverContext,
+                                                                                   serverHostname: "Tenant.example.com") { presented = $0 })
+
+        let addr = try assertNoThrowWithValue(SocketAddress(unixDomainSocketPath: "/tmp/whatever2"))
+        let connectFuture = b2b.client.connect(to: addr)
+        b2b.server.pipeline.fireChannelActive()
+        XCTAssertNoThrow(try b2b.interactInMemory())
+
+        // The handshake is suspended until the identity arrives.
+        XCTAssertEqual(requestedNames, ["tenant.example.com"])
+        XCTAssertNil(presented)
+
+        let identity = try NIOSSLIdentity(certificateChain: [otherTestCertificate], privateKey: otherTestPrivateKey)
+        pendingPromise!.succeed(identity)
+        XCTAssertNoThrow(try b2b.interactInMemory())
+        XCTAssertNoThrow(try connectFuture.wait())
+
+        XCTAssertEqual(requestedNames, ["tenant.example.com"])
+        XCTAssertEqual(presented, otherTestCertificate)
+    }
+
+    func testNilIdentityUsesConfiguredIdentity() throws {
+        var requestedNames: [String?] = []
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext { serverName, channel in
+            requestedNames.append(serverName)
+            return channel.eventLoop.makeSucceededFuture(nil)
+        })
+
+        XCTAssertEqual(try self.presentedCertificate(serverContext: serverContext, serverHostname: nil), sharedTestCertificate)
+        XCTAssertEqual(requestedNames, [nil])
+    }
+
+    func testStoreMatchSkipsCallback() throws {
+        var callbackInvoked = false
+        var config = TLSConfiguration.makeTestServerConfiguration()
+        config.certificateStore = NIOSSLCertificateStore()
+        try config.certificateStore!.setIdentity(certificateChain: [otherTestCertificate],
+                                                 privateKey: otherTestPrivateKey,
+                                                 forServerNames: ["example.com"])
+        config.certificateSelectionCallback = { _, channel in
+            callbackInvoked = true
+            return channel.eventLoop.makeSucceededFuture(nil)
+        }
+        let serverContext = try assertNoThrowWithValue(NIOSSLContext(configuration: config))
+
+        XCTAssertEqual(try self.presentedCertificate(serverContext: serverContext, serverHostname: "example.com"), otherTestCertificate)
+        XCTAssertFalse(callbackInvoked)
+    }
+
+    func testFailedSelectionFailsHandshake() throws {
+        struct SelectionError: Error { }
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext { _, channel in
+            return channel.eventLoop.makeFailedFuture(SelectionError())
+        })
+
+        var presented: NIOSSLCertificate? = nil
+        let b2b = try assertNoThrowWithValue(self.makeCertificateSelectionChannels(serverContext: serverContext,
+                                                                                   serverHostname: "example.com") { presented = $0 })
+        XCTAssertThrowsError(try b2b.connectInMemory()) { error in
+            XCTAssertNotNil(error as? NIOSSLError)
+        }
+        XCTAssertNil(presented)
+    }
+
+    private func makeServerContext(certificateStore: NIOSSLCertificateStore) throws -> NIOSSLContext {
+        var config = TLSConfiguration.makeTestServerConfiguration()
+        config.certificateStore = certificateStore
+        return try NIOSSLContext(configuration: config)
+    }
+
+    func testExactNameSelectsIdentity() throws {
+        let (secondCert, secondKey) = generateSelfSignedCert(commonName: "second")
+        let store = NIOSSLCertificateStore()
+        try store.setIdentity(certificateChain: [otherTestCertificate],
+                              privateKey: otherTestPrivateKey,
+                              forServerNames: ["first.example.com"])
+        try store.setIdentity(certificateChain: [secondCert],
+                              privateKey: secondKey,
+                              forServerNames: ["second.example.com"])
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext(certificateStore: store))
+
+        XCTAssertEqual(try self.presentedCertificate(serverContext: serverContext, serverHostname: "first.example.com"),
+                       otherTestCertificate)
+        XCTAssertEqual(try self.presentedCertificate(serverContext: serverContext, serverHostname: "SECOND.example.com"),
+                       secondCert)
+    }
+
+    func testWildcardNameSelectsIdentity() throws {
+        let (secondCert, secondKey) = generateSelfSignedCert(commonName: "second")
+        let store = NIOSSLCertificateStore()
+        try store.setIdentity(certificateChain: [otherTestCertificate],
+                              privateKey: otherTestPrivateKey,
+                              forServerNames: ["*.example.com"])
+        try store.setIdentity(certificateChain: [secondCert],
+                              privateKey: secondKey,
+                              forServerNames: ["special.example.com"])
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext(certificateStore: store))
+
+        XCTAssertEqual(try self.presentedCertificate(serverContext: serverContext, serverHostname: "any.example.com"),
+                       otherTestCertificate)
+        XCTAssertEqual(try self.presentedCertificate(serverContext: serverContext, serverHostname: "special.example.com"),
+                       secondCert)
+
+        // Wildcards only match a single label.
+        XCTAssertEqual(try self.presentedCertificate(serverContext: serverContext, serverHostname: "a.b.example.com"),
+                       sharedTestCertificate)
+        XCTAssertEqual(try self.presentedCertificate(serverContext: serverContext, serverHostname: "example.com"),
+                       sharedTestCertificate)
+    }
+
+    func testUnknownOrMissingNameUsesConfiguredIdentity() throws {
+        let store = NIOSSLCertificateStore()
+        try store.setIdentity(certificateChain: [otherTestCertificate],
+                              privateKey: otherTestPrivateKey,
+                              forServerNames: ["first.example.com"])
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext(certificateStore: store))
+
+        XCTAssertEqual(try self.presentedCertificate(serverContext: serverContext, serverHostname: "other.example.com"),
+                       sharedTestCertificate)
+        XCTAssertEqual(try self.presentedCertificate(serverContext: serverContext, serverHostname: nil),
+                       sharedTestCertificate)
+    }
+
+    func testCertificateStoreChangesApplyToLaterHandshakes() throws {
+        let store = NIOSSLCertificateStore()
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext(certificateStore: store))
+        XCTAssertEqual(try self.presentedCertificate(serverContext: serverContext, serverHostname: "example.com"),
+                       sharedTestCertificate)
+
+        try store.setIdentity(certificateChain: [otherTestCertificate],
+                              privateKey: otherTestPrivateKey,
+                              forServerNames: ["example.com", "www.example.com"])
+        XCTAssertEqual(store.count, 2)
+        XCTAssertEqual(try self.presentedCertificate(serverContext: serverContext, serverHostname: "example.com"),
+                       otherTestCertificate)
+
+        try store.removeIdentity(forServerName: "example.com.")
+        XCTAssertEqual(store.count, 1)
+        XCTAssertEqual(try self.presentedCertificate(serverContext: serverContext, serverHostname: "example.com"),
+                       sharedTestCertificate)
+        XCTAssertEqual(try self.presentedCertificate(serverContext: serverContext, serverHostname: "www.example.com"),
+                       otherTestCertificate)
+
+        store.removeAll()
+        XCTAssertEqual(store.count, 0)
+        XCTAssertEqual(try self.presentedCertificate(serverContext: serverContext, serverHostname: "www.example.com"),
+                       sharedTestCertificate)
+    }
+
+    func testInvalidCertificateStoreNamesAreRejected() throws {
+        let store = NIOSSLCertificateStore()
+        for name in ["", ".", "*", "a..example.com", "foo*.example.com", "www.*.example.com", "*.*.example.com"] {
+            XCTAssertThrowsError(try store.setIdentity(certificateChain: [otherTestCertificate],
+                                                       privateKey: otherTestPrivateKey,
+                                                       forServerNames: [name]), name) { error in
+                XCTAssertEqual(error as? NIOSSLExtraError, .invalidCertificateStoreName)
+            }
+        }
+        XCTAssertEqual(store.count, 0)
+    }
+
+    func testSetCredentialsAppliesToNewHandshakes() throws {
+        let (secondCert, secondKey) = generateSelfSignedCert(commonName: "second")
+        let store = NIOSSLCertificateStore()
+        try store.setIdentity(certificateChain: [secondCert],
+                              privateKey: secondKey,
+                              forServerNames: ["second.example.com"])
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext(certificateStore: store))
+
+        XCTAssertNoThrow(try serverContext.setCredentials(certificateChain: [otherTestCertificate],
+                                                          privateKey: otherTestPrivateKey))
+        XCTAssertEqual(try self.presentedCertificate(serverContext: serverContext, serverHostname: "example.com"),
+                       otherTestCertificate)
+        XCTAssertEqual(try self.presentedCertificate(serverContext: serverContext, serverHostname: nil),
+                       otherTestCertificate)
+
+        // The store still takes precedence.
+        XCTAssertEqual(try self.presentedCertificate(serverContext: serverContext, serverHostname: "second.example.com"),
+                       secondCert)
+    }
+
+    func testSetCredentialsRejectsMismatchedKey() throws {
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext(certificateStore: NIOSSLCertificateStore()))
+
+        XCTAssertThrowsError(try serverContext.setCredentials(certificateChain: [otherTestCertificate],
+                                                              privateKey: sharedTestPrivateKey)) { error in
+            XCTAssertEqual(error as? NIOSSLError, .failedToLoadPrivateKey)
+        }
+        XCTAssertEqual(try self.presentedCertificate(serverContext: serverContext, serverHostname: "example.com"),
+                       sharedTestCertificate)
+    }
 }
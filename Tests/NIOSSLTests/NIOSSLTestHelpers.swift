@@ -13,6 +13,7 @@
 //===----------------------------------------------------------------------===//
 
 import Foundation
+import XCTest
 @_implementationOnly import CNIOBoringSSL
 import NIOCore
 import NIOEmbedded
@@ -617,7 +618,8 @@ func addExtension(x509: OpaquePointer, nid: CInt, value: String) {
     CNIOBoringSSL_X509_EXTENSION_free(ext)
 }
 
-func generateSelfSignedCert(keygenFunction: () -> UnsafeMutablePointer<EVP_PKEY> = generateRSAPrivateKey) -> (NIOSSLCertificate, NIOSSLPrivateKey) {
+func generateSelfSignedCert(keygenFunction: () -> UnsafeMutablePointer<EVP_PKEY> = generateRSAPrivateKey,
+                            commonName: String = "localhost") -> (NIOSSLCertificate, NIOSSLPrivateKey) {
     let pkey = keygenFunction()
     let x = CNIOBoringSSL_X509_new()!
     CNIOBoringSSL_X509_set_version(x, 2)
@@ -641,7 +643,6 @@ func generateSelfSignedCert(keygenFunction: () -> UnsafeMutablePointer<EVP_PKEY>
     
     CNIOBoringSSL_X509_set_pubkey(x, pkey)
     
-    let commonName = "localhost"
     let name = CNIOBoringSSL_X509_get_subject_name(x)
     commonName.withCString { (pointer: UnsafePointer<Int8>) -> Void in
         pointer.withMemoryRebound(to: UInt8.self, capacity: commonName.lengthOfBytes(using: .utf8)) { (pointer: UnsafePointer<UInt8>) -> Void in
@@ -672,8 +673,8 @@ final class BackToBackEmbeddedChannel {
     private var loop: EmbeddedEventLoop
 
 
-    init() {
-        self.loop = EmbeddedEventLoop()
+    init(loop: EmbeddedEventLoop = EmbeddedEventLoop()) {
+        self.loop = loop
         self.client = EmbeddedChannel(loop: self.loop)
         self.server = EmbeddedChannel(loop: self.loop)
     }
@@ -682,6 +683,12 @@ final class BackToBackEmbeddedChannel {
         self.loop.run()
     }
 
+    /// Replaces the server with a new channel on the same loop, as though the connection had moved to another process.
+    func replaceServer() -> EmbeddedChannel {
+        self.server = EmbeddedChannel(loop: self.loop)
+        return self.server
+    }
+
     func connectInMemory() throws {
         let addr = try assertNoThrowWithValue(SocketAddress(unixDomainSocketPath: "/tmp/whatever2"))
         let connectFuture = self.client.connect(to: addr)
@@ -716,3 +723,62 @@ final class BackToBackEmbeddedChannel {
         }
     }
 }
+
+/// Self-signed identities for tests that need certificates but not any particular ones. The shared identity is the
+/// server's in `makeTestServerConfiguration()`; the other is for anything that must differ from it, such as a client
+/// certificate or a root that the client doesn't trust.
+let (sharedTestCertificate, sharedTestPrivateKey) = generateSelfSignedCert()
+let (otherTestCertificate, otherTestPrivateKey) = generateSelfSignedCert(commonName: "other")
+
+extension TLSConfiguration {
+    /// A server configuration that presents `sharedTestCertificate`.
+    static func makeTestServerConfiguration() -> TLSConfiguration {
+        return .makeServerConfiguration(
+            certificateChain: [.certificate(sharedTestCertificate)],
+            privateKey: .privateKey(sharedTestPrivateKey)
+        )
+    }
+
+    /// A client configuration that trusts only `sharedTestCertificate`, without checking the server's name.
+    static func makeTestClientConfiguration() -> TLSConfiguration {
+        var config = TLSConfiguration.makeClientConfiguration()
+        config.certificateVerification = .noHostnameVerification
+        config.trustRoots = .certificates([sharedTestCertificate])
+        return config
+    }
+}
+
+extension BackToBackEmbeddedChannel {
+    /// Creates a client using `clientContext` and a server using `serverContext`, without connecting them. Each TLS
+    /// handler is followed by a `HandshakeCompletedHandler`, then by `clientHandlers` or `serverHandlers`.
+    convenience init(clientContext: NIOSSLContext,
+                     serverContext: NIOSSLContext,
+                     serverHostname: String? = nil,
+                     customVerificationCallback: NIOSSLCustomVerificationCallback? = nil,
+                     clientHandlers: [ChannelHandler] = [],
+                     serverHandlers: [ChannelHandler] = []) throws {
+        self.init()
+        let clientHandler: NIOSSLClientHandler
+        if let customVerificationCallback = customVerificationCallback {
+            clientHandler = try NIOSSLClientHandler(context: clientContext,
+                                                    serverHostname: serverHostname,
+                                                    customVerificationCallback: customVerificationCallback)
+        } else {
+            clientHandler = try NIOSSLClientHandler(context: clientContext, serverHostname: serverHostname)
+        }
+        try self.client.pipeline.syncOperations.addHandlers([clientHandler, HandshakeCompletedHandler()])
+        try self.client.pipeline.syncOperations.addHandlers(clientHandlers)
+        try self.server.pipeline.syncOperations.addHandlers([NIOSSLServerHandler(context: serverContext), HandshakeCompletedHandler()])
+        try self.server.pipeline.syncOperations.addHandlers(serverHandlers)
+    }
+
+    /// Connects the channels in memory and asserts that both ends completed the handshake. Errors that fail the
+    /// handshake are thrown.
+    func handshakeInMemory(file: StaticString = #file, line: UInt = #line) throws {
+        try self.connectInMemory()
+        for channel in [self.client, self.server] {
+            let handler = try channel.pipeline.syncOperations.handler(type: HandshakeCompletedHandler.self)
+            XCTAssertTrue(handler.handshakeSucceeded, file: file, line: line)
+        }
+    }
+}
@@ -64,6 +64,59 @@ extension TLSConfigurationTest {
                 ("testDefaultCipherSuiteValues", testDefaultCipherSuiteValues),
                 ("testBestEffortEquatableHashableDifferences", testBestEffortEquatableHashableDifferences),
                 ("testObtainingTLSVersionOnClientChannel", testObtainingTLSVersionOnClientChannel),
+                ("testServerSessionCacheCountsFullHandshakes", testServerSessionCacheCountsFullHandshakes),
+                ("testDisabledServerSessionCacheCanBeConfigured", testDisabledServerSessionCacheCanBeConfigured),
+                ("testClientResumesSessionTLS12", testClientResumesSessionTLS12),
+                ("testClientResumesSessionTLS13", testClientResumesSessionTLS13),
+                ("testServerResumesSessionFromCache", testServerResumesSessionFromCache),
+                ("testServerWithoutCacheDoesNotResumeSessionIDs", testServerWithoutCacheDoesNotResumeSessionIDs),
+                ("testNoResumptionWithoutStore", testNoResumptionWithoutStore),
+                ("testSessionsAreNotOfferedToOtherHosts", testSessionsAreNotOfferedToOtherHosts),
+                ("testInMemoryStoreEvictsOldestKey", testInMemoryStoreEvictsOldestKey),
+                ("testSessionSerializationRoundTrips", testSessionSerializationRoundTrips),
+                ("testSharedTicketKeysAllowResumptionAcrossContexts", testSharedTicketKeysAllowResumptionAcrossContexts),
+                ("testUnsharedTicketKeysPreventResumptionAcrossContexts", testUnsharedTicketKeysPreventResumptionAcrossContexts),
+                ("testTicketsFromSecondaryKeyAreAccepted", testTicketsFromSecondaryKeyAreAccepted),
+                ("testLoadingTicketKeysFromFile", testLoadingTicketKeysFromFile),
+                ("testTicketKeyRequiresFortyEightBytes", testTicketKeyRequiresFortyEightBytes),
+                ("testDefaultGroupsAvoidHelloRetryRequest", testDefaultGroupsAvoidHelloRetryRequest),
+                ("testMispredictedKeyShareIsCounted", testMispredictedKeyShareIsCounted),
+                ("testPredictedKeyShareAvoidsHelloRetryRequest", testPredictedKeyShareAvoidsHelloRetryRequest),
+                ("testPredictedKeyShareOutsideGroupsIsRejected", testPredictedKeyShareOutsideGroupsIsRejected),
+                ("testTLS12NeverUsesHelloRetryRequest", testTLS12NeverUsesHelloRetryRequest),
+                ("testNoSharedGroupFailsHandshake", testNoSharedGroupFailsHandshake),
+                ("testGroupsAffectConfigurationEquality", testGroupsAffectConfigurationEquality),
+                ("testCompressedChainIsReceivedIntact", testCompressedChainIsReceivedIntact),
+                ("testChainIsCompressedOncePerContext", testChainIsCompressedOncePerContext),
+                ("testRepeatedAlgorithmsAreRegisteredOnce", testRepeatedAlgorithmsAreRegisteredOnce),
+                ("testChainIsNotCompressedForClientsWithoutAlgorithm", testChainIsNotCompressedForClientsWithoutAlgorithm),
+                ("testChainIsNotCompressedInTLS12", testChainIsNotCompressedInTLS12),
+                ("testChainIsSentUncompressedWithoutServerSupport", testChainIsSentUncompressedWithoutServerSupport),
+                ("testRepeatChainIsNotVerifiedAgain", testRepeatChainIsNotVerifiedAgain),
+                ("testDifferentChainsAreCachedSeparately", testDifferentChainsAreCachedSeparately),
+                ("testLeastRecentlyUsedChainIsEvicted", testLeastRecentlyUsedChainIsEvicted),
+                ("testInvalidationForcesVerification", testInvalidationForcesVerification),
+                ("testExpiredResultsAreNotReused", testExpiredResultsAreNotReused),
+                ("testUntrustedChainIsNotCached", testUntrustedChainIsNotCached),
+                ("testVerifiedChainCacheIsDisabledByDefault", testVerifiedChainCacheIsDisabledByDefault),
+                ("testTrustStoreRootsAreTrusted", testTrustStoreRootsAreTrusted),
+                ("testPeersNotInTrustStoreAreRejected", testPeersNotInTrustStoreAreRejected),
+                ("testAdditionalTrustRootsAreTrustedAlongsideTrustStore", testAdditionalTrustRootsAreTrustedAlongsideTrustStore),
+                ("testTrustStoreRootsAreParsedOnFirstUse", testTrustStoreRootsAreParsedOnFirstUse),
+                ("testDuplicateTrustStoreRootsAreHeldOnce", testDuplicateTrustStoreRootsAreHeldOnce),
+                ("testTrustStoresShareRootBuffers", testTrustStoresShareRootBuffers),
+                ("testLoadingTrustStoreFromPEMFile", testLoadingTrustStoreFromPEMFile),
+                ("testLoadingTrustStoreFromFileWithoutCertificatesFails", testLoadingTrustStoreFromFileWithoutCertificatesFails),
+                ("testIndexedDirectoryRootsAreTrusted", testIndexedDirectoryRootsAreTrusted),
+                ("testIndexedDirectoryIsNotReadDuringHandshakes", testIndexedDirectoryIsNotReadDuringHandshakes),
+                ("testLookupOnDemandReadsDirectoryDuringHandshakes", testLookupOnDemandReadsDirectoryDuringHandshakes),
+                ("testExplicitReloadPicksUpNewRoots", testExplicitReloadPicksUpNewRoots),
+                ("testChangedDirectoryIsReloadedAfterInterval", testChangedDirectoryIsReloadedAfterInterval),
+                ("testTrustStoreFromDirectoryOnlyReadsHashedNames", testTrustStoreFromDirectoryOnlyReadsHashedNames),
+                ("testTrustStoreFromMissingDirectoryFails", testTrustStoreFromMissingDirectoryFails),
+                ("testConcurrentConnectionsShareCertificates", testConcurrentConnectionsShareCertificates),
+                ("testContextsWithoutCertificateBufferPoolAreNotCounted", testContextsWithoutCertificateBufferPoolAreNotCounted),
+                ("testCertificateBufferPoolHitRate", testCertificateBufferPoolHitRate),
            ]
    }
 }
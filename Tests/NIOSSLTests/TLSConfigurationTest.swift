@@ -1068,6 +1068,7 @@ class TLSConfigurationTest: XCTestCase {
             { $0.shutdownTimeout = .seconds((60 * 24 * 24) + 1) },
             { $0.keyLogCallback = { _ in } },
             { $0.renegotiationSupport = .always },
+            { $0.serverSessionCache = .disabled },
         ]
 
         for (index, transform) in transforms.enumerated() {
@@ -1118,6 +1119,764 @@ class TLSConfigurationTest: XCTestCase {
         XCTAssertNoThrow(channelTLSVersion = try tlsVersionForChannel.wait())
         XCTAssertEqual(channelTLSVersion!, .tlsv11)
     }
+
+    func testServerSessionCacheCountsFullHandshakes() throws {
+        let b2b = BackToBackEmbeddedChannel()
+
+        var clientConfig = TLSConfiguration.makeClientConfiguration()
+        clientConfig.certificateVerification = .noHostnameVerification
+        clientConfig.trustRoots = .certificates([TLSConfigurationTest.cert1])
+
+        var serverConfig = TLSConfiguration.makeServerConfiguration(
+            certificateChain: [.certificate(TLSConfigurationTest.cert1)],
+            privateKey: .privateKey(TLSConfigurationTest.key1)
+        )
+        serverConfig.serverSessionCache = NIOSSLServerSessionCacheConfiguration(maximumSize: 16, timeout: .minutes(5))
+
+        let clientContext = try assertNoThrowWithValue(NIOSSLContext(configuration: clientConfig))
+        let serverContext = try assertNoThrowWithValue(NIOSSLContext(configuration: serverConfig))
+        XCTAssertEqual(serverContext.sessionCacheStatistics, NIOSSLSessionCacheStatistics(hits: 0, misses: 0, cachedSessions: 0))
+
+        XCTAssertNoThrow(
+            try b2b.client.pipeline.syncOperations.addHandlers(
+                [try NIOSSLClientHandler(context: clientContext, serverHostname: "localhost"), HandshakeCompletedHandler()]
+            )
+        )
+        XCTAssertNoThrow(
+            try b2b.server.pipeline.syncOperations.addHandlers(
+                [NIOSSLServerHandler(context: serverContext), HandshakeCompletedHandler()]
+            )
+        )
+        XCTAssertNoThrow(try b2b.connectInMemory())
+        XCTAssertTrue(b2b.client.handshakeSucceeded)
+        XCTAssertTrue(b2b.server.handshakeSucceeded)
+
+        XCTAssertEqual(serverContext.sessionCacheStatistics.hits, 0)
+        XCTAssertEqual(serverContext.sessionCacheStatistics.misses, 1)
+        XCTAssertEqual(clientContext.sessionCacheStatistics.misses, 1)
+    }
+
+    func testDisabledServerSessionCacheCanBeConfigured() throws {
+        var serverConfig = TLSConfiguration.makeServerConfiguration(
+            certificateChain: [.certificate(TLSConfigurationTest.cert1)],
+            privateKey: .privateKey(TLSConfigurationTest.key1)
+        )
+        serverConfig.serverSessionCache = .disabled
+
+        var clientConfig = TLSConfiguration.makeClientConfiguration()
+        clientConfig.certificateVerification = .noHostnameVerification
+        clientConfig.trustRoots = .certificates([TLSConfigurationTest.cert1])
+
+        try assertHandshakeSucceeded(withClientConfig: clientConfig, andServerConfig: serverConfig)
+    }
+
+    /// Connects the two contexts in memory, then closes the connection.
+    private func connectAndClose(clientContext: NIOSSLContext,
+                                 serverContext: NIOSSLContext,
+                                 serverHostname: String? = "localhost",
+                                 file: StaticString = #file,
+                                 line: UInt = #line) throws {
+        let b2b = try assertNoThrowWithValue(BackToBackEmbeddedChannel(clientContext: clientContext,
+                                                                       serverContext: serverContext,
+                                                                       serverHostname: serverHostname),
+                                             file: file, line: line)
+        XCTAssertNoThrow(try b2b.handshakeInMemory(file: file, line: line), file: file, line: line)
+
+        let closeFuture = b2b.client.close()
+        XCTAssertNoThrow(try b2b.interactInMemory(), file: file, line: line)
+        XCTAssertNoThrow(try closeFuture.wait(), file: file, line: line)
+    }
+
+    private func makeResumingClientContext(store: NIOSSLClientSessionStore?,
+                                           maximumTLSVersion: TLSVersion? = nil) throws -> NIOSSLContext {
+        var config = TLSConfiguration.makeTestClientConfiguration()
+        config.clientSessionStore = store
+        config.maximumTLSVersion = maximumTLSVersion
+        return try NIOSSLContext(configuration: config)
+    }
+
+    private func makeResumingServerContext(ticketKeys: NIOSSLSessionTicketKeyRing? = nil,
+                                           serverSessionCache: NIOSSLServerSessionCacheConfiguration? = nil) throws -> NIOSSLContext {
+        var config = TLSConfiguration.makeTestServerConfiguration()
+        config.sessionTicketKeys = ticketKeys
+        config.serverSessionCache = serverSessionCache
+        return try NIOSSLContext(configuration: config)
+    }
+
+    private func assertResumes(maximumTLSVersion: TLSVersion) throws {
+        let store = NIOSSLInMemoryClientSessionStore()
+        let clientContext = try assertNoThrowWithValue(self.makeResumingClientContext(store: store, maximumTLSVersion: maximumTLSVersion))
+        let serverContext = try assertNoThrowWithValue(self.makeResumingServerContext())
+
+        try self.connectAndClose(clientContext: clientContext, serverContext: serverContext)
+        XCTAssertEqual(store.count, 1)
+        XCTAssertEqual(clientContext.sessionCacheStatistics.hits, 0)
+        XCTAssertEqual(clientContext.sessionCacheStatistics.misses, 1)
+
+        try self.connectAndClose(clientContext: clientContext, serverContext: serverContext)
+        XCTAssertEqual(clientContext.sessionCacheStatistics.hits, 1)
+        XCTAssertEqual(clientContext.sessionCacheStatistics.misses, 1)
+        XCTAssertEqual(serverContext.sessionCacheStatistics.hits, 1)
+        XCTAssertEqual(serverContext.sessionCacheStatistics.misses, 1)
+    }
+
+    func testClientResumesSessionTLS12() throws {
+        try self.assertResumes(maximumTLSVersion: .tlsv12)
+    }
+
+    func testClientResumesSessionTLS13() throws {
+        try self.assertResumes(maximumTLSVersion: .tlsv13)
+    }
+
+    /// Connects twice over TLS 1.2 to a server that issues no tickets, so that only its session cache can resume
+    /// the second connection. Returns the server context.
+    private func connectTwiceWithoutTickets(serverSessionCache cacheConfiguration: NIOSSLServerSessionCacheConfiguration) throws -> NIOSSLContext {
+        let clientContext = try self.makeResumingClientContext(store: NIOSSLInMemoryClientSessionStore(), maximumTLSVersion: .tlsv12)
+        let serverContext = try self.makeResumingServerContext(serverSessionCache: cacheConfiguration)
+        CNIOBoringSSL_SSL_CTX_set_options(serverContext.sslContext, UInt32(SSL_OP_NO_TICKET))
+
+        try self.connectAndClose(clientContext: clientContext, serverContext: serverContext)
+        try self.connectAndClose(clientContext: clientContext, serverContext: serverContext)
+        return serverContext
+    }
+
+    func testServerResumesSessionFromCache() throws {
+        let serverContext = try assertNoThrowWithValue(self.connectTwiceWithoutTickets(serverSessionCache: NIOSSLServerSessionCacheConfiguration()))
+        XCTAssertEqual(serverContext.sessionCacheStatistics,
+                       NIOSSLSessionCacheStatistics(hits: 1, misses: 1, cachedSessions: 1))
+    }
+
+    func testServerWithoutCacheDoesNotResumeSessionIDs() throws {
+        let serverContext = try assertNoThrowWithValue(self.connectTwiceWithoutTickets(serverSessionCache: .disabled))
+        XCTAssertEqual(serverContext.sessionCacheStatistics,
+                       NIOSSLSessionCacheStatistics(hits: 0, misses: 2, cachedSessions: 0))
+    }
+
+    func testNoResumptionWithoutStore() throws {
+        let clientContext = try assertNoThrowWithValue(self.makeResumingClientContext(store: nil))
+        let serverContext = try assertNoThrowWithValue(self.makeResumingServerContext())
+
+        try self.connectAndClose(clientContext: clientContext, serverContext: serverContext)
+        try self.connectAndClose(clientContext: clientContext, serverContext: serverContext)
+        XCTAssertEqual(clientContext.sessionCacheStatistics.hits, 0)
+        XCTAssertEqual(clientContext.sessionCacheStatistics.misses, 2)
+    }
+
+    func testSessionsAreNotOfferedToOtherHosts() throws {
+        let store = NIOSSLInMemoryClientSessionStore()
+        let clientContext = try assertNoThrowWithValue(self.makeResumingClientContext(store: store))
+        let serverContext = try assertNoThrowWithValue(self.makeResumingServerContext())
+
+        try self.connectAndClose(clientContext: clientContext, serverContext: serverContext, serverHostname: "localhost")
+        try self.connectAndClose(clientContext: clientContext, serverContext: serverContext, serverHostname: "example.com")
+        XCTAssertEqual(store.count, 2)
+        XCTAssertEqual(clientContext.sessionCacheStatistics.hits, 0)
+    }
+
+    func testInMemoryStoreEvictsOldestKey() throws {
+        let store = NIOSSLInMemoryClientSessionStore(maximumSize: 1)
+        let clientContext = try assertNoThrowWithValue(self.makeResumingClientContext(store: store))
+        let serverContext = try assertNoThrowWithValue(self.makeResumingServerContext())
+
+        try self.connectAndClose(clientContext: clientContext, serverContext: serverContext, serverHostname: "localhost")
+        try self.connectAndClose(clientContext: clientContext, serverContext: serverContext, serverHostname: "example.com")
+        XCTAssertEqual(store.count, 1)
+        XCTAssertNil(store.session(forKey: NIOSSLClientSessionKey(hostname: "localhost", port: nil, applicationProtocols: [])))
+    }
+
+    func testSessionSerializationRoundTrips() throws {
+        let store = NIOSSLInMemoryClientSessionStore()
+        let clientContext = try assertNoThrowWithValue(self.makeResumingClientContext(store: store))
+        let serverContext = try assertNoThrowWithValue(self.makeResumingServerContext())
+        try self.connectAndClose(clientContext: clientContext, serverContext: serverContext)
+
+        let key = NIOSSLClientSessionKey(hostname: "localhost", port: nil, applicationProtocols: [])
+        let session = try XCTUnwrap(store.session(forKey: key))
+        let deserialized = try NIOSSLSession(serializedBytes: session.serializedBytes, context: clientContext)
+        XCTAssertEqual(deserialized.serializedBytes, session.serializedBytes)
+
+        XCTAssertThrowsError(try NIOSSLSession(serializedBytes: [1, 2, 3], context: clientContext)) { error in
+            XCTAssertEqual(error as? NIOSSLExtraError, .invalidSessionData)
+        }
+    }
+
+    func testSharedTicketKeysAllowResumptionAcrossContexts() throws {
+        let keys = NIOSSLSessionTicketKeyRing(primary: .random())
+        let clientContext = try assertNoThrowWithValue(self.makeResumingClientContext(store: NIOSSLInMemoryClientSessionStore()))
+        let firstServer = try assertNoThrowWithValue(self.makeResumingServerContext(ticketKeys: keys))
+        let secondServer = try assertNoThrowWithValue(self.makeResumingServerContext(ticketKeys: keys))
+
+        try self.connectAndClose(clientContext: clientContext, serverContext: firstServer)
+        try self.connectAndClose(clientContext: clientContext, serverContext: secondServer)
+        XCTAssertEqual(secondServer.sessionCacheStatistics.hits, 1)
+        XCTAssertEqual(clientContext.sessionCacheStatistics.hits, 1)
+    }
+
+    func testUnsharedTicketKeysPreventResumptionAcrossContexts() throws {
+        let clientContext = try assertNoThrowWithValue(self.makeResumingClientContext(store: NIOSSLInMemoryClientSessionStore()))
+        let firstServer = try assertNoThrowWithValue(self.makeResumingServerContext(ticketKeys: NIOSSLSessionTicketKeyRing(primary: .random())))
+        let secondServer = try assertNoThrowWithValue(self.makeResumingServerContext(ticketKeys: NIOSSLSessionTicketKeyRing(primary: .random())))
+
+        try self.connectAndClose(clientContext: clientContext, serverContext: firstServer)
+        try self.connectAndClose(clientContext: clientContext, serverContext: secondServer)
+        XCTAssertEqual(secondServer.sessionCacheStatistics.hits, 0)
+        XCTAssertEqual(secondServer.sessionCacheStatistics.misses, 1)
+    }
+
+    func testTicketsFromSecondaryKeyAreAccepted() throws {
+        let keys = NIOSSLSessionTicketKeyRing(primary: .random())
+        let clientContext = try assertNoThrowWithValue(self.makeResumingClientContext(store: NIOSSLInMemoryClientSessionStore()))
+        let serverContext = try assertNoThrowWithValue(self.makeResumingServerContext(ticketKeys: keys))
+
+        try self.connectAndClose(clientContext: clientContext, serverContext: serverContext)
+        let oldPrimary = keys.primary
+        keys.rotate(to: .random())
+        XCTAssertEqual(keys.secondaries, [oldPrimary])
+
+        try self.connectAndClose(clientContext: clientContext, serverContext: serverContext)
+        XCTAssertEqual(serverContext.sessionCacheStatistics.hits, 1)
+
+        // The client now holds a ticket issued under the second key. Once that key is dropped, it can't resume.
+        keys.rotate(to: .random(), retainingSecondaries: 0)
+        XCTAssertEqual(keys.secondaries, [])
+        try self.connectAndClose(clientContext: clientContext, serverContext: serverContext)
+        XCTAssertEqual(serverContext.sessionCacheStatistics.hits, 1)
+        XCTAssertEqual(serverContext.sessionCacheStatistics.misses, 2)
+    }
+
+    func testLoadingTicketKeysFromFile() throws {
+        let first = NIOSSLSessionTicketKey.random()
+        let second = NIOSSLSessionTicketKey.random()
+        var bytes = [UInt8]()
+        bytes.append(contentsOf: first.name)
+        bytes.append(contentsOf: Array(repeating: 1, count: 32))
+        bytes.append(contentsOf: second.name)
+        bytes.append(contentsOf: Array(repeating: 2, count: 32))
+
+        let path = try dumpToFile(data: Data(bytes))
+        defer {
+            XCTAssertNoThrow(try FileManager.default.removeItem(atPath: path))
+        }
+
+        let keys = try NIOSSLSessionTicketKeyRing(file: path)
+        XCTAssertEqual(keys.primary.name, first.name)
+        XCTAssertEqual(keys.secondaries.map { $0.name }, [second.name])
+
+        let truncatedPath = try dumpToFile(data: Data(bytes.dropLast()))
+        defer {
+            XCTAssertNoThrow(try FileManager.default.removeItem(atPath: truncatedPath))
+        }
+        XCTAssertThrowsError(try keys.reload(fromFile: truncatedPath)) { error in
+            XCTAssertEqual(error as? NIOSSLExtraError, .invalidSessionTicketKey)
+        }
+        XCTAssertEqual(keys.primary.name, first.name)
+    }
+
+    func testTicketKeyRequiresFortyEightBytes() {
+        XCTAssertThrowsError(try NIOSSLSessionTicketKey(bytes: Array(repeating: 0, count: 47))) { error in
+            XCTAssertEqual(error as? NIOSSLExtraError, .invalidSessionTicketKey)
+        }
+        XCTAssertNoThrow(try NIOSSLSessionTicketKey(bytes: Array(repeating: 0, count: 48)))
+    }
+
+    private func makeServerContext(keyExchangeGroups: [NIOSSLKeyExchangeGroup]?) throws -> NIOSSLContext {
+        var config = TLSConfiguration.makeTestServerConfiguration()
+        config.keyExchangeGroups = keyExchangeGroups
+        return try NIOSSLContext(configuration: config)
+    }
+
+    private func makeClientContext(keyExchangeGroups: [NIOSSLKeyExchangeGroup]?,
+                                   predictedKeyShare: NIOSSLKeyExchangeGroup? = nil,
+                                   maximumTLSVersion: TLSVersion = .tlsv13) throws -> NIOSSLContext {
+        var config = TLSConfiguration.makeTestClientConfiguration()
+        config.maximumTLSVersion = maximumTLSVersion
+        config.keyExchangeGroups = keyExchangeGroups
+        config.predictedKeyShare = predictedKeyShare
+        return try NIOSSLContext(configuration: config)
+    }
+
+    func testDefaultGroupsAvoidHelloRetryRequest() throws {
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext(keyExchangeGroups: nil))
+        let clientContext = try assertNoThrowWithValue(self.makeClientContext(keyExchangeGroups: nil))
+        XCTAssertNoThrow(try BackToBackEmbeddedChannel(clientContext: clientContext, serverContext: serverContext).handshakeInMemory())
+
+        XCTAssertEqual(clientContext.keyExchangeStatistics, NIOSSLKeyExchangeStatistics(handshakes: 1, helloRetryRequests: 0))
+        XCTAssertEqual(serverContext.keyExchangeStatistics, NIOSSLKeyExchangeStatistics(handshakes: 1, helloRetryRequests: 0))
+    }
+
+    func testMispredictedKeyShareIsCounted() throws {
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext(keyExchangeGroups: [.x25519]))
+        let clientContext = try assertNoThrowWithValue(self.makeClientContext(keyExchangeGroups: [.secp384r1, .x25519]))
+        XCTAssertNoThrow(try BackToBackEmbeddedChannel(clientContext: clientContext, serverContext: serverContext).handshakeInMemory())
+
+        XCTAssertEqual(clientContext.keyExchangeStatistics, NIOSSLKeyExchangeStatistics(handshakes: 1, helloRetryRequests: 1))
+        XCTAssertEqual(serverContext.keyExchangeStatistics, NIOSSLKeyExchangeStatistics(handshakes: 1, helloRetryRequests: 1))
+    }
+
+    func testPredictedKeyShareAvoidsHelloRetryRequest() throws {
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext(keyExchangeGroups: [.x25519]))
+        let clientContext = try assertNoThrowWithValue(self.makeClientContext(keyExchangeGroups: [.secp384r1, .x25519],
+                                                                              predictedKeyShare: .x25519))
+        XCTAssertNoThrow(try BackToBackEmbeddedChannel(clientContext: clientContext, serverContext: serverContext).handshakeInMemory())
+
+        XCTAssertEqual(clientContext.keyExchangeStatistics, NIOSSLKeyExchangeStatistics(handshakes: 1, helloRetryRequests: 0))
+    }
+
+    func testPredictedKeyShareOutsideGroupsIsRejected() throws {
+        XCTAssertThrowsError(try self.makeClientContext(keyExchangeGroups: [.x25519], predictedKeyShare: .secp256r1)) { error in
+            XCTAssertEqual(error as? NIOSSLExtraError, .invalidPredictedKeyShare)
+        }
+    }
+
+    func testTLS12NeverUsesHelloRetryRequest() throws {
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext(keyExchangeGroups: [.secp256r1]))
+        let clientContext = try assertNoThrowWithValue(self.makeClientContext(keyExchangeGroups: [.x25519, .secp256r1],
+                                                                              maximumTLSVersion: .tlsv12))
+        XCTAssertNoThrow(try BackToBackEmbeddedChannel(clientContext: clientContext, serverContext: serverContext).handshakeInMemory())
+
+        XCTAssertEqual(clientContext.keyExchangeStatistics, NIOSSLKeyExchangeStatistics(handshakes: 1, helloRetryRequests: 0))
+    }
+
+    func testNoSharedGroupFailsHandshake() throws {
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext(keyExchangeGroups: [.secp521r1]))
+        let clientContext = try assertNoThrowWithValue(self.makeClientContext(keyExchangeGroups: [.x25519]))
+        XCTAssertThrowsError(try BackToBackEmbeddedChannel(clientContext: clientContext, serverContext: serverContext).handshakeInMemory())
+
+        XCTAssertEqual(serverContext.keyExchangeStatistics, NIOSSLKeyExchangeStatistics(handshakes: 0, helloRetryRequests: 0))
+    }
+
+    func testGroupsAffectConfigurationEquality() {
+        var first = TLSConfiguration.makeClientConfiguration()
+        var second = TLSConfiguration.makeClientConfiguration()
+        XCTAssertTrue(first.bestEffortEquals(second))
+
+        first.keyExchangeGroups = [.x25519, .secp256r1]
+        XCTAssertFalse(first.bestEffortEquals(second))
+        second.keyExchangeGroups = [.x25519, .secp256r1]
+        XCTAssertTrue(first.bestEffortEquals(second))
+
+        first.predictedKeyShare = .secp256r1
+        XCTAssertFalse(first.bestEffortEquals(second))
+    }
+
+    private func makeServerContext(certificateCompressionAlgorithms: [NIOSSLCertificateCompressionAlgorithm]) throws -> NIOSSLContext {
+        var config = TLSConfiguration.makeTestServerConfiguration()
+        config.certificateCompressionAlgorithms = certificateCompressionAlgorithms
+        return try NIOSSLContext(configuration: config)
+    }
+
+    /// Connects a client to `serverContext`, returning the certificates the client received.
+    private func receivedCertificates(serverContext: NIOSSLContext,
+                                      clientAlgorithms: [NIOSSLCertificateCompressionAlgorithm] = [.zlib],
+                                      maximumTLSVersion: TLSVersion = .tlsv13) throws -> [NIOSSLCertificate] {
+        var config = TLSConfiguration.makeTestClientConfiguration()
+        config.maximumTLSVersion = maximumTLSVersion
+        config.certificateCompressionAlgorithms = clientAlgorithms
+
+        var receivedCertificates: [NIOSSLCertificate] = []
+        let b2b = try BackToBackEmbeddedChannel(clientContext: NIOSSLContext(configuration: config),
+                                                serverContext: serverContext,
+                                                customVerificationCallback: { certificates, promise in
+            receivedCertificates = certificates
+            promise.succeed(.certificateVerified)
+        })
+        try b2b.handshakeInMemory()
+        return receivedCertificates
+    }
+
+    func testCompressedChainIsReceivedIntact() throws {
+        try XCTSkipUnless(NIOSSLCertificateCompressionAlgorithm.zlib.isAvailable, "zlib is not available")
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext(certificateCompressionAlgorithms: [.zlib]))
+        let certificates = try assertNoThrowWithValue(self.receivedCertificates(serverContext: serverContext))
+        XCTAssertEqual(certificates, [sharedTestCertificate])
+        XCTAssertEqual(serverContext.compressedCertificates.count, 1)
+    }
+
+    func testChainIsCompressedOncePerContext() throws {
+        try XCTSkipUnless(NIOSSLCertificateCompressionAlgorithm.zlib.isAvailable, "zlib is not available")
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext(certificateCompressionAlgorithms: [.zlib]))
+        for _ in 0..<3 {
+            let certificates = try assertNoThrowWithValue(self.receivedCertificates(serverContext: serverContext))
+            XCTAssertEqual(certificates, [sharedTestCertificate])
+        }
+        XCTAssertEqual(serverContext.compressedCertificates.count, 1)
+        XCTAssertEqual(serverContext.compressedCertificates.compressions, 1)
+    }
+
+    func testRepeatedAlgorithmsAreRegisteredOnce() throws {
+        try XCTSkipUnless(NIOSSLCertificateCompressionAlgorithm.zlib.isAvailable, "zlib is not available")
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext(certificateCompressionAlgorithms: [.zlib, .zlib]))
+        let certificates = try assertNoThrowWithValue(self.receivedCertificates(serverContext: serverContext,
+                                                                                clientAlgorithms: [.zlib, .zlib]))
+        XCTAssertEqual(certificates, [sharedTestCertificate])
+        XCTAssertEqual(serverContext.compressedCertificates.compressions, 1)
+    }
+
+    func testChainIsNotCompressedForClientsWithoutAlgorithm() throws {
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext(certificateCompressionAlgorithms: [.zlib]))
+        let certificates = try assertNoThrowWithValue(self.receivedCertificates(serverContext: serverContext, clientAlgorithms: []))
+        XCTAssertEqual(certificates, [sharedTestCertificate])
+        XCTAssertEqual(serverContext.compressedCertificates.count, 0)
+        XCTAssertEqual(serverContext.compressedCertificates.compressions, 0)
+    }
+
+    func testChainIsNotCompressedInTLS12() throws {
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext(certificateCompressionAlgorithms: [.zlib]))
+        let certificates = try assertNoThrowWithValue(self.receivedCertificates(serverContext: serverContext, maximumTLSVersion: .tlsv12))
+        XCTAssertEqual(certificates, [sharedTestCertificate])
+        XCTAssertEqual(serverContext.compressedCertificates.count, 0)
+        XCTAssertEqual(serverContext.compressedCertificates.compressions, 0)
+    }
+
+    func testChainIsSentUncompressedWithoutServerSupport() throws {
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext(certificateCompressionAlgorithms: []))
+        let certificates = try assertNoThrowWithValue(self.receivedCertificates(serverContext: serverContext))
+        XCTAssertEqual(certificates, [sharedTestCertificate])
+        XCTAssertEqual(serverContext.compressedCertificates.count, 0)
+        XCTAssertEqual(serverContext.compressedCertificates.compressions, 0)
+    }
+
+    /// Makes a server context that requires a client certificate issued by one of `trustedClients`.
+    private func makeServerContext(verifiedChainCache: NIOSSLVerifiedChainCacheConfiguration? = .init(),
+                                   trustedClients: [NIOSSLCertificate] = [otherTestCertificate]) throws -> NIOSSLContext {
+        var config = TLSConfiguration.makeTestServerConfiguration()
+        config.certificateVerification = .noHostnameVerification
+        config.trustRoots = .certificates(trustedClients)
+        config.verifiedChainCache = verifiedChainCache
+        return try NIOSSLContext(configuration: config)
+    }
+
+    private func connectClient(to serverContext: NIOSSLContext,
+                               certificate: NIOSSLCertificate = otherTestCertificate,
+                               privateKey: NIOSSLPrivateKey = otherTestPrivateKey) throws {
+        var config = TLSConfiguration.makeTestClientConfiguration()
+        config.certificateChain = [.certificate(certificate)]
+        config.privateKey = .privateKey(privateKey)
+        let clientContext = try NIOSSLContext(configuration: config)
+        try BackToBackEmbeddedChannel(clientContext: clientContext, serverContext: serverContext).handshakeInMemory()
+    }
+
+    func testRepeatChainIsNotVerifiedAgain() throws {
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext())
+        XCTAssertNoThrow(try self.connectClient(to: serverContext))
+        XCTAssertNoThrow(try self.connectClient(to: serverContext))
+        XCTAssertNoThrow(try self.connectClient(to: serverContext))
+
+        XCTAssertEqual(serverContext.verifiedChainCacheStatistics,
+                       NIOSSLVerifiedChainCacheStatistics(hits: 2, misses: 1, cachedChains: 1))
+    }
+
+    func testDifferentChainsAreCachedSeparately() throws {
+        let (secondCert, secondKey) = generateSelfSignedCert(commonName: "second client")
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext(trustedClients: [otherTestCertificate, secondCert]))
+        XCTAssertNoThrow(try self.connectClient(to: serverContext))
+        XCTAssertNoThrow(try self.connectClient(to: serverContext, certificate: secondCert, privateKey: secondKey))
+
+        XCTAssertEqual(serverContext.verifiedChainCacheStatistics,
+                       NIOSSLVerifiedChainCacheStatistics(hits: 0, misses: 2, cachedChains: 2))
+    }
+
+    func testLeastRecentlyUsedChainIsEvicted() throws {
+        let (secondCert, secondKey) = generateSelfSignedCert(commonName: "second client")
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext(verifiedChainCache: .init(maximumSize: 1),
+                                                                              trustedClients: [otherTestCertificate, secondCert]))
+        XCTAssertNoThrow(try self.connectClient(to: serverContext))
+        XCTAssertNoThrow(try self.connectClient(to: serverContext, certificate: secondCert, privateKey: secondKey))
+        XCTAssertNoThrow(try self.connectClient(to: serverContext))
+
+        XCTAssertEqual(serverContext.verifiedChainCacheStatistics,
+                       NIOSSLVerifiedChainCacheStatistics(hits: 0, misses: 3, cachedChains: 1))
+    }
+
+    func testInvalidationForcesVerification() throws {
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext())
+        XCTAssertNoThrow(try self.connectClient(to: serverContext))
+        serverContext.invalidateVerifiedChainCache()
+        XCTAssertNoThrow(try self.connectClient(to: serverContext))
+
+        XCTAssertEqual(serverContext.verifiedChainCacheStatistics,
+                       NIOSSLVerifiedChainCacheStatistics(hits: 0, misses: 2, cachedChains: 1))
+    }
+
+    func testExpiredResultsAreNotReused() throws {
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext(verifiedChainCache: .init(maximumAge: .nanoseconds(1))))
+        XCTAssertNoThrow(try self.connectClient(to: serverContext))
+        XCTAssertNoThrow(try self.connectClient(to: serverContext))
+
+        XCTAssertEqual(serverContext.verifiedChainCacheStatistics,
+                       NIOSSLVerifiedChainCacheStatistics(hits: 0, misses: 2, cachedChains: 1))
+    }
+
+    func testUntrustedChainIsNotCached() throws {
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext())
+        let (untrustedCert, untrustedKey) = generateSelfSignedCert(commonName: "untrusted client")
+        XCTAssertThrowsError(try self.connectClient(to: serverContext, certificate: untrustedCert, privateKey: untrustedKey))
+        XCTAssertThrowsError(try self.connectClient(to: serverContext, certificate: untrustedCert, privateKey: untrustedKey))
+
+        XCTAssertEqual(serverContext.verifiedChainCacheStatistics,
+                       NIOSSLVerifiedChainCacheStatistics(hits: 0, misses: 2, cachedChains: 0))
+    }
+
+    func testVerifiedChainCacheIsDisabledByDefault() throws {
+        let serverContext = try assertNoThrowWithValue(self.makeServerContext(verifiedChainCache: nil))
+        XCTAssertNoThrow(try self.connectClient(to: serverContext))
+        XCTAssertNil(serverContext.verifiedChainCacheStatistics)
+    }
+
+    /// Handshakes in memory between `clientContext` and a server presenting `sharedTestCertificate`.
+    private func handshakeWithTestServer(clientContext: NIOSSLContext) throws {
+        let serverContext = try NIOSSLContext(configuration: .makeTestServerConfiguration())
+        try BackToBackEmbeddedChannel(clientContext: clientContext, serverContext: serverContext).handshakeInMemory()
+    }
+
+    private func makeClientContext(trustStore: NIOSSLTrustStore,
+                                   additionalTrustRoots: [NIOSSLAdditionalTrustRoots] = []) throws -> NIOSSLContext {
+        var config = TLSConfiguration.makeTestClientConfiguration()
+        config.trustRoots = .certificates([])
+        config.additionalTrustRoots = additionalTrustRoots
+        config.trustStore = trustStore
+        return try NIOSSLContext(configuration: config)
+    }
+
+    func testTrustStoreRootsAreTrusted() throws {
+        let store = try assertNoThrowWithValue(NIOSSLTrustStore(certificates: [otherTestCertificate, sharedTestCertificate]))
+        let clientContext = try assertNoThrowWithValue(self.makeClientContext(trustStore: store))
+        XCTAssertNoThrow(try self.handshakeWithTestServer(clientContext: clientContext))
+    }
+
+    func testPeersNotInTrustStoreAreRejected() throws {
+        let store = try assertNoThrowWithValue(NIOSSLTrustStore(certificates: [otherTestCertificate]))
+        let clientContext = try assertNoThrowWithValue(self.makeClientContext(trustStore: store))
+        XCTAssertThrowsError(try self.handshakeWithTestServer(clientContext: clientContext))
+    }
+
+    func testAdditionalTrustRootsAreTrustedAlongsideTrustStore() throws {
+        let store = try assertNoThrowWithValue(NIOSSLTrustStore(certificates: [otherTestCertificate]))
+        let clientContext = try assertNoThrowWithValue(self.makeClientContext(trustStore: store,
+                                                                              additionalTrustRoots: [.certificates([sharedTestCertificate])]))
+        XCTAssertNoThrow(try self.handshakeWithTestServer(clientContext: clientContext))
+    }
+
+    func testTrustStoreRootsAreParsedOnFirstUse() throws {
+        let store = try assertNoThrowWithValue(NIOSSLTrustStore(certificates: [otherTestCertificate, sharedTestCertificate]))
+        XCTAssertEqual(store.parsedCount, 0)
+
+        let firstContext = try assertNoThrowWithValue(self.makeClientContext(trustStore: store))
+        let secondContext = try assertNoThrowWithValue(self.makeClientContext(trustStore: store))
+        XCTAssertEqual(store.parsedCount, 0)
+
+        XCTAssertNoThrow(try self.handshakeWithTestServer(clientContext: firstContext))
+        XCTAssertNoThrow(try self.handshakeWithTestServer(clientContext: secondContext))
+        XCTAssertEqual(store.parsedCount, 1)
+    }
+
+    func testDuplicateTrustStoreRootsAreHeldOnce() throws {
+        let store = try assertNoThrowWithValue(NIOSSLTrustStore(certificates: [sharedTestCertificate, sharedTestCertificate]))
+        XCTAssertEqual(store.count, 1)
+    }
+
+    func testTrustStoresShareRootBuffers() throws {
+        let first = try assertNoThrowWithValue(NIOSSLTrustStore(certificates: [sharedTestCertificate]))
+        let second = try assertNoThrowWithValue(NIOSSLTrustStore(certificates: [sharedTestCertificate]))
+        XCTAssertEqual(first.rootBuffers.count, 1)
+        XCTAssertEqual(first.rootBuffers, second.rootBuffers)
+    }
+
+    func testLoadingTrustStoreFromPEMFile() throws {
+        let path = try dumpToFile(text: samplePemCerts)
+        defer {
+            _ = path.withCString { unlink($0) }
+        }
+
+        let store = try assertNoThrowWithValue(NIOSSLTrustStore(file: path))
+        XCTAssertEqual(store.count, 1)
+        XCTAssertEqual(store.parsedCount, 0)
+    }
+
+    func testLoadingTrustStoreFromFileWithoutCertificatesFails() throws {
+        let path = try dumpToFile(text: "not a certificate")
+        defer {
+            _ = path.withCString { unlink($0) }
+        }
+
+        XCTAssertThrowsError(try NIOSSLTrustStore(file: path)) { error in
+            XCTAssertEqual(.failedToLoadCertificate, error as? NIOSSLError)
+        }
+    }
+
+    /// Runs `body` with the path of a new, empty directory, which is removed afterwards.
+    private func withTemporaryDirectory(_ body: (String) throws -> Void) throws {
+        let directory = FileManager.default.temporaryDirectory.appendingPathComponent("niotest-\(UUID())").path
+        try FileManager.default.createDirectory(atPath: directory, withIntermediateDirectories: false)
+        defer {
+            XCTAssertNoThrow(try FileManager.default.removeItem(atPath: directory))
+        }
+        try body(directory)
+    }
+
+    /// Writes `certificate` to `directory` as a PEM file, with a symlink named the way c_rehash would name it.
+    private func add(_ certificate: NIOSSLCertificate, toDirectory directory: String) throws {
+        let der = Data(try certificate.toDERBytes())
+        let pem = "-----BEGIN CERTIFICATE-----\n\(der.base64EncodedString(options: .lineLength64Characters))\n-----END CERTIFICATE-----\n"
+        let filename = "\(UUID()).pem"
+        try pem.write(toFile: directory + "/" + filename, atomically: true, encoding: .utf8)
+
+        let hashedName = String(format: "%08lx.0", certificate.getSubjectNameHash())
+        try FileManager.default.createSymbolicLink(atPath: directory + "/" + hashedName, withDestinationPath: filename)
+    }
+
+    private func makeClientContext(trustRootsDirectory directory: String,
+                                   mode: NIOSSLTrustRootsDirectoryMode) throws -> NIOSSLContext {
+        var config = TLSConfiguration.makeTestClientConfiguration()
+        config.trustRoots = .file(directory)
+        config.trustRootsDirectoryMode = mode
+        return try NIOSSLContext(configuration: config)
+    }
+
+    func testIndexedDirectoryRootsAreTrusted() throws {
+        try self.withTemporaryDirectory { directory in
+            XCTAssertNoThrow(try self.add(otherTestCertificate, toDirectory: directory))
+            XCTAssertNoThrow(try self.add(sharedTestCertificate, toDirectory: directory))
+            let clientContext = try assertNoThrowWithValue(self.makeClientContext(trustRootsDirectory: directory,
+                                                                                  mode: .indexed(reloadInterval: nil)))
+            XCTAssertEqual(clientContext.trustRootsDirectory?.count, 2)
+            XCTAssertNoThrow(try self.handshakeWithTestServer(clientContext: clientContext))
+        }
+    }
+
+    func testIndexedDirectoryIsNotReadDuringHandshakes() throws {
+        try self.withTemporaryDirectory { directory in
+            XCTAssertNoThrow(try self.add(sharedTestCertificate, toDirectory: directory))
+            let clientContext = try assertNoThrowWithValue(self.makeClientContext(trustRootsDirectory: directory,
+                                                                                  mode: .indexed(reloadInterval: nil)))
+
+            for name in try FileManager.default.contentsOfDirectory(atPath: directory) {
+                XCTAssertNoThrow(try FileManager.default.removeItem(atPath: directory + "/" + name))
+            }
+            XCTAssertNoThrow(try self.handshakeWithTestServer(clientContext: clientContext))
+        }
+    }
+
+    func testLookupOnDemandReadsDirectoryDuringHandshakes() throws {
+        try self.withTemporaryDirectory { directory in
+            let clientContext = try assertNoThrowWithValue(self.makeClientContext(trustRootsDirectory: directory,
+                                                                                  mode: .lookupOnDemand))
+            XCTAssertNil(clientContext.trustRootsDirectory)
+
+            XCTAssertNoThrow(try self.add(sharedTestCertificate, toDirectory: directory))
+            XCTAssertNoThrow(try self.handshakeWithTestServer(clientContext: clientContext))
+        }
+    }
+
+    func testExplicitReloadPicksUpNewRoots() throws {
+        try self.withTemporaryDirectory { directory in
+            XCTAssertNoThrow(try self.add(otherTestCertificate, toDirectory: directory))
+            let clientContext = try assertNoThrowWithValue(self.makeClientContext(trustRootsDirectory: directory,
+                                                                                  mode: .indexed(reloadInterval: nil)))
+            XCTAssertThrowsError(try self.handshakeWithTestServer(clientContext: clientContext))
+
+            XCTAssertNoThrow(try self.add(sharedTestCertificate, toDirectory: directory))
+            XCTAssertThrowsError(try self.handshakeWithTestServer(clientContext: clientContext))
+
+            XCTAssertNoThrow(try clientContext.reloadTrustRootsDirectory())
+            XCTAssertEqual(clientContext.trustRootsDirectory?.count, 2)
+            XCTAssertNoThrow(try self.handshakeWithTestServer(clientContext: clientContext))
+        }
+    }
+
+    func testChangedDirectoryIsReloadedAfterInterval() throws {
+        try self.withTemporaryDirectory { directory in
+            XCTAssertNoThrow(try self.add(otherTestCertificate, toDirectory: directory))
+            let clientContext = try assertNoThrowWithValue(self.makeClientContext(trustRootsDirectory: directory,
+                                                                                  mode: .indexed(reloadInterval: .milliseconds(10))))
+
+            XCTAssertNoThrow(try self.add(sharedTestCertificate, toDirectory: directory))
+            // Not every file system records modification times finely enough to see the change, so make sure it shows.
+            XCTAssertNoThrow(try FileManager.default.setAttributes([.modificationDate: Date(timeIntervalSinceNow: 60)],
+                                                                   ofItemAtPath: directory))
+
+            // The directory is read again in the background, not by a verification.
+            let deadline = Date(timeIntervalSinceNow: 10)
+            while clientContext.trustRootsDirectory?.count != 2 && Date() < deadline {
+                usleep(10_000)
+            }
+            XCTAssertEqual(clientContext.trustRootsDirectory?.count, 2)
+            XCTAssertNoThrow(try self.handshakeWithTestServer(clientContext: clientContext))
+        }
+    }
+
+    func testTrustStoreFromDirectoryOnlyReadsHashedNames() throws {
+        try self.withTemporaryDirectory { directory in
+            XCTAssertNoThrow(try self.add(sharedTestCertificate, toDirectory: directory))
+            XCTAssertNoThrow(try self.add(otherTestCertificate, toDirectory: directory))
+            XCTAssertNoThrow(try "not a certificate".write(toFile: directory + "/README", atomically: true, encoding: .utf8))
+
+            let store = try assertNoThrowWithValue(NIOSSLTrustStore(directory: directory))
+            XCTAssertEqual(store.count, 2)
+        }
+    }
+
+    func testTrustStoreFromMissingDirectoryFails() throws {
+        try self.withTemporaryDirectory { directory in
+            XCTAssertThrowsError(try NIOSSLTrustStore(directory: directory + "/missing")) { error in
+                XCTAssertEqual(.noSuchFilesystemObject, error as? NIOSSLError)
+            }
+        }
+    }
+
+    /// Makes a client and a server context that authenticate each other, both using `pool`.
+    private func makeMutualAuthenticationContexts(certificateBufferPool pool: NIOSSLCertificateBufferPool?) throws -> (client: NIOSSLContext, server: NIOSSLContext) {
+        var serverConfig = TLSConfiguration.makeTestServerConfiguration()
+        serverConfig.certificateVerification = .noHostnameVerification
+        serverConfig.trustRoots = .certificates([otherTestCertificate])
+        serverConfig.certificateBufferPool = pool
+
+        var clientConfig = TLSConfiguration.makeTestClientConfiguration()
+        clientConfig.certificateChain = [.certificate(otherTestCertificate)]
+        clientConfig.privateKey = .privateKey(otherTestPrivateKey)
+        clientConfig.certificateBufferPool = pool
+
+        return (try NIOSSLContext(configuration: clientConfig), try NIOSSLContext(configuration: serverConfig))
+    }
+
+    func testConcurrentConnectionsShareCertificates() throws {
+        let pool = NIOSSLCertificateBufferPool()
+        let (clientContext, serverContext) = try assertNoThrowWithValue(self.makeMutualAuthenticationContexts(certificateBufferPool: pool))
+
+        let first = try assertNoThrowWithValue(BackToBackEmbeddedChannel(clientContext: clientContext, serverContext: serverContext))
+        XCTAssertNoThrow(try first.handshakeInMemory())
+        let afterFirst = pool.statistics
+        XCTAssertGreaterThanOrEqual(afterFirst.certificates, 2)
+        XCTAssertGreaterThanOrEqual(afterFirst.misses, 2)
+
+        let second = try assertNoThrowWithValue(BackToBackEmbeddedChannel(clientContext: clientContext, serverContext: serverContext))
+        XCTAssertNoThrow(try second.handshakeInMemory())
+        let afterSecond = pool.statistics
+
+        // The second connection receives the same certificates as the first, in both directions.
+        XCTAssertEqual(afterSecond.certificates, afterFirst.certificates)
+        XCTAssertEqual(afterSecond.bytes, afterFirst.bytes)
+        XCTAssertGreaterThanOrEqual(afterSecond.hits - afterFirst.hits, 2)
+        XCTAssertEqual(afterSecond.misses, afterFirst.misses)
+
+        withExtendedLifetime((first, second)) { }
+    }
+
+    func testContextsWithoutCertificateBufferPoolAreNotCounted() throws {
+        let pool = NIOSSLCertificateBufferPool()
+        let (clientContext, serverContext) = try assertNoThrowWithValue(self.makeMutualAuthenticationContexts(certificateBufferPool: nil))
+
+        let connection = try assertNoThrowWithValue(BackToBackEmbeddedChannel(clientContext: clientContext, serverContext: serverContext))
+        XCTAssertNoThrow(try connection.handshakeInMemory())
+        XCTAssertEqual(pool.statistics, NIOSSLCertificateBufferPoolStatistics(certificates: 0, bytes: 0, hits: 0, misses: 0))
+
+        withExtendedLifetime(connection) { }
+    }
+
+    func testCertificateBufferPoolHitRate() {
+        XCTAssertEqual(NIOSSLCertificateBufferPoolStatistics(certificates: 0, bytes: 0, hits: 0, misses: 0).hitRate, 0)
+        XCTAssertEqual(NIOSSLCertificateBufferPoolStatistics(certificates: 1, bytes: 100, hits: 3, misses: 1).hitRate, 0.75)
+    }
 }
 
 extension EmbeddedChannel {
@@ -312,6 +312,9 @@ echo "RENAMING header files"
 echo "PATCHING BoringSSL"
 git apply "${HERE}/scripts/patch-1-inttypes.patch"
 git apply "${HERE}/scripts/patch-2-arm-arch.patch"
+git apply "${HERE}/scripts/patch-3-key-share-pool.patch"
+git apply "${HERE}/scripts/patch-4-buffer-pool-stats.patch"
+git apply "${HERE}/scripts/patch-5-gather-seal.patch"
 
 # We need to avoid having the stack be executable. BoringSSL does this in its build system, but we can't.
 echo "PROTECTING against executable stacks"